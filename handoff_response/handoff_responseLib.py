@@ -12,6 +12,8 @@ def generate(env, **kw):
     env.Tool('addLibrary', library = env['rootLibs'])
     env.Tool('addLibrary', library = env['rootGuiLibs'])
     env.Tool('addLibrary', library = env['clhepLibs'])
+    if env['PLATFORM'] == 'posix':
+        env.AppendUnique(LINKFLAGS=['-fopenmp'])
 
 def exists(env):
     return 1
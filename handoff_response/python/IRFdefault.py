@@ -24,6 +24,27 @@ class Data(object):
     generated = []
     logemin = []
     logemax = []
+    # threads used to fill the histograms and for the fits
+    threads = 1
+    # flat merit files to read instead of the ROOT files, and a flat
+    # file to write the selected events to
+    flat_files = []
+    flat_output = ''
+    # file in which the filled histograms are saved every
+    # checkpoint_interval merit entries; if it exists, the projection
+    # resumes from it, or is skipped if it was completed, provided that
+    # it was saved with the same files, cuts, scaling parameters, bins
+    # and shard
+    checkpoint_file = ''
+    checkpoint_interval = 1000000
+    # save the completed projection in checkpoint_file and stop,
+    # leaving the fits for a later run
+    project_only = 0
+    # divide the input entries into shard_count ranges of consecutive
+    # entries, and project only range shard_index to a checkpoint file
+    # to be merged by mergeirf; Prune.fileName must be ''
+    shard_index = 0
+    shard_count = 1
 
 # define default binning as attributes of object Bins
 
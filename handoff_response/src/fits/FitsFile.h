@@ -9,6 +9,7 @@
 #ifndef handoff_response_FitsFile_h
 #define handoff_response_FitsFile_h
 
+#include <map>
 #include <string>
 #include <vector>
 
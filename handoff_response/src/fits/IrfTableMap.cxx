@@ -69,6 +69,14 @@ void IrfTableMap::readTableNames(TDirectory * section, bool no_clear) {
    }
 }
 
+void IrfTableMap::add(const std::string & tablename,
+                      const IrfTable & table) {
+   if (m_tables.find(tablename) == m_tables.end()) {
+      m_keys.push_back(tablename);
+   }
+   m_tables[tablename] = table;
+}
+
 const IrfTable & IrfTableMap::operator[](const std::string & tablename) const {
    std::map<std::string, IrfTable>::const_iterator table =
       m_tables.find(tablename);
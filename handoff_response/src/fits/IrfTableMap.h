@@ -30,10 +30,16 @@ namespace handoff_response {
 class IrfTableMap {
 
 public:
+
+   /// An empty map, to be filled with add().
+   IrfTableMap() {}
    
    IrfTableMap(const std::string & irfTables,
                const std::string & rootfile);
 
+   /// Add a table made in memory, replacing any of the same name.
+   void add(const std::string & tablename, const IrfTable & table);
+
    const std::vector<std::string> & keys() const {
       return m_keys;
    }
@@ -0,0 +1,43 @@
+/**
+ * @file createFitsFiles.h
+ * @brief Write the FITS files of an event class from its parameter
+ * tables.
+ * @author J. Chiang
+ *
+ * $Header$
+ */
+
+#ifndef handoff_response_createFitsFiles_h
+#define handoff_response_createFitsFiles_h
+
+#include <string>
+
+namespace handoff_response {
+
+class IrfTableMap;
+
+/**
+ * Write aeff_<className>.fits, psf_<className>.fits and
+ * edisp_<className>.fits, with the effective area, phi dependence,
+ * efficiency, PSF, PSF scaling, fisheye, energy dispersion and
+ * dispersion scaling extensions, from the tables made by the
+ * fillParameterTables functions of the generator.
+ *
+ * @param irfTables The parameter tables, read from a parameters file
+ *        or made in memory.
+ * @param className The event class name.
+ * @param irfVersion The VERSION CALDB boundary value.
+ * @param newEdisp True for the dispersion parameterization of
+ *        Edisp.Version > 1.
+ * @param outputDir Directory for the files; the current directory if
+ *        empty.
+ */
+void createFitsFiles(const IrfTableMap & irfTables,
+                     const std::string & className,
+                     const std::string & irfVersion,
+                     bool newEdisp,
+                     const std::string & outputDir="");
+
+} // namespace handoff_response
+
+#endif // handoff_response_createFitsFiles_h
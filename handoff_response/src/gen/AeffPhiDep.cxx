@@ -11,10 +11,12 @@
 #include <sstream>
 
 #include "TCanvas.h"
+#include "TH1F.h"
 #include "TH2F.h"
 
 #include "AeffPhiDep.h"
 #include "IrfAnalysis.h"
+#include "../fits/IrfTableMap.h"
 #include "PhiDepHist.h"
 
 AeffPhiDep::AeffPhiDep(IrfAnalysis & irf) 
@@ -58,6 +60,23 @@ void AeffPhiDep::fill(double mc_xdir, double mc_ydir,
    m_hists.at(id).fill(tangent);
 }
 
+void AeffPhiDep::writeHists() const {
+   for (size_t i(0); i < m_hists.size(); i++) {
+      if (m_hists[i].histogram() != 0) {
+         m_hists[i].histogram()->Write();
+      }
+   }
+}
+
+void AeffPhiDep::addHists(TDirectory & dir) {
+   for (size_t i(0); i < m_hists.size(); i++) {
+      if (m_hists[i].histogram() != 0) {
+         m_hists[i].add(IrfAnalysis::savedHist(dir, 
+                                               m_hists[i].histogram()->GetName()));
+      }
+   }
+}
+
 void AeffPhiDep::fit() {
    for (size_t i(0); i < m_hists.size(); i++) {
       m_hists.at(i).fit();
@@ -105,7 +124,7 @@ void AeffPhiDep::draw(const std::string & psfile) {
     }
 }
 
-void AeffPhiDep::fillParameterTables() {
+void AeffPhiDep::fillParameterTables(handoff_response::IrfTableMap * tables) {
    size_t npars(m_hists.front().pars().size());
    for (size_t i(0); i < npars; i++) {
       std::ostringstream name;
@@ -121,6 +140,10 @@ void AeffPhiDep::fillParameterTables() {
       }
       h2.GetXaxis()->CenterTitle();
       h2.GetYaxis()->CenterTitle();
-      h2.Write();
+      if (tables) {
+         tables->add(name.str(), handoff_response::IrfTable(&h2));
+      } else {
+         h2.Write();
+      }
    }
 }
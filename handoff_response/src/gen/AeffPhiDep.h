@@ -13,6 +13,10 @@
 
 class IrfAnalysis;
 class IrfBinner;
+class TDirectory;
+namespace handoff_response {
+   class IrfTableMap;
+}
 
 /**
  * @class AeffPhiDep
@@ -28,13 +32,22 @@ public:
 
    void fill(double mc_xdir, double mc_ydir, double energy, double costheta);
 
+   /// Write the histograms to the current directory, for a
+   /// checkpoint of the projection.
+   void writeHists() const;
+
+   /// Add the histograms written by writeHists to dir.
+   void addHists(TDirectory & dir);
+
    void fit();
 
    void summarize();
 
    void draw(const std::string & psfile);
 
-   void fillParameterTables();
+   /// Make 2-d histograms of the fit parameters, written to the
+   /// current directory, or added to tables if given.
+   void fillParameterTables(handoff_response::IrfTableMap * tables=0);
 
 private:
 
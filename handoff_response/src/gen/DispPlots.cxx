@@ -14,6 +14,7 @@
 #include "TTree.h"
 #include "TCanvas.h"
 #include "IrfAnalysis.h"
+#include "../fits/IrfTableMap.h"
 
 #include <cmath>
 #include <iomanip>
@@ -68,39 +69,107 @@ DispPlots::DispPlots( IrfAnalysis& irf,
             m_hists[id].setScaleFactorParameters(m_edisp_scaling_pars);
         }
     }
+    // With over-lapping bins, each event is filled once, into its
+    // own bin, and the neighbours are summed by sumOverlaps.
+    if (binner().edispEnergyOverLap() > 0 || binner().edispAngleOverLap() > 0) {
+        m_base.resize(binner().size(), 0);
+        for (int ebin = 0; ebin < binner().energy_bins(); ++ebin) {
+            for (int abin = 0; abin < binner().angle_bins(); ++abin) {
+                m_base[binner().ident(ebin, abin)] =
+                    Dispersion::newBase(IrfBinner::hist_name(abin, ebin, "disp_base"));
+            }
+        }
+    }
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 DispPlots::~DispPlots()
-{}
+{
+    for (size_t i = 0; i < m_base.size(); i++) {
+        delete m_base[i];
+    }
+}
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 void DispPlots::fill(double deviat, double energy, double costheta)
+{
+    fillScaled(deviat/Dispersion::scaleFactor(energy, costheta,m_edisp_scaling_pars),
+               energy, costheta);
+}
+
+void DispPlots::fill(const std::vector<double> & deviats,
+                     const std::vector<double> & energies,
+                     const std::vector<double> & costhetas)
+{
+    std::vector<double> scales;
+    Dispersion::scaleFactors(energies, costhetas, m_edisp_scaling_pars, scales);
+    for (size_t k = 0; k < deviats.size(); ++k) {
+        fillScaled(deviats[k]/scales[k], energies[k], costhetas[k]);
+    }
+}
+
+void DispPlots::fillScaled(double scaled_delta, double energy, double costheta)
 {
     int z_bin = binner().angle_bin( costheta );     if( z_bin>= binner().angle_bins()) return;
     int e_bin = binner().energy_bin(energy);        if( e_bin<0 || e_bin>= binner().energy_bins() )return;
 
-//     int id =  binner().ident(e_bin, z_bin);
-    double scaled_delta =deviat/Dispersion::scaleFactor(energy, costheta,m_edisp_scaling_pars);
+    int indx(binner().hist_id(e_bin, z_bin));
+    if (indx >= 0) {
+        if (m_base.empty()) {
+            m_hists[indx].fill(scaled_delta);
+        } else {
+            Dispersion::fill(*m_base[indx], scaled_delta);
+        }
+    }
 
-//     m_hists[id].fill(scaled_delta);
+    // set special combined hist, accumulate all but last bins of angles
+    if( z_bin< binner().angle_bins()-2) {
+        m_hists[binner().ident(e_bin, binner().angle_bins())].fill(scaled_delta);
+    }
+
+}
 
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void DispPlots::sumOverlaps()
+{
+    if (m_base.empty()) {
+        return;
+    }
 // use over-lapping bins if da, de are non-zero:
     int da(binner().edispEnergyOverLap());
     int de(binner().edispAngleOverLap());
-    for (int eoffset(-de); eoffset < de + 1; eoffset++) {
-      for (int aoffset(-da); aoffset < da + 1; aoffset++) {
-         int indx(binner().hist_id(e_bin + eoffset, z_bin + aoffset));
-         if (indx >= 0) {
-	     m_hists[indx].fill(scaled_delta);
-
-	 }
-      }
+    for (int e_bin = 0; e_bin < binner().energy_bins(); ++e_bin) {
+        for (int z_bin = 0; z_bin < binner().angle_bins(); ++z_bin) {
+            const TH1F & base(*m_base[binner().ident(e_bin, z_bin)]);
+            for (int eoffset(-de); eoffset < de + 1; eoffset++) {
+                for (int aoffset(-da); aoffset < da + 1; aoffset++) {
+                    int indx(binner().hist_id(e_bin + eoffset, z_bin + aoffset));
+                    if (indx >= 0) {
+                        m_hists[indx].add(base);
+                    }
+                }
+            }
+        }
     }
-    // set special combined hist, accumulate all but last bins of angles
-    if( z_bin< binner().angle_bins()-2) {
-        m_hists[binner().ident(e_bin, binner().angle_bins())].fill(scaled_delta);
+    for (size_t i = 0; i < m_base.size(); i++) {
+        if (m_base[i] != 0) {
+            m_base[i]->Reset();
+        }
     }
+}
 
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void DispPlots::writeHists() const
+{
+    for (Displist::const_iterator it = m_hists.begin(); it != m_hists.end(); ++it) {
+        it->histogram()->Write();
+    }
+}
+
+void DispPlots::addHists(TDirectory & dir)
+{
+    for (Displist::iterator it = m_hists.begin(); it != m_hists.end(); ++it) {
+        it->add(IrfAnalysis::savedHist(dir, it->histogram()->GetName()));
+    }
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -116,9 +185,21 @@ void DispPlots::summarize()
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 void DispPlots::fit()
 {
-
-    for( Displist::iterator it = m_hists.begin(); it!=m_hists.end(); ++it){
-        (*it).fit();
+    // The bins are fit independently, so share them among the
+    // threads, with the slower fits balanced dynamically.  The
+    // progress messages are printed in bin order afterwards.
+    int nhists(m_hists.size());
+    std::vector<std::string> messages(nhists);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) num_threads(m_irf.threads())
+#endif
+    for (int i = 0; i < nhists; i++) {
+        std::ostringstream message;
+        m_hists[i].fit(message);
+        messages[i] = message.str();
+    }
+    for (int i = 0; i < nhists; i++) {
+        std::cout << messages[i];
     }
 }
 
@@ -156,7 +237,7 @@ void DispPlots::draw(const std::string &ps_filename ) {
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-void DispPlots::fillParameterTables()
+void DispPlots::fillParameterTables(handoff_response::IrfTableMap * tables)
 {
     // make a set of 2-d histograms with values of the fit parameters
     // binning according to energy and costheta bins 
@@ -183,7 +264,12 @@ void DispPlots::fillParameterTables()
         }
         h2->GetXaxis()->CenterTitle();
         h2->GetYaxis()->CenterTitle();
-        h2->Write();
+        if (tables) {
+            tables->add(name, handoff_response::IrfTable(h2));
+            delete h2;
+        } else {
+            h2->Write();
+        }
 
     }
 
@@ -197,5 +283,10 @@ void DispPlots::fillParameterTables()
        h1->SetBinContent(i, m_edisp_scaling_pars[i]);
     }
     h1->GetXaxis()->CenterTitle();
-    h1->Write();
+    if (tables) {
+        tables->add(histname, handoff_response::IrfTable(h1));
+        delete h1;
+    } else {
+        h1->Write();
+    }
 }
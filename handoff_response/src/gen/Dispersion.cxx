@@ -122,6 +122,32 @@ double Dispersion::scaleFactor(double energy,double  zdir,std::vector<double> ed
 
 }
 
+void Dispersion::scaleFactors(const std::vector<double> & energies,
+                              const std::vector<double> & zdirs,
+                              const std::vector<double> & edisp_scaling_pars,
+                              std::vector<double> & factors)
+{
+  // same polynomial as the TF2 in scaleFactor, written out so that
+  // the loop can be vectorized
+  int npts(energies.size());
+  factors.resize(npts);
+  if (npts == 0) {
+    return;
+  }
+  const double * energy(&energies[0]);
+  const double * zdir(&zdirs[0]);
+  double * factor(&factors[0]);
+  const double * p(&edisp_scaling_pars[0]);
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+  for (int i = 0; i < npts; i++) {
+    double x(::log10(energy[i]));
+    double y(::fabs(zdir[i]));
+    factor[i] = p[0]*x*x+p[1]*y*y + p[2]*x + p[3]*y + p[4]*x*y + p[5];
+  }
+}
+
 const char* Dispersion::parname(int i){return names[i];}
 
 int Dispersion::npars(){return sizeof(names)/sizeof(void*);}
@@ -185,10 +211,28 @@ Dispersion::~Dispersion()
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 void Dispersion::fill(double scaled_delta, double weight)
 {
-    hist().Fill( scaled_delta, weight );
+    fill(hist(), scaled_delta, weight);
     m_count++;
 }
 
+TH1F * Dispersion::newBase(const std::string & name)
+{
+    TH1F * base = new TH1F(name.c_str(), name.c_str(), nbins, xmin, xmax);
+    base->SetDirectory(0);
+    return base;
+}
+
+void Dispersion::fill(TH1F & base, double scaled_delta, double weight)
+{
+    base.Fill( scaled_delta, weight );
+}
+
+void Dispersion::add(const TH1 & base)
+{
+    hist().Add(&base);
+    m_count += static_cast<int>(base.GetEntries());
+}
+
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 void Dispersion::summary_title(std::ostream & out)
 {
@@ -240,10 +284,10 @@ double Dispersion::operator()(double* delta, double* par) {
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-void Dispersion::fit(std::string opts)
+void Dispersion::fit(std::ostream & log, std::string opts)
 {
   
-  std::cout << "\rProcessing " << hist().GetTitle()<<std::endl;
+  log << "\rProcessing " << hist().GetTitle()<<std::endl;
     TH1F & h = hist(); 
 
     // normalize the distribution
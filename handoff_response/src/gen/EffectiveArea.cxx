@@ -6,6 +6,7 @@
 
 #include "EffectiveArea.h"
 #include "IrfAnalysis.h"
+#include "../fits/IrfTableMap.h"
 #include "Setup.h"
 #include "embed_python/Module.h"
 
@@ -74,6 +75,16 @@ void EffectiveArea::fill(double energy, double costheta, bool /*front*/, int /*t
     m_hist->Fill( loge, ::fabs(costheta));
 }
 
+void EffectiveArea::writeHists() const
+{
+    m_hist->Write();
+}
+
+void EffectiveArea::addHists(TDirectory & dir)
+{
+    m_hist->Add(&IrfAnalysis::savedHist(dir, m_hist->GetName()));
+}
+
 void EffectiveArea::summarize()
 {
     // make nice list of the bin centers and areas for iteration below
@@ -113,6 +124,11 @@ void EffectiveArea::summarize()
     m_hist->Sumw2();
     m_hist->Divide(denomhist);
     m_hist->Scale(factor);
+    if (m_irf.tables_only()) {
+        // only the parameter table, from m_hist, is needed
+        delete denomhist;
+        return;
+    }
     denomhist->Write(); 
     m_hist->GetXaxis()->SetTitleOffset(1.5);
     m_hist->GetYaxis()->SetTitleOffset(1.5);
@@ -136,7 +152,11 @@ void EffectiveArea::writeFitParameters(std::string /*outputFile*/, std::string /
 {
 }
 
-void EffectiveArea::fillParameterTables()
+void EffectiveArea::fillParameterTables(handoff_response::IrfTableMap * tables)
 {
-    m_hist->Write(); // update in the output file
+    if (tables) {
+        tables->add(m_hist->GetName(), handoff_response::IrfTable(m_hist));
+    } else {
+        m_hist->Write(); // update in the output file
+    }
 }
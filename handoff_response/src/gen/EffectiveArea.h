@@ -10,6 +10,10 @@
 #include <iostream>
 #include <string>
 class IrfAnalysis;
+class TDirectory;
+namespace handoff_response {
+   class IrfTableMap;
+}
 class TH2F;
 
 /** @class EffectiveArea
@@ -23,13 +27,22 @@ public:
 
     void fill(double energy, double costheta, bool front, int count=0);
 
+    /// write the histogram to the current directory, for a
+    /// checkpoint of the projection
+    void writeHists() const;
+
+    /// add the histogram written by writeHists to dir
+    void addHists(TDirectory & dir);
+
     void summarize();
 
     void draw(const std::string &ps_filename) ;
 
     void writeFitParameters(std::string outputFile, std::string treename);
 
-    void fillParameterTables();
+    /// write the normalized histogram to the current directory, or
+    /// add it to tables if given
+    void fillParameterTables(handoff_response::IrfTableMap * tables=0);
 
     
 private:
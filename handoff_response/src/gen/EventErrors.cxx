@@ -0,0 +1,68 @@
+/**
+ * @file EventErrors.cxx
+ * @brief The angular and energy errors for a block of merit events.
+ * @author J. Chiang
+ *
+ * $Header$
+ */
+
+#include <cmath>
+
+#include "EventErrors.h"
+
+void EventErrors::compute(const MeritBlock & block, int nthreads) {
+   int nevents(block.size());
+   resize(nevents);
+   if (nevents == 0) {
+      return;
+   }
+   const double * mcx(&block.mcXDir[0]);
+   const double * mcy(&block.mcYDir[0]);
+   const double * mcz(&block.mcZDir[0]);
+   const double * fitx(&block.bestXDir[0]);
+   const double * fity(&block.bestYDir[0]);
+   const double * fitz(&block.bestZDir[0]);
+   const double * mc_energy(&block.mcEnergy[0]);
+   const double * best_energy(&block.bestEnergy[0]);
+   double * my_diff(&diff[0]);
+   double * my_theta_err(&theta_err[0]);
+   double * my_dsp(&dsp[0]);
+   (void)(nthreads);
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp parallel for simd num_threads(nthreads) schedule(static)
+#elif defined(_OPENMP)
+#pragma omp parallel for num_threads(nthreads) schedule(static)
+#endif
+   for (int k = 0; k < nevents; k++) {
+      // phi_hat = zhat.cross(mc_dir).unit()
+      double phix(-mcy[k]);
+      double phiy(mcx[k]);
+      double phi_len(std::sqrt(phix*phix + phiy*phiy));
+      phix = phi_len > 0 ? phix/phi_len : 0;
+      phiy = phi_len > 0 ? phiy/phi_len : 0;
+
+      // theta_hat = phi_hat.cross(mc_dir).unit()
+      double thetax(phiy*mcz[k]);
+      double thetay(-phix*mcz[k]);
+      double thetaz(phix*mcy[k] - phiy*mcx[k]);
+      double theta_len(std::sqrt(thetax*thetax + thetay*thetay 
+                                 + thetaz*thetaz));
+      thetax = theta_len > 0 ? thetax/theta_len : 0;
+      thetay = theta_len > 0 ? thetay/theta_len : 0;
+      thetaz = theta_len > 0 ? thetaz/theta_len : 0;
+
+      my_theta_err[k] = (mcx[k] - fitx[k])*thetax 
+         + (mcy[k] - fity[k])*thetay + (mcz[k] - fitz[k])*thetaz;
+
+      // mc_dir.angle(fit_dir)
+      double ptot2((mcx[k]*mcx[k] + mcy[k]*mcy[k] + mcz[k]*mcz[k])
+                   *(fitx[k]*fitx[k] + fity[k]*fity[k] 
+                     + fitz[k]*fitz[k]));
+      double arg(ptot2 > 0 ? (mcx[k]*fitx[k] + mcy[k]*fity[k] 
+                              + mcz[k]*fitz[k])/std::sqrt(ptot2) : 1);
+      arg = arg > 1 ? 1 : (arg < -1 ? -1 : arg);
+      my_diff[k] = std::acos(arg);
+
+      my_dsp[k] = best_energy[k]/mc_energy[k] - 1;
+   }
+}
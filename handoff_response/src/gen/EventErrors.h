@@ -0,0 +1,50 @@
+/**
+ * @file EventErrors.h
+ * @brief The angular and energy errors for a block of merit events.
+ * @author J. Chiang
+ *
+ * $Header$
+ */
+
+#ifndef handoff_response_EventErrors_h
+#define handoff_response_EventErrors_h
+
+#include <vector>
+
+#include "MeritReader.h"
+
+/**
+ * @class EventErrors
+ * @brief The errors that fill the PSF, energy dispersion and fisheye
+ * histograms, one array per quantity, in the order of the events in
+ * the block.
+ */
+
+class EventErrors {
+
+public:
+
+   /// Angle between the true and reconstructed directions (radians)
+   std::vector<double> diff;
+
+   /// Projection of the direction error on the theta unit vector
+   std::vector<double> theta_err;
+
+   /// Fractional energy error
+   std::vector<double> dsp;
+
+   void resize(size_t nevents) {
+      diff.resize(nevents);
+      theta_err.resize(nevents);
+      dsp.resize(nevents);
+   }
+
+   /// Compute the errors for all of the events in the block.  This is
+   /// the arithmetic of the HepGeom::Vector3D cross, unit and angle
+   /// functions, written out over the arrays so that the loop can be
+   /// vectorized.
+   void compute(const MeritBlock & block, int nthreads);
+
+};
+
+#endif // handoff_response_EventErrors_h
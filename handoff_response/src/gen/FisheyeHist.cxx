@@ -84,6 +84,12 @@ void FisheyeHist::fill(double scaled_delta, double weight)
     m_count++;
 }
 
+void FisheyeHist::add(const TH1 & saved)
+{
+    hist().Add(&saved);
+    m_count += saved.GetEntries();
+}
+
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 void FisheyeHist::summary_title(std::ostream & out)
 {
@@ -131,13 +137,13 @@ void FisheyeHist::summarize(std::ostream & out)
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-void FisheyeHist::fit(std::string opts)
+void FisheyeHist::fit(std::ostream & log, std::string opts)
 {
 
   // create the cumulative histgram before changing this one
   //  m_cumhist = cumulative_hist(hist());
 
-  std::cout << "\rProcessing " << hist().GetTitle();
+  log << "\rProcessing " << hist().GetTitle();
   TH1F & h = hist(); 
   int nbins = h.GetNbinsX();
 
@@ -171,7 +177,11 @@ void FisheyeHist::fit(std::string opts)
   m_mean = h.GetMean();
   m_mean_err = h.GetRMS()/sqrt(m_count);
 
-  TF1 * f1 = new TF1("f1","gaus");
+  TF1 * f1;
+#ifdef _OPENMP
+#pragma omp critical(handoff_response_root_objects)
+#endif
+  f1 = new TF1("f1","gaus");
   f1->SetParameter(0,1.0);
   f1->SetParameter(1,m_median);
   f1->SetParameter(2,1.0);
@@ -13,6 +13,7 @@ $Header$
 #include <string>
 #include <iostream>
 #include <vector>
+class TH1;
 class TH1F;
 
 class FisheyeHist {
@@ -28,6 +29,13 @@ public:
     /// add a point with a scaled angular difference delta
     void fill(double scaled_delta, double weight=1.0);
 
+    /// add the contents and entries of this histogram saved in a
+    /// checkpoint file
+    void add(const TH1 & saved);
+
+    /// the managed histogram, to be saved in a checkpoint file
+    const TH1F * histogram() const {return m_hist;}
+
     /// add a summary line to a table, with 68%, 95%, and fit parameters.
     void summarize(std::ostream & out);
 
@@ -35,7 +43,8 @@ public:
     void draw(double ymin=1e-6, double ymax=1.0, bool ylog=true);
 
     /// make a fit, using standard PSF function
-    void fit(std::string opts = "RQ");
+    /// @param log Stream for the progress message
+    void fit(std::ostream & log = std::cout, std::string opts = "RQ");
 
     /// get vector of fit parameters (all zero if not fit)
     void getFitPars(std::vector<double> & pars)const;
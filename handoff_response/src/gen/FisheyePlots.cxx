@@ -16,6 +16,7 @@ $Header$
 #include "TTree.h"
 #include "TCanvas.h"
 #include "IrfAnalysis.h"
+#include "../fits/IrfTableMap.h"
 
 #include <cmath>
 #include <iomanip>
@@ -73,6 +74,24 @@ FisheyePlots::~FisheyePlots()
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 void FisheyePlots::fill(double angle_diff, double energy, 
 			double costheta)
+{
+    fillScaled(angle_diff/PointSpreadFunction::scaleFactor(energy, costheta, m_psf_scaling_pars),
+               energy, costheta);
+}
+
+void FisheyePlots::fill(const std::vector<double> & diffs,
+                        const std::vector<double> & energies,
+                        const std::vector<double> & costhetas)
+{
+    std::vector<double> scales;
+    PointSpreadFunction::scaleFactors(energies, m_psf_scaling_pars, scales);
+    for (size_t k = 0; k < diffs.size(); ++k) {
+        fillScaled(diffs[k]/scales[k], energies[k], costhetas[k]);
+    }
+}
+
+void FisheyePlots::fillScaled(double scaled_delta, double energy, 
+                              double costheta)
 {
     int z_bin = binner().angle_bin( costheta );     
     if( z_bin>= binner().angle_bins()) return;
@@ -80,8 +99,6 @@ void FisheyePlots::fill(double angle_diff, double energy,
     if( e_bin<0 || e_bin>= binner().energy_bins() )return;
 
     int id =  binner().ident(e_bin, z_bin);
-    double scaled_delta = 
-      angle_diff/PointSpreadFunction::scaleFactor(energy, costheta, m_psf_scaling_pars);
     m_hists[id].fill(scaled_delta);
 }
 
@@ -94,13 +111,41 @@ void FisheyePlots::summarize()
   }
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-void FisheyePlots::fit()
+void FisheyePlots::writeHists() const
 {
-  for( PSFlist::iterator it = m_hists.begin(); it!=m_hists.end(); ++it){
-    (*it).fit();
+  for (PSFlist::const_iterator it = m_hists.begin(); it != m_hists.end(); ++it) {
+    it->histogram()->Write();
+  }
+}
+
+void FisheyePlots::addHists(TDirectory & dir)
+{
+  for (PSFlist::iterator it = m_hists.begin(); it != m_hists.end(); ++it) {
+    it->add(IrfAnalysis::savedHist(dir, it->histogram()->GetName()));
   }
 }
 
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void FisheyePlots::fit()
+{
+    // The bins are fit independently, so share them among the
+    // threads, with the slower fits balanced dynamically.  The
+    // progress messages are printed in bin order afterwards.
+    int nhists(m_hists.size());
+    std::vector<std::string> messages(nhists);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) num_threads(m_irf.threads())
+#endif
+    for (int i = 0; i < nhists; i++) {
+        std::ostringstream message;
+        m_hists[i].fit(message);
+        messages[i] = message.str();
+    }
+    for (int i = 0; i < nhists; i++) {
+        std::cout << messages[i];
+    }
+}
+
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 void FisheyePlots::draw(const std::string &ps_filename ) {
 
@@ -135,7 +180,7 @@ void FisheyePlots::draw(const std::string &ps_filename ) {
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-void FisheyePlots::fillParameterTables()
+void FisheyePlots::fillParameterTables(handoff_response::IrfTableMap * tables)
 {
     // make a set of 2-d histograms with values of the fit parameters
     // binning according to energy and costheta bins 
@@ -167,7 +212,12 @@ void FisheyePlots::fillParameterTables()
         }
         h2->GetXaxis()->CenterTitle();
         h2->GetYaxis()->CenterTitle();
-        h2->Write();
+        if (tables) {
+            tables->add(name, handoff_response::IrfTable(h2));
+            delete h2;
+        } else {
+            h2->Write();
+        }
 
     }
 }
@@ -8,6 +8,10 @@
 
 
 class IrfAnalysis;
+class TDirectory;
+namespace handoff_response {
+   class IrfTableMap;
+}
 
 #include "IrfBinner.h"
 #include "FisheyeHist.h"
@@ -26,6 +30,19 @@ public:
 
   void fill(double diff, double energy, double costheta);
 
+  /// fill with arrays of events, computing the scale factors for
+  /// all of them at once
+  void fill(const std::vector<double> & diffs,
+            const std::vector<double> & energies,
+            const std::vector<double> & costhetas);
+
+  /// write the histograms to the current directory, for a
+  /// checkpoint of the projection
+  void writeHists() const;
+
+  /// add the histograms written by writeHists to dir
+  void addHists(TDirectory & dir);
+
   void fit();
   void summarize();
 
@@ -35,12 +52,14 @@ public:
 
   const PSFlist& hists(){return m_hists;} 
     
-  // make a set of 2-d histograms with values of the fit parameters
-  void fillParameterTables();
+  // make a set of 2-d histograms with values of the fit parameters,
+  // written to the current directory, or added to tables if given
+  void fillParameterTables(handoff_response::IrfTableMap * tables=0);
 
   const IrfBinner & binner()const{return m_binner;}
 
 private:
+    void fillScaled(double scaled_delta, double energy, double costheta);
 
     IrfAnalysis& m_irf;
     IrfBinner m_binner;
@@ -0,0 +1,244 @@
+/**
+ * @file FlatMeritFile.cxx
+ * @brief Read and write the selected merit quantities in a flat,
+ * column-chunked binary format.
+ * @author J. Chiang
+ *
+ * $Header$
+ */
+
+#include <cstring>
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+#include "FlatMeritFile.h"
+
+namespace {
+   typedef unsigned int uint32;
+   typedef unsigned long long uint64;
+
+   uint32 swapped(uint32 value) {
+      return ((value & 0xff) << 24) | ((value & 0xff00) << 8) 
+         | ((value >> 8) & 0xff00) | (value >> 24);
+   }
+}
+
+const unsigned FlatMeritReader::version;
+const unsigned FlatMeritReader::byte_order;
+
+FlatMeritWriter::FlatMeritWriter(const std::string & filename) 
+   : m_filename(filename),
+     m_file(filename.c_str(), std::ios::out | std::ios::binary) {
+   if (!m_file) {
+      throw std::runtime_error("FlatMeritWriter: could not open " 
+                               + filename);
+   }
+   uint32 version(FlatMeritReader::version);
+   uint32 byte_order(FlatMeritReader::byte_order);
+   uint32 ncolumns(MeritBlock::ncolumns);
+   m_file.write(FlatMeritReader::tag(), std::strlen(FlatMeritReader::tag()));
+   m_file.write(reinterpret_cast<const char *>(&version), sizeof(version));
+   m_file.write(reinterpret_cast<const char *>(&byte_order), 
+                sizeof(byte_order));
+   m_file.write(reinterpret_cast<const char *>(&ncolumns), sizeof(ncolumns));
+}
+
+void FlatMeritWriter::write(const MeritBlock & block) {
+   uint64 nevents(block.size());
+   if (nevents == 0) {
+      return;
+   }
+   m_file.write(reinterpret_cast<const char *>(&nevents), sizeof(nevents));
+   for (size_t i(0); i < MeritBlock::ncolumns; i++) {
+      m_file.write(reinterpret_cast<const char *>(&block.column(i)[0]),
+                   nevents*sizeof(double));
+   }
+   if (!m_file) {
+      throw std::runtime_error("FlatMeritWriter: error writing to " 
+                               + m_filename);
+   }
+}
+
+FlatMeritReader::
+FlatMeritReader(const std::vector<std::string> & filenames) 
+   : m_filenames(filenames), m_ifile(0), m_file_size(0), m_next(0), 
+     m_entries(0), m_end(std::numeric_limits<long long>::max()) {}
+
+bool FlatMeritReader::read(size_t nmax, MeritBlock & block) {
+   if (m_entries >= m_end) {
+      nmax = 0;
+   } else if (m_end - m_entries < static_cast<long long>(nmax)) {
+      nmax = m_end - m_entries;
+   }
+   block.resize(nmax);
+   size_t nevents(0);
+   while (nevents < nmax) {
+      if (m_next == m_chunk.size() && !readChunk()) {
+         break;
+      }
+      size_t ncopy(std::min(nmax - nevents, m_chunk.size() - m_next));
+      for (size_t i(0); i < MeritBlock::ncolumns; i++) {
+         const std::vector<double> & src(m_chunk.column(i));
+         std::copy(src.begin() + m_next, src.begin() + m_next + ncopy,
+                   block.column(i).begin() + nevents);
+      }
+      m_next += ncopy;
+      nevents += ncopy;
+   }
+   block.resize(nevents);
+   m_entries += nevents;
+   return nevents > 0;
+}
+
+void FlatMeritReader::seek(long long entry) {
+   if (entry < m_entries) {
+      throw std::runtime_error("FlatMeritReader::seek: cannot seek "
+                               "backwards");
+   }
+   long long nskip(std::min(entry - m_entries, 
+                            static_cast<long long>(m_chunk.size() - m_next)));
+   m_next += nskip;
+   m_entries += nskip;
+   uint64 nevents(0);
+   while (m_entries < entry && readChunkSize(nevents)) {
+      if (m_entries + static_cast<long long>(nevents) <= entry) {
+         // Skip the whole chunk without reading its events.
+         m_file.seekg(nevents*MeritBlock::ncolumns*sizeof(double), 
+                      std::ios::cur);
+         if (!m_file || m_file.tellg() > m_file_size) {
+            throw std::runtime_error("FlatMeritReader: truncated chunk in " 
+                                     + m_filenames[m_ifile - 1]);
+         }
+         m_entries += nevents;
+      } else {
+         readChunkData(nevents);
+         m_next = entry - m_entries;
+         m_entries = entry;
+      }
+   }
+}
+
+long long FlatMeritReader::size() const {
+   long long nentries(0);
+   for (size_t i(0); i < m_filenames.size(); i++) {
+      const std::string & filename(m_filenames[i]);
+      std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+      if (!file) {
+         throw std::runtime_error("FlatMeritReader: could not open " 
+                                  + filename);
+      }
+      readHeader(file, filename);
+      std::streamoff position(file.tellg());
+      file.seekg(0, std::ios::end);
+      std::streamoff file_size(file.tellg());
+      file.seekg(position);
+      uint64 nevents(0);
+      while (file.read(reinterpret_cast<char *>(&nevents), sizeof(nevents))) {
+         position += sizeof(nevents) 
+            + nevents*MeritBlock::ncolumns*sizeof(double);
+         if (position > file_size) {
+            throw std::runtime_error("FlatMeritReader: truncated chunk in " 
+                                     + filename);
+         }
+         file.seekg(position);
+         nentries += nevents;
+      }
+      if (file.gcount() != 0) {
+         throw std::runtime_error("FlatMeritReader: truncated chunk header in "
+                                  + filename);
+      }
+   }
+   return nentries;
+}
+
+void FlatMeritReader::readHeader(std::istream & file, 
+                                 const std::string & filename) {
+   std::vector<char> tag(std::strlen(FlatMeritReader::tag()));
+   uint32 file_version(0), file_byte_order(0), ncolumns(0);
+   file.read(&tag[0], tag.size());
+   file.read(reinterpret_cast<char *>(&file_version), sizeof(file_version));
+   file.read(reinterpret_cast<char *>(&file_byte_order), 
+             sizeof(file_byte_order));
+   file.read(reinterpret_cast<char *>(&ncolumns), sizeof(ncolumns));
+   if (file 
+       && std::string(tag.begin(), tag.end()) == FlatMeritReader::tag()
+       && file_byte_order == swapped(byte_order)) {
+      throw std::runtime_error("FlatMeritReader: " + filename 
+                               + " was written with the opposite byte "
+                               "order; regenerate it on this machine.");
+   }
+   if (!file 
+       || std::string(tag.begin(), tag.end()) != FlatMeritReader::tag()
+       || file_version != version || file_byte_order != byte_order
+       || ncolumns != MeritBlock::ncolumns) {
+      std::ostringstream message;
+      message << "FlatMeritReader: " << filename 
+              << " is not a version " << version << " flat merit file.";
+      throw std::runtime_error(message.str());
+   }
+}
+
+bool FlatMeritReader::openNext() {
+   if (m_ifile == m_filenames.size()) {
+      return false;
+   }
+   const std::string & filename(m_filenames[m_ifile++]);
+   m_file.close();
+   m_file.clear();
+   m_file.open(filename.c_str(), std::ios::in | std::ios::binary);
+   if (!m_file) {
+      throw std::runtime_error("FlatMeritReader: could not open " + filename);
+   }
+   readHeader(m_file, filename);
+   std::streamoff position(m_file.tellg());
+   m_file.seekg(0, std::ios::end);
+   m_file_size = m_file.tellg();
+   m_file.seekg(position);
+   return true;
+}
+
+bool FlatMeritReader::readChunkSize(unsigned long long & nevents) {
+   while (true) {
+      if (m_file.is_open()) {
+         if (m_file.read(reinterpret_cast<char *>(&nevents), 
+                         sizeof(nevents))) {
+            return true;
+         }
+         // Only the end of the file may fall between chunks.
+         if (m_file.gcount() != 0) {
+            throw std::runtime_error("FlatMeritReader: truncated chunk "
+                                     "header in " 
+                                     + m_filenames[m_ifile - 1]);
+         }
+      }
+      if (!openNext()) {
+         return false;
+      }
+   }
+}
+
+void FlatMeritReader::readChunkData(unsigned long long nevents) {
+   m_chunk.resize(nevents);
+   for (size_t i(0); i < MeritBlock::ncolumns; i++) {
+      m_file.read(reinterpret_cast<char *>(&m_chunk.column(i)[0]),
+                  nevents*sizeof(double));
+   }
+   if (!m_file) {
+      throw std::runtime_error("FlatMeritReader: truncated chunk in " 
+                               + m_filenames[m_ifile - 1]);
+   }
+}
+
+bool FlatMeritReader::readChunk() {
+   m_next = 0;
+   m_chunk.resize(0);
+   uint64 nevents(0);
+   if (!readChunkSize(nevents)) {
+      return false;
+   }
+   readChunkData(nevents);
+   return true;
+}
@@ -0,0 +1,122 @@
+/**
+ * @file FlatMeritFile.h
+ * @brief Read and write the selected merit quantities in a flat,
+ * column-chunked binary format, as an alternative to the ROOT input.
+ * @author J. Chiang
+ *
+ * $Header$
+ */
+
+#ifndef handoff_response_FlatMeritFile_h
+#define handoff_response_FlatMeritFile_h
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "MeritReader.h"
+
+/**
+ * @class FlatMeritWriter
+ * @brief Write MeritBlocks to a flat file.
+ *
+ * The file is an 8 byte tag, "IRFMERIT", followed by the format
+ * version, the byte order marker 0x01020304 and the number of columns
+ * as 32 bit unsigned integers.  Then come chunks, one per block
+ * written.  Each chunk is the number of events as a 64 bit unsigned
+ * integer, followed by each column in MeritBlock::column order as an
+ * array of doubles.  All numbers are in the byte order of the machine
+ * that wrote the file, which the reader checks against the marker.
+ */
+
+class FlatMeritWriter {
+
+public:
+
+   FlatMeritWriter(const std::string & filename);
+
+   void write(const MeritBlock & block);
+
+private:
+
+   std::string m_filename;
+   std::ofstream m_file;
+
+};
+
+/**
+ * @class FlatMeritReader
+ * @brief Read the events from a list of flat files.  The events were
+ * selected when the files were written, so there are no cuts to
+ * apply.
+ */
+
+class FlatMeritReader : public MeritReader {
+
+public:
+
+   FlatMeritReader(const std::vector<std::string> & filenames);
+
+   virtual bool read(size_t nmax, MeritBlock & block);
+
+   virtual long long entries() const {
+      return m_entries;
+   }
+
+   /// The preceding chunks are skipped without reading their
+   /// events.
+   virtual void seek(long long entry);
+
+   /// The chunk headers of all of the files are read to count the
+   /// events.
+   virtual long long size() const;
+
+   virtual void setEnd(long long entry) {
+      m_end = entry;
+   }
+
+   static const char * tag() {
+      return "IRFMERIT";
+   }
+
+   static const unsigned version = 2;
+
+   static const unsigned byte_order = 0x01020304;
+
+private:
+
+   std::vector<std::string> m_filenames;
+   size_t m_ifile;
+   std::ifstream m_file;
+   std::streamoff m_file_size;
+
+   /// The chunk being read, and the next event in it.
+   MeritBlock m_chunk;
+   size_t m_next;
+
+   long long m_entries;
+
+   /// The entry at which to stop reading.
+   long long m_end;
+
+   /// Read and check the header of a file.
+   static void readHeader(std::istream & file, const std::string & filename);
+
+   /// Open the next file.  @return false if there are none.
+   bool openNext();
+
+   /// Read the number of events of the next chunk, opening files as
+   /// needed.  @return false if all of the files have been read.
+   /// @throw std::runtime_error if a file ends within a chunk header.
+   bool readChunkSize(unsigned long long & nevents);
+
+   /// Read the events of the chunk whose size was just read.
+   void readChunkData(unsigned long long nevents);
+
+   /// Read the next chunk.  @return false if all of the files have
+   /// been read.
+   bool readChunk();
+
+};
+
+#endif // handoff_response_FlatMeritFile_h
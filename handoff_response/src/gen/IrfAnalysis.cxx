@@ -10,26 +10,127 @@
 #include "DispPlots.h"
 #include "EffectiveArea.h"
 #include "AeffPhiDep.h"
+#include "EventErrors.h"
 #include "TreeWrapper.h"
+#include "RootMeritReader.h"
+#include "FlatMeritFile.h"
 #include "Dispersion.h"
 #include "PointSpreadFunction.h"
 #include "embed_python/Module.h"
 
-#include "CLHEP/Geometry/Vector3D.h"
+#include "../fits/IrfTableMap.h"
+#include "../fits/createFitsFiles.h"
 
+#include "Math/MinimizerOptions.h"
 #include "TFile.h"
+#include "TH1.h"
+#include "TKey.h"
+#include "TNamed.h"
+#include "TParameter.h"
+#include "TROOT.h"
 #include "TTree.h"
-#include "TEventList.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
 #include <iomanip>
 #include <fstream>
 #include <ios>
+#include <limits>
+#include <map>
+#include <sstream>
 #include <stdexcept>
 
 namespace {
    inline static double sqr(double x) {
       return x*x;
    }
+
+   /// Number of merit entries read into memory at a time.
+   const int s_blockSize(100000);
+
+   /// Write a value to the current directory, for a checkpoint.
+   template <typename T>
+   void writeParameter(const char * name, T value) {
+      TParameter<T> parameter(name, value);
+      parameter.Write();
+   }
+
+   void writeString(const char * name, const std::string & value) {
+      TNamed named(name, value.c_str());
+      named.Write();
+   }
+
+   std::string readString(TDirectory & dir, const char * name) {
+      TNamed * named(dynamic_cast<TNamed *>(dir.Get(name)));
+      if (named == 0) {
+         throw std::runtime_error(std::string("IrfAnalysis: checkpoint value ")
+                                  + name + " not found in " + dir.GetName());
+      }
+      return named->GetTitle();
+   }
+
+   template <typename T>
+   T readParameter(TDirectory & dir, const char * name) {
+      TParameter<T> * parameter(dynamic_cast<TParameter<T> *>(dir.Get(name)));
+      if (parameter == 0) {
+         throw std::runtime_error(std::string("IrfAnalysis: checkpoint value ")
+                                  + name + " not found in " + dir.GetName());
+      }
+      return parameter->GetVal();
+   }
+
+   /// Enable ROOT's implicit multi-threading, so that the branches
+   /// are decompressed on the worker threads, for the lifetime of the
+   /// object, unless it was already enabled.
+   class ImplicitMT {
+   public:
+      ImplicitMT(int nthreads) : m_enabled(false) {
+#ifdef R__USE_IMT
+         if (nthreads > 1 && !ROOT::IsImplicitMTEnabled()) {
+            ROOT::EnableImplicitMT(nthreads);
+            m_enabled = true;
+         }
+#else
+         (void)(nthreads);
+#endif
+      }
+      ~ImplicitMT() {
+#ifdef R__USE_IMT
+         if (m_enabled) {
+            ROOT::DisableImplicitMT();
+         }
+#endif
+      }
+   private:
+      bool m_enabled;
+   };
+
+   /// Make Minuit2 the default minimizer for the lifetime of the
+   /// object if the fits are run on more than one thread, since
+   /// TMinuit, the usual default, uses a global instance.  The
+   /// previous default is restored afterwards.
+   class DefaultMinimizer {
+   public:
+      DefaultMinimizer(int nthreads) 
+         : m_type(ROOT::Math::MinimizerOptions::DefaultMinimizerType()),
+           m_algo(ROOT::Math::MinimizerOptions::DefaultMinimizerAlgo()),
+           m_changed(nthreads > 1) {
+         if (m_changed) {
+            ROOT::Math::MinimizerOptions::SetDefaultMinimizer("Minuit2");
+         }
+      }
+      ~DefaultMinimizer() {
+         if (m_changed) {
+            ROOT::Math::MinimizerOptions::SetDefaultMinimizer(m_type.c_str(),
+                                                              m_algo.c_str());
+         }
+      }
+   private:
+      std::string m_type;
+      std::string m_algo;
+      bool m_changed;
+   };
 }
 
 IrfAnalysis::IrfAnalysis(std::string output_folder,
@@ -43,7 +144,12 @@ IrfAnalysis::IrfAnalysis(std::string output_folder,
      m_bestYDir("CTBBestYDir"),
      m_bestZDir("CTBBestZDir"),
      m_bestEnergy("CTBBestEnergy"),
-     m_front_only_psf_scaling(false) {
+     m_front_only_psf_scaling(false),
+     m_threads(1),
+     m_checkpoint_interval(1000000),
+     m_project_only(false),
+     m_tables_only(false),
+     m_new_edisp(false) {
    std::string logfile;
    std::string selectionName;
 
@@ -57,6 +163,14 @@ IrfAnalysis::IrfAnalysis(std::string output_folder,
      m_make_plots = bool(make_plots);
      py.getValue("outputType", m_output_type);
    } catch (std::invalid_argument &) { }
+   try {
+     int tables_only = 0;
+     py.getValue("tablesOnly", tables_only);
+     m_tables_only = bool(tables_only);
+   } catch (std::invalid_argument &) { }
+   if (m_tables_only) {
+     m_make_plots = false;
+   }
 
    m_filename_root = selectionName;
    m_outputfile = selectionName + ".root";
@@ -68,6 +182,22 @@ IrfAnalysis::IrfAnalysis(std::string output_folder,
    }
 
    py.getValue("parameterFile", m_parameterFile);
+   try {
+      py.getValue("irfVersion", m_irf_version);
+   } catch (std::invalid_argument &) {
+      /// Leave the FITS files to make_fits.
+   }
+   int edisp_version(1);
+   try {
+      py.getValue("Edisp.Version", edisp_version);
+   } catch (std::invalid_argument &) {
+   }
+   m_new_edisp = (edisp_version != 1);
+   if (m_tables_only && m_parameterFile.empty() && m_irf_version.empty()) {
+      throw std::runtime_error("IrfAnalysis: tablesOnly requires a "
+                               "parameterFile or an irfVersion for the "
+                               "tables.");
+   }
 
    py.getValue("Data.generate_area", m_generate_area);
 
@@ -79,6 +209,64 @@ IrfAnalysis::IrfAnalysis(std::string output_folder,
    } catch (std::invalid_argument &) {
       /// These are missing, so use defaults.
    }
+   try {
+      py.getValue("Data.threads", m_threads);
+   } catch (std::invalid_argument &) {
+      /// Use the default of one thread.
+   }
+   m_threads = std::max(m_threads, 1);
+   try {
+      py.getList("Data.flat_files", m_flat_files);
+   } catch (std::invalid_argument &) {
+      /// Read the merit files.
+   }
+   try {
+      py.getValue("Data.flat_output", m_flat_output);
+   } catch (std::invalid_argument &) {
+      /// Do not write a flat file.
+   }
+   try {
+      py.getValue("Data.checkpoint_file", m_checkpoint_file);
+      py.getValue("Data.checkpoint_interval", m_checkpoint_interval);
+   } catch (std::invalid_argument &) {
+      /// Do not save checkpoints.
+   }
+   try {
+      int project_only(0);
+      py.getValue("Data.project_only", project_only);
+      m_project_only = bool(project_only);
+   } catch (std::invalid_argument &) {
+      /// Do the fits in this run.
+   }
+   if (shard_count() > 1) {
+      // The fits are made from the merged shards.
+      m_project_only = true;
+      if (m_checkpoint_file.empty()) {
+         std::ostringstream filename;
+         filename << m_output_dir << "/" << selectionName << "_shard" 
+                  << shard_index() << ".root";
+         m_checkpoint_file = filename.str();
+      }
+      std::cout << "Projecting shard " << shard_index() << " of " 
+                << shard_count() << " to " << m_checkpoint_file 
+                << std::endl;
+   }
+   m_fingerprint = makeFingerprint(py);
+   if (m_project_only && m_checkpoint_file.empty()) {
+      throw std::runtime_error("IrfAnalysis: Data.project_only requires "
+                               "a Data.checkpoint_file for the fits.");
+   }
+#ifdef _OPENMP
+   std::cout << "Projecting events with " << m_threads 
+             << " thread(s)" << std::endl;
+#else
+   m_threads = 1;
+#endif
+   if (m_threads > 1) {
+      // Both the projection and the fits use ROOT on several threads,
+      // and the fits may be made from a complete checkpoint.
+      ROOT::EnableThreadSafety();
+   }
    std::cout << "Using variables "
              << m_bestXDir << ", "
              << m_bestYDir << ", "
@@ -104,19 +292,50 @@ IrfAnalysis::IrfAnalysis(std::string output_folder,
 
 void IrfAnalysis::project(embed_python::Module & py) {
 
-  // If skim file is undefined load events directly from the TChain
-  if(skim_filename().empty())
-    makeCutTree();
-  else
-    open_input_file();
+   Projection state;
+   bool resume(readCheckpoint(state));
+   state.fingerprint = m_fingerprint;
+   state.shard_index = shard_index();
+   state.shard_count = shard_count();
+   if (resume) {
+      out() << "Resuming the projection from " << m_checkpoint_file
+            << " at entry " << state.next_entry << std::endl;
+      if (!state.complete && !m_flat_output.empty()) {
+         throw std::runtime_error("IrfAnalysis::project: cannot write "
+                                  "Data.flat_output when resuming from "
+                                  + m_checkpoint_file);
+      }
+   }
+
+   MeritReader * reader(0);
+   if (state.complete) {
+      // The histograms are all in the checkpoint file.
+   } else if (!m_flat_files.empty()) {
+      std::cout << "Reading events from " << m_flat_files.size()
+                << " flat merit file(s)" << std::endl;
+      reader = new FlatMeritReader(m_flat_files);
+   } else {
+      // If skim file is undefined load events directly from the TChain
+      if(skim_filename().empty())
+         makeCutTree();
+      else
+         open_input_file();
+   }
 
    // for the histograms
-   TFile * m_hist_file= new TFile(summary_filename().c_str(), "recreate");
-   std::cout << " writing irf summary plots to " 
-             << summary_filename() << std::endl;
-   out() << " writing irf summary plots to " 
-         << summary_filename() << std::endl;
-   std::cout << std::endl;
+   TFile * m_hist_file(0);
+   if (m_tables_only) {
+      // None of the histograms are saved, so keep them out of the
+      // ROOT directories.  m_add_directory restores the setting.
+      TH1::AddDirectory(false);
+   } else {
+      m_hist_file = new TFile(summary_filename().c_str(), "recreate");
+      std::cout << " writing irf summary plots to " 
+                << summary_filename() << std::endl;
+      out() << " writing irf summary plots to " 
+            << summary_filename() << std::endl;
+      std::cout << std::endl;
+   }
 
    //---- declare the IRF plots------
    //---------------------------
@@ -129,104 +348,499 @@ void IrfAnalysis::project(embed_python::Module & py) {
 
    m_fisheye = new FisheyePlots(*this,out(),py);
 
-   std::cout << "Selecting columns in tree " << tree().GetName() << std::endl;
-   unsigned EvtRun(0);
-   float McEnergy(0.0), Tkr1FirstLayer(0.0);
-   double BestEnergy(0.0), McXDir(0.0), McYDir(0.0), McZDir(0.0),
-     BestXDir(0.0), BestYDir(0.0), BestZDir(0.0);
-
-   tree().SetBranchAddress("EvtRun", &EvtRun);
-   tree().SetBranchAddress("McEnergy", &McEnergy);
-   tree().SetBranchAddress("Tkr1FirstLayer", &Tkr1FirstLayer);
-   tree().SetBranchAddress(m_bestEnergy.c_str(), &BestEnergy);
-   tree().SetBranchAddress("McXDir", &McXDir);
-   tree().SetBranchAddress("McYDir", &McYDir);
-   tree().SetBranchAddress("McZDir", &McZDir);
-   tree().SetBranchAddress(m_bestXDir.c_str(), &BestXDir);
-   tree().SetBranchAddress(m_bestYDir.c_str(), &BestYDir);
-   tree().SetBranchAddress(m_bestZDir.c_str(), &BestZDir);
-   
-   int lastrun(0), selected(0), total(0), nruns(0);
+   if (resume) {
+      addCheckpointHists();
+   }
+   if (!state.complete) {
+      if (reader == 0) {
+         reader = new RootMeritReader(*this, m_bestXDir, m_bestYDir,
+                                      m_bestZDir, m_bestEnergy);
+      }
+      // Without shards, the entries are not counted in advance.
+      long long first_entry(0);
+      if (shard_count() > 1) {
+         long long nentries(reader->size()), end_entry;
+         shardRange(nentries, first_entry, end_entry);
+         reader->setEnd(end_entry);
+         std::cout << "Shard " << shard_index() << " of " << shard_count()
+                   << " projects entries " << first_entry << " to " 
+                   << end_entry << " of " << nentries << std::endl;
+      }
+      if (!resume) {
+         state.first_entry = first_entry;
+         state.next_entry = first_entry;
+      } else if (state.first_entry != first_entry) {
+         throw std::runtime_error("IrfAnalysis::project: the number of "
+                                  "input entries has changed since "
+                                  + m_checkpoint_file + " was saved");
+      }
+      projectEvents(*reader, state);
+   }
+   delete reader;
+
+   // A shard may select no events, but the merged shards must.
+   long long examined(state.next_entry - state.first_entry);
+   if (state.selected_events == 0 && shard_count() == 1) {
+      std::ostringstream message;
+      message << "IrfAnalysis::project: none of the " << examined
+              << " entries read pass the cuts \"" << cuts() << "\"";
+      throw std::runtime_error(message.str());
+   }
+
    double minlogE(1e6), maxlogE(0);
-   double minzdir(1), maxzdir(-1);
+   if (state.selected_events > 0) {
+      minlogE = std::log10(state.minEnergy);
+      maxlogE = std::log10(state.maxEnergy);
+   }
+   out() << "\nFound " << state.nruns <<" run numbers" 
+         << " and " << state.selected_events << "/" 
+         << examined << " events" <<  std::endl;
+   out() << "Log energy range: " << minlogE << " to " << maxlogE << std::endl;
+   out() << "McZDir range: " << state.minzdir << " to " << state.maxzdir 
+         << std::endl;
+   
+   if (m_hist_file) {
+      m_hist_file->Write();
+   }
+}
+
+void IrfAnalysis::projectEvents(MeritReader & reader, Projection & state) {
 
-   int nentries(0);
-   if(list() != NULL) 
-     nentries = list()->GetN();
-   else
-     nentries = tree().GetEntries();
+   reader.seek(state.next_entry);
 
-   for(int i = 0; i < nentries; i++) {
+   FlatMeritWriter * writer(0);
+   if (!m_flat_output.empty()) {
+      std::cout << "Writing selected events to " << m_flat_output 
+                << std::endl;
+      writer = new FlatMeritWriter(m_flat_output);
+   }
 
-      int ii = i;
-      if(list() != NULL) {
-	ii = list()->GetEntry(i);
+   ImplicitMT implicit_mt(m_threads);
+
+   int total(0);
+   long long last_checkpoint(state.next_entry);
+
+   // Two blocks, so that the next one is read while the current one
+   // is being projected, and the reader entry at the end of each.
+   MeritBlock blocks[2];
+   long long block_ends[2];
+   EventErrors errors;
+   reader.read(s_blockSize, blocks[0]);
+   block_ends[0] = reader.entries();
+   for (int current(0); blocks[current].size() > 0; current = 1 - current) {
+      const MeritBlock & block(blocks[current]);
+      MeritBlock & next_block(blocks[1 - current]);
+      int nevents(block.size());
+
+      for (int k(0); k < nevents; k++) {
+         if (block.evtRun[k] != state.lastrun) {
+            ++state.nruns;
+            state.lastrun = block.evtRun[k];
+         }
+         state.minEnergy = std::min(state.minEnergy, block.mcEnergy[k]);
+         state.maxEnergy = std::max(state.maxEnergy, block.mcEnergy[k]);
+         state.minzdir = std::min(state.minzdir, block.mcZDir[k]);
+         state.maxzdir = std::max(state.maxzdir, block.mcZDir[k]);
       }
-      tree().GetEvent(ii);
-      if (EvtRun != lastrun) {
-         ++nruns;
-         lastrun = EvtRun;
+      state.selected_events += nevents;
+      if (writer) {
+         writer->write(block);
       }
-      double logE(log10(McEnergy));
-      if (logE < minlogE) {
-         minlogE = logE;
+
+      errors.compute(block, m_threads);
+
+      // Each set of histograms is filled by a single task, in entry
+      // order, so the histograms are the same as for a serial fill,
+      // whatever the number of threads.  The next block is read
+      // meanwhile.  An exception cannot leave the parallel region, so
+      // it is rethrown afterwards.
+      const int ntasks(6);
+      std::string error;
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(m_threads) schedule(dynamic, 1)
+#endif
+      for (int task = 0; task < ntasks; task++) {
+         try {
+            switch (task) {
+            case 0:
+               reader.read(s_blockSize, next_block);
+               break;
+            case 1:
+               m_fisheye->fill(errors.theta_err, block.mcEnergy,
+                               block.mcZDir);
+               break;
+            case 2:
+               m_psf->fill(errors.diff, block.mcEnergy, block.mcZDir);
+               break;
+            case 3:
+               m_disp->fill(errors.dsp, block.mcEnergy, block.mcZDir);
+               break;
+            case 4:
+               for (int k = 0; k < nevents; k++) {
+                  m_aeff->fill(block.mcEnergy[k], block.mcZDir[k], 
+                               block.front(k), total);
+               }
+               break;
+            case 5:
+               for (int k = 0; k < nevents; k++) {
+                  m_phi_dep->fill(block.mcXDir[k], block.mcYDir[k],
+                                  block.mcEnergy[k], block.mcZDir[k]);
+               }
+               break;
+            }
+         } catch (std::exception & eObj) {
+#ifdef _OPENMP
+#pragma omp critical(handoff_response_projection_error)
+#endif
+            error = eObj.what();
+         }
       }
-      if (logE > maxlogE) {
-         maxlogE = logE;
+      if (!error.empty()) {
+         throw std::runtime_error(error);
       }
-      if (McZDir < minzdir) {
-         minzdir = McZDir;
+      block_ends[1 - current] = reader.entries();
+
+      // The histograms now hold the events up to the end of the
+      // current block.
+      state.next_entry = block_ends[current];
+      if (!m_checkpoint_file.empty() && m_checkpoint_interval > 0
+          && state.next_entry - last_checkpoint >= m_checkpoint_interval) {
+         saveCheckpoint(state);
+         last_checkpoint = state.next_entry;
       }
-      if (McZDir > maxzdir) {
-         maxzdir = McZDir;
+   }
+   state.next_entry = reader.entries();
+   state.complete = true;
+
+   delete writer;
+
+   if (!m_checkpoint_file.empty()) {
+      saveCheckpoint(state);
+   }
+   m_psf->sumOverlaps();
+   m_disp->sumOverlaps();
+}
+
+IrfAnalysis::AddDirectoryStatus::AddDirectoryStatus() 
+   : m_status(TH1::AddDirectoryStatus()) {}
+
+IrfAnalysis::AddDirectoryStatus::~AddDirectoryStatus() {
+   TH1::AddDirectory(m_status);
+}
+
+IrfAnalysis::Projection::Projection() 
+   : next_entry(0), selected_events(0), nruns(0), lastrun(0),
+     minEnergy(std::numeric_limits<double>::max()), maxEnergy(0),
+     minzdir(1), maxzdir(-1), complete(false), first_entry(0), 
+     shard_index(0),
+     shard_count(1) {}
+
+void IrfAnalysis::Projection::read(TDirectory & dir) {
+   next_entry = readParameter<Long64_t>(dir, "next_entry");
+   selected_events = readParameter<Long64_t>(dir, "selected_events");
+   nruns = readParameter<Long64_t>(dir, "nruns");
+   lastrun = readParameter<double>(dir, "lastrun");
+   minEnergy = readParameter<double>(dir, "minEnergy");
+   maxEnergy = readParameter<double>(dir, "maxEnergy");
+   minzdir = readParameter<double>(dir, "minzdir");
+   maxzdir = readParameter<double>(dir, "maxzdir");
+   complete = readParameter<Bool_t>(dir, "complete");
+   first_entry = readParameter<Long64_t>(dir, "first_entry");
+   fingerprint = readString(dir, "fingerprint");
+   shard_index = readParameter<Int_t>(dir, "shard_index");
+   shard_count = readParameter<Int_t>(dir, "shard_count");
+}
+
+void IrfAnalysis::Projection::write() const {
+   writeParameter<Long64_t>("next_entry", next_entry);
+   writeParameter<Long64_t>("selected_events", selected_events);
+   writeParameter<Long64_t>("nruns", nruns);
+   writeParameter<double>("lastrun", lastrun);
+   writeParameter<double>("minEnergy", minEnergy);
+   writeParameter<double>("maxEnergy", maxEnergy);
+   writeParameter<double>("minzdir", minzdir);
+   writeParameter<double>("maxzdir", maxzdir);
+   writeParameter<Bool_t>("complete", complete);
+   writeParameter<Long64_t>("first_entry", first_entry);
+   writeString("fingerprint", fingerprint);
+   writeParameter<Int_t>("shard_index", shard_index);
+   writeParameter<Int_t>("shard_count", shard_count);
+}
+
+void IrfAnalysis::Projection::add(const Projection & other) {
+   next_entry += other.next_entry - other.first_entry;
+   selected_events += other.selected_events;
+   nruns += other.nruns;
+   lastrun = other.lastrun;
+   minEnergy = std::min(minEnergy, other.minEnergy);
+   maxEnergy = std::max(maxEnergy, other.maxEnergy);
+   minzdir = std::min(minzdir, other.minzdir);
+   maxzdir = std::max(maxzdir, other.maxzdir);
+   complete = complete && other.complete;
+}
+
+bool IrfAnalysis::readCheckpoint(Projection & state) const {
+   if (m_checkpoint_file.empty() 
+       || !std::ifstream(m_checkpoint_file.c_str())) {
+      return false;
+   }
+   TDirectory * current(gDirectory);
+   TFile file(m_checkpoint_file.c_str());
+   if (file.IsZombie()) {
+      throw std::runtime_error("IrfAnalysis::readCheckpoint: could not "
+                               "open " + m_checkpoint_file);
+   }
+   state.read(file);
+   file.Close();
+   current->cd();
+   if (state.fingerprint != m_fingerprint) {
+      throw std::runtime_error("IrfAnalysis::readCheckpoint: "
+                               + m_checkpoint_file + " was saved by a run "
+                               "with different input files, cuts, scaling "
+                               "parameters or bins:\n" + state.fingerprint 
+                               + "\nThis run has:\n" + m_fingerprint);
+   }
+   if (state.shard_index != shard_index() 
+       || state.shard_count != shard_count()) {
+      std::ostringstream message;
+      message << "IrfAnalysis::readCheckpoint: " << m_checkpoint_file 
+              << " is the projection of shard " << state.shard_index 
+              << " of " << state.shard_count << ", not of shard " 
+              << shard_index() << " of " << shard_count();
+      throw std::runtime_error(message.str());
+   }
+   return true;
+}
+
+std::string IrfAnalysis::makeFingerprint(embed_python::Module & py) const {
+   std::vector<std::string> files, flat_files;
+   py.getList("Data.files", files);
+   try {
+      py.getList("Data.flat_files", flat_files);
+   } catch (std::invalid_argument &) {
+   }
+   std::vector<double> psf_pars, edisp_pars;
+   py.getList("PSF.scaling_pars", psf_pars);
+   py.getList("Edisp.scaling_pars", edisp_pars);
+   IrfBinner fisheye_binner(py, "FisheyeBins");
+
+   std::ostringstream fingerprint;
+   fingerprint << std::setprecision(17);
+   fingerprint << "files:";
+   for (size_t i(0); i < files.size(); i++) {
+      fingerprint << " " << files[i];
+   }
+   fingerprint << "\nflat_files:";
+   for (size_t i(0); i < flat_files.size(); i++) {
+      fingerprint << " " << flat_files[i];
+   }
+   fingerprint << "\nprune_file: " << skim_filename()
+               << "\ncuts: " << cuts()
+               << "\nvariables: " << m_bestXDir << " " << m_bestYDir << " " 
+               << m_bestZDir << " " << m_bestEnergy;
+   fingerprint << "\npsf_scaling:";
+   for (size_t i(0); i < psf_pars.size(); i++) {
+      fingerprint << " " << psf_pars[i];
+   }
+   fingerprint << "\nedisp_scaling:";
+   for (size_t i(0); i < edisp_pars.size(); i++) {
+      fingerprint << " " << edisp_pars[i];
+   }
+   const IrfBinner * binners[] = {&m_binner, &fisheye_binner};
+   const char * names[] = {"bins", "fisheye_bins"};
+   for (size_t j(0); j < 2; j++) {
+      const std::vector<double> & 
+         energies(binners[j]->energy_bin_edges()),
+         angles(binners[j]->angle_bin_edges());
+      fingerprint << "\n" << names[j] << " energy:";
+      for (size_t i(0); i < energies.size(); i++) {
+         fingerprint << " " << energies[i];
       }
-      
-      bool front = Tkr1FirstLayer > 5;
-      ++selected;
-
-      // calculate theta, phi components of the error
-      HepGeom::Vector3D<double>
-         mc_dir(McXDir, McYDir, McZDir), 
-   	fit_dir(BestXDir, BestYDir, BestZDir);
-
-      //Approximated version to check theta- and phi- projections
-      HepGeom::Vector3D<double> 
-   	mc_error(mc_dir - fit_dir), zhat(0, 0, 1),
-   	phi_hat = zhat.cross(mc_dir).unit(),
-   	theta_hat = phi_hat.cross(mc_dir).unit();
-
-      double phi_err = mc_error*phi_hat,
-   	theta_err = mc_error*theta_hat;
-   	//	diff = sqrt(sqr(theta_err) + sqr(phi_err));
-
-      //exact version
-      double diff=mc_dir.angle(fit_dir);
-      
-      // choose one of the following
-      double measured_energy = BestEnergy, 
-         mc_energy = McEnergy,
-         //ratio =measured_energy/mc_energy,
-         dsp = measured_energy/mc_energy - 1;
-
-      m_fisheye->fill(theta_err, McEnergy, McZDir);
-      m_psf->fill(diff, McEnergy, McZDir);
-      m_disp->fill(dsp, McEnergy, McZDir);
-      m_aeff->fill(mc_energy, McZDir, front, total);
-      m_phi_dep->fill(McXDir, McYDir, McEnergy, McZDir);
-   }
-     
-   out() << "\nFound " << nruns <<" run numbers" 
-         << " and " << selected<< "/" 
-         <<  tree().GetEntries() << " events" <<  std::endl;
-   out() << "Log energy range: " << minlogE << " to " << maxlogE << std::endl;
-   out() << "McZDir range: " << minzdir << " to " << maxzdir << std::endl;
-   
-   m_hist_file->Write();}
+      fingerprint << "\n" << names[j] << " angle:";
+      for (size_t i(0); i < angles.size(); i++) {
+         fingerprint << " " << angles[i];
+      }
+   }
+   fingerprint << "\noverlaps: " 
+               << m_binner.psfEnergyOverLap() << " " 
+               << m_binner.psfAngleOverLap() << " "
+               << m_binner.edispEnergyOverLap() << " " 
+               << m_binner.edispAngleOverLap();
+   return fingerprint.str();
+}
+
+void IrfAnalysis::addCheckpointHists() {
+   TDirectory * current(gDirectory);
+   TFile file(m_checkpoint_file.c_str());
+   if (file.IsZombie()) {
+      throw std::runtime_error("IrfAnalysis::addCheckpointHists: could not "
+                               "open " + m_checkpoint_file);
+   }
+   m_psf->addHists(file);
+   m_disp->addHists(file);
+   m_fisheye->addHists(file);
+   m_aeff->addHists(file);
+   m_phi_dep->addHists(file);
+   file.Close();
+   current->cd();
+}
+
+void IrfAnalysis::saveCheckpoint(const Projection & state) {
+   m_psf->sumOverlaps();
+   m_disp->sumOverlaps();
+
+   // Write a temporary file, and rename it when it is complete, so
+   // that an interruption leaves the last checkpoint intact.
+   std::string tmpfile(m_checkpoint_file + ".tmp");
+   TDirectory * current(gDirectory);
+   TFile file(tmpfile.c_str(), "recreate");
+   if (file.IsZombie()) {
+      throw std::runtime_error("IrfAnalysis::saveCheckpoint: could not "
+                               "create " + tmpfile);
+   }
+   m_psf->writeHists();
+   m_disp->writeHists();
+   m_fisheye->writeHists();
+   m_aeff->writeHists();
+   m_phi_dep->writeHists();
+   state.write();
+   file.Close();
+   current->cd();
+   if (std::rename(tmpfile.c_str(), m_checkpoint_file.c_str()) != 0) {
+      throw std::runtime_error("IrfAnalysis::saveCheckpoint: could not "
+                               "rename " + tmpfile + " to " 
+                               + m_checkpoint_file);
+   }
+   out() << "Saved the projection through entry " << state.next_entry
+         << " to " << m_checkpoint_file << std::endl;
+}
+
+void IrfAnalysis::mergeCheckpoints(const std::vector<std::string> & infiles,
+                                   const std::string & outfile) {
+   if (infiles.empty()) {
+      throw std::invalid_argument("IrfAnalysis::mergeCheckpoints: "
+                                  "no files to merge");
+   }
+   TDirectory * current(gDirectory);
+   Projection total;
+   total.complete = true;
+   std::vector<bool> shards;
+   std::vector<TH1 *> hists;
+   std::map<std::string, size_t> hist_index;
+   for (size_t i(0); i < infiles.size(); i++) {
+      TFile file(infiles[i].c_str());
+      if (file.IsZombie()) {
+         throw std::runtime_error("IrfAnalysis::mergeCheckpoints: could not "
+                                  "open " + infiles[i]);
+      }
+      Projection state;
+      state.read(file);
+      if (!state.complete) {
+         throw std::runtime_error("IrfAnalysis::mergeCheckpoints: the "
+                                  "projection in " + infiles[i] 
+                                  + " is not complete");
+      }
+      if (i == 0) {
+         total.fingerprint = state.fingerprint;
+         shards.resize(state.shard_count, false);
+      }
+      if (state.fingerprint != total.fingerprint 
+          || state.shard_count != int(shards.size())) {
+         throw std::runtime_error("IrfAnalysis::mergeCheckpoints: "
+                                  + infiles[i] + " and " + infiles[0]
+                                  + " are not shards of the same run");
+      }
+      if (shards[state.shard_index]) {
+         std::ostringstream message;
+         message << "IrfAnalysis::mergeCheckpoints: shard " 
+                 << state.shard_index << " in " << infiles[i] 
+                 << " was already merged";
+         throw std::runtime_error(message.str());
+      }
+      shards[state.shard_index] = true;
+      total.add(state);
+      size_t nhists(0);
+      TIter next(file.GetListOfKeys());
+      TKey * key;
+      while ((key = dynamic_cast<TKey *>(next())) != 0) {
+         TObject * object(key->ReadObj());
+         TH1 * hist(dynamic_cast<TH1 *>(object));
+         if (hist == 0) {
+            delete object;
+            continue;
+         }
+         nhists++;
+         if (i == 0) {
+            hist->SetDirectory(0);
+            hist_index[hist->GetName()] = hists.size();
+            hists.push_back(hist);
+            continue;
+         }
+         std::map<std::string, size_t>::const_iterator 
+            it(hist_index.find(hist->GetName()));
+         if (it == hist_index.end()) {
+            throw std::runtime_error("IrfAnalysis::mergeCheckpoints: "
+                                     + std::string(hist->GetName()) 
+                                     + " in " + infiles[i] 
+                                     + " is not in " + infiles[0]);
+         }
+         hists[it->second]->Add(hist);
+         delete hist;
+      }
+      if (nhists != hists.size()) {
+         throw std::runtime_error("IrfAnalysis::mergeCheckpoints: "
+                                  + infiles[i] + " and " + infiles[0]
+                                  + " have different histograms");
+      }
+      file.Close();
+   }
+   if (std::find(shards.begin(), shards.end(), false) != shards.end()) {
+      std::ostringstream message;
+      message << "IrfAnalysis::mergeCheckpoints: " << infiles.size() 
+              << " of the " << shards.size() << " shards were given";
+      throw std::runtime_error(message.str());
+   }
+   // The merged projection is resumed by a run without shards.
+   total.shard_index = 0;
+   total.shard_count = 1;
+   if (total.selected_events == 0) {
+      throw std::runtime_error("IrfAnalysis::mergeCheckpoints: none of "
+                               "the shards selected any events");
+   }
+
+   std::string tmpfile(outfile + ".tmp");
+   TFile file(tmpfile.c_str(), "recreate");
+   if (file.IsZombie()) {
+      throw std::runtime_error("IrfAnalysis::mergeCheckpoints: could not "
+                               "create " + tmpfile);
+   }
+   for (size_t j(0); j < hists.size(); j++) {
+      hists[j]->Write();
+      delete hists[j];
+   }
+   total.write();
+   file.Close();
+   current->cd();
+   if (std::rename(tmpfile.c_str(), outfile.c_str()) != 0) {
+      throw std::runtime_error("IrfAnalysis::mergeCheckpoints: could not "
+                               "rename " + tmpfile + " to " + outfile);
+   }
+}
+
+const TH1 & IrfAnalysis::savedHist(TDirectory & dir, const std::string & name) {
+   TH1 * hist(dynamic_cast<TH1 *>(dir.Get(name.c_str())));
+   if (hist == 0) {
+      throw std::runtime_error("IrfAnalysis::savedHist: histogram " + name
+                               + " not found in " + dir.GetName());
+   }
+   return *hist;
+}
 
 void IrfAnalysis::fit(bool make_plots) {
 
    make_plots = make_plots || m_make_plots;
    const std::string& output_type = m_output_type;
+   DefaultMinimizer minimizer(m_threads);
    m_psf->fit(); 
    m_fisheye->fit(); 
    m_disp->fit();
@@ -245,6 +859,24 @@ void IrfAnalysis::fit(bool make_plots) {
    if (!m_parameterFile.empty()) {
       writeFitParameters(m_output_dir + "/" + m_parameterFile);
    }
+   if (!m_irf_version.empty()) {
+      writeFitsFiles();
+   }
+}
+
+void IrfAnalysis::writeFitsFiles() {
+   handoff_response::IrfTableMap tables;
+   m_psf->fillParameterTables(&tables);
+   m_fisheye->fillParameterTables(&tables);
+   m_disp->fillParameterTables(&tables);
+   m_aeff->fillParameterTables(&tables);
+   m_phi_dep->fillParameterTables(&tables);
+
+   out() << "Writing FITS files for " << m_classname << " to "
+         << m_output_dir << std::endl;
+   handoff_response::createFitsFiles(tables, m_classname, m_irf_version,
+                                     m_new_edisp, m_output_dir);
+   current_time(out());
 }
 
 void IrfAnalysis::writeFitParameters(std::string outputFile) { 
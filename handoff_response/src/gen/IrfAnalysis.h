@@ -13,6 +13,9 @@ class FisheyePlots;
 class DispPlots;
 class EffectiveArea;
 class AeffPhiDep;
+class MeritReader;
+class TDirectory;
+class TH1;
 
 namespace embed_python {
    class Module;
@@ -43,8 +46,40 @@ public:
    /// do both psf and dispersion 
    void writeFitParameters(std::string outputFile);
 
+   /// @brief write the CALDB FITS files for the event class, in the
+   /// output folder, directly from the fit parameter tables, without
+   /// a parameters file (irfVersion).
+   void writeFitsFiles();
+
    const IrfBinner & binner()const{return m_binner;}
 
+   /// Number of threads for the event projection and the fits.
+   int threads() const {
+      return m_threads;
+   }
+
+   /// True if the fits are left for a later run, which resumes from
+   /// the completed checkpoint (Data.project_only).
+   bool project_only() const {
+      return m_project_only;
+   }
+
+   /// True if only the parameter tables are made, without the plots
+   /// or the summary file of histograms (tablesOnly).
+   bool tables_only() const {
+      return m_tables_only;
+   }
+
+   /// @return The histogram of the given name saved in a checkpoint
+   /// file.
+   static const TH1 & savedHist(TDirectory & dir, const std::string & name);
+
+   /// Sum the histograms and counts of completed checkpoint files,
+   /// such as those of the shards of a projection, into a completed
+   /// checkpoint file, from which the fits can be made.
+   static void mergeCheckpoints(const std::vector<std::string> & infiles,
+                                const std::string & outfile);
+
     /** 
      * @class IrfAnalysis::Normalization
      * @brief information allowing normalization for effective area
@@ -93,6 +128,62 @@ protected:
 
    void project(embed_python::Module & );
 
+   /**
+    * @class IrfAnalysis::Projection
+    * @brief The counts and ranges accumulated over the projected
+    * events, saved with the histograms in a checkpoint.
+    */
+   class Projection {
+   public:
+      Projection();
+      /// Read the values saved by write in a checkpoint file.
+      void read(TDirectory & dir);
+      /// Write the values to the current directory.
+      void write() const;
+      /// Combine with the projection of other events.
+      void add(const Projection & other);
+      /// Entry of the merit reader at which to resume.
+      long long next_entry;
+      long long selected_events;
+      long long nruns;
+      double lastrun;
+      double minEnergy;
+      double maxEnergy;
+      double minzdir;
+      double maxzdir;
+      /// True if all of the events have been projected.
+      bool complete;
+      /// First entry of the shard, so that next_entry - first_entry
+      /// entries have been examined.
+      long long first_entry;
+      /// The inputs, selection and binning of the run; see
+      /// makeFingerprint.
+      std::string fingerprint;
+      int shard_index;
+      int shard_count;
+   };
+
+   /// Fill the histograms with the events from the reader, starting
+   /// at state.next_entry, saving checkpoints along the way.
+   void projectEvents(MeritReader & reader, Projection & state);
+
+   /// Describe the merit and flat files, the prune file and cuts, the merit variables, the
+   /// scaling parameters and the bins, which must be the same to
+   /// resume from a checkpoint.
+   std::string makeFingerprint(embed_python::Module & py) const;
+
+   /// Read the state of the projection from the checkpoint file, and
+   /// check that it was saved by the same run, and the same shard.
+   /// @return false if there is no checkpoint file.
+   bool readCheckpoint(Projection & state) const;
+
+   /// Add the histograms in the checkpoint file to the plots.
+   void addCheckpointHists();
+
+   /// Save the histograms and the state of the projection, replacing
+   /// the checkpoint file.
+   void saveCheckpoint(const Projection & state);
+
 private:
 
    IrfBinner m_binner;
@@ -121,6 +212,51 @@ private:
    // for both front and back events.
    bool m_front_only_psf_scaling;
 
+   /// Number of threads used to project the events onto the
+   /// histograms and to fit them (Data.threads).  The histograms are
+   /// the same for any number of threads.
+   int m_threads;
+
+   /// Flat merit files to read instead of the ROOT files
+   /// (Data.flat_files), and a flat file to which the selected events
+   /// are written (Data.flat_output).  See FlatMeritFile.h.
+   std::vector<std::string> m_flat_files;
+   std::string m_flat_output;
+
+   /// File in which the filled histograms are saved every
+   /// m_checkpoint_interval merit entries, and at the end of the
+   /// projection (Data.checkpoint_file and
+   /// Data.checkpoint_interval).  If the file exists, the projection
+   /// resumes from it, if its fingerprint is m_fingerprint.
+   std::string m_checkpoint_file;
+   int m_checkpoint_interval;
+   std::string m_fingerprint;
+
+   bool m_project_only;
+
+   bool m_tables_only;
+
+   /**
+    * @class IrfAnalysis::AddDirectoryStatus
+    * @brief Save TH1::AddDirectoryStatus, which tablesOnly turns off
+    * for the histograms of the analysis, and restore it when the
+    * analysis is deleted, or if its constructor throws.
+    */
+   class AddDirectoryStatus {
+   public:
+      AddDirectoryStatus();
+      ~AddDirectoryStatus();
+   private:
+      bool m_status;
+   };
+   AddDirectoryStatus m_add_directory;
+
+   /// The VERSION of the FITS files written by writeFitsFiles, which
+   /// are not written if empty, and whether the dispersion uses the
+   /// parameterization of Edisp.Version > 1.
+   std::string m_irf_version;
+   bool m_new_edisp;
+
    std::ostream * m_log;
    /// event class, derived from folder name
    std::string m_classname; 
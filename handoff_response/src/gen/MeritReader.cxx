@@ -0,0 +1,43 @@
+/**
+ * @file MeritReader.cxx
+ * @brief Implementation of MeritBlock.
+ * @author J. Chiang
+ *
+ * $Header$
+ */
+
+#include <sstream>
+#include <stdexcept>
+
+#include "MeritReader.h"
+
+const size_t MeritBlock::ncolumns;
+
+std::vector<double> & MeritBlock::column(size_t i) {
+   switch (i) {
+   case 0:
+      return evtRun;
+   case 1:
+      return mcEnergy;
+   case 2:
+      return mcXDir;
+   case 3:
+      return mcYDir;
+   case 4:
+      return mcZDir;
+   case 5:
+      return bestEnergy;
+   case 6:
+      return bestXDir;
+   case 7:
+      return bestYDir;
+   case 8:
+      return bestZDir;
+   case 9:
+      return tkr1FirstLayer;
+   default:
+      std::ostringstream message;
+      message << "MeritBlock::column: invalid column index " << i;
+      throw std::out_of_range(message.str());
+   }
+}
@@ -0,0 +1,94 @@
+/**
+ * @file MeritReader.h
+ * @brief Abstract interface for reading the merit quantities used by
+ * IrfAnalysis in blocks of contiguous arrays.
+ * @author J. Chiang
+ *
+ * $Header$
+ */
+
+#ifndef handoff_response_MeritReader_h
+#define handoff_response_MeritReader_h
+
+#include <vector>
+
+/**
+ * @class MeritBlock
+ * @brief The merit quantities for a block of selected events, one
+ * array per column.
+ */
+
+class MeritBlock {
+
+public:
+
+   std::vector<double> evtRun;
+   std::vector<double> mcEnergy;
+   std::vector<double> mcXDir;
+   std::vector<double> mcYDir;
+   std::vector<double> mcZDir;
+   std::vector<double> bestEnergy;
+   std::vector<double> bestXDir;
+   std::vector<double> bestYDir;
+   std::vector<double> bestZDir;
+   std::vector<double> tkr1FirstLayer;
+
+   /// Number of columns, in the order of the column() index.
+   static const size_t ncolumns = 10;
+
+   std::vector<double> & column(size_t i);
+
+   const std::vector<double> & column(size_t i) const {
+      return const_cast<MeritBlock *>(this)->column(i);
+   }
+
+   size_t size() const {
+      return mcEnergy.size();
+   }
+
+   void resize(size_t nevents) {
+      for (size_t i(0); i < ncolumns; i++) {
+         column(i).resize(nevents);
+      }
+   }
+
+   bool front(size_t k) const {
+      return tkr1FirstLayer[k] > 5;
+   }
+
+};
+
+/**
+ * @class MeritReader
+ * @brief Read the selected events a block at a time.
+ */
+
+class MeritReader {
+
+public:
+
+   virtual ~MeritReader() {}
+
+   /// Replace the contents of block with up to nmax of the next
+   /// selected events.
+   /// @return false if no events remain.
+   virtual bool read(size_t nmax, MeritBlock & block) = 0;
+
+   /// @return The number of entries examined so far, before any
+   /// cuts.
+   virtual long long entries() const = 0;
+
+   /// Skip ahead to the given entry, as counted by entries(), to
+   /// resume an interrupted projection or to start a shard.
+   virtual void seek(long long entry) = 0;
+
+   /// @return The total number of entries, before any cuts.
+   virtual long long size() const = 0;
+
+   /// Stop reading at the given entry, for a shard that ends before
+   /// the last entry.
+   virtual void setEnd(long long entry) = 0;
+
+};
+
+#endif // handoff_response_MeritReader_h
@@ -8,7 +8,7 @@
 #include "TFile.h"
 #include "TCanvas.h"
 #include "TPaveLabel.h"
-#include "TEventList.h"
+#include "TTreeFormula.h"
 #include "v5/TFormula.h"
 #include <cmath>
 #include <sstream>
@@ -19,13 +19,27 @@
 
 MyAnalysis::MyAnalysis(embed_python::Module& py)
   : m_tree_name("MeritTuple"), 
-    m_tree(), m_input_tree(), m_out(0), m_list() {
+    m_tree(), m_input_tree(), m_out(0), m_selection(0),
+    m_shard_index(0), m_shard_count(1) {
    // get file information from input description 
    // first, file list
    
    ROOT::v5::TFormula::SetMaxima(2000,2000,2000);
 
    py.getList("Data.files", m_files);
+   try {
+      py.getValue("Data.shard_index", m_shard_index);
+      py.getValue("Data.shard_count", m_shard_count);
+   } catch (std::invalid_argument &) {
+      // Read all of the files.
+   }
+   if (m_shard_count < 1 || m_shard_index < 0 
+       || m_shard_index >= m_shard_count) {
+      std::ostringstream message;
+      message << "MyAnalysis: invalid shard " << m_shard_index 
+              << " of " << m_shard_count;
+      throw std::runtime_error(message.str());
+   }
    std::cout << "Reading from " << m_files.size() 
              << " filelists" << std::endl;
    try {
@@ -45,12 +59,18 @@ MyAnalysis::MyAnalysis(embed_python::Module& py)
    py.getValue("Prune.cuts", m_cuts);
    py.getValue("Prune.fileName", m_skim_filename);
    py.getList("Prune.branchNames", m_branchNames);
+   if (m_shard_count > 1 && !m_skim_filename.empty()) {
+      throw std::runtime_error("MyAnalysis: the shards cannot all write "
+                               "the Prune.fileName skim file; set it to ''"
+                               " to shard the projection.");
+   }
 
    current_time();
 }
 
 MyAnalysis::~MyAnalysis() {
    current_time();
+   delete m_selection;
    delete m_out;
 }
 
@@ -132,8 +152,8 @@ void MyAnalysis::makeCutTree() {
        }
     }
 
-    std::cout << "Copying cut tree, using cuts "<< m_cuts << std::endl;
     if (!m_skim_filename.empty()) {
+        std::cout << "Copying cut tree, using cuts "<< m_cuts << std::endl;
         m_out = new TFile(m_skim_filename.c_str(), "recreate");
     }
 
@@ -148,13 +168,42 @@ void MyAnalysis::makeCutTree() {
       m_tree->Write(); // save it
       std::cout << "Wrote " << m_tree->GetEntries() << " events to file " << m_skim_filename << std::endl;
     } else {
+      // Evaluate the cuts in the event loop, rather than making a
+      // separate pass over the chain to find the selected entries.
+      std::cout << "Applying cuts " << m_cuts << std::endl;
       m_tree = m_input_tree;
-      m_tree->Draw(">>list",m_cuts.c_str(),"goff");
-      m_list = (TEventList*)gDirectory->Get("list");
-      m_tree->SetEventList(m_list);
+      if (!m_cuts.empty()) {
+         m_selection = new TTreeFormula("selection", m_cuts.c_str(), m_tree);
+         if (m_selection->GetNdim() == 0) {
+            std::ostringstream message;
+            message << "MyAnalysis::makeCutTree: invalid cuts " << m_cuts;
+            throw std::runtime_error(message.str());
+         }
+         // Update the formula leaves when the chain opens a new file.
+         m_input_tree->SetNotify(m_selection);
+      }
     }
 }
 
+void MyAnalysis::shardRange(long long nentries, long long & first,
+                            long long & end) const {
+   first = nentries*m_shard_index/m_shard_count;
+   end = nentries*(m_shard_index + 1)/m_shard_count;
+}
+
+bool MyAnalysis::selected(long long entry) {
+   if (m_selection == 0) {
+      return true;
+   }
+   return TreeWrapper::passes(*m_selection, entry);
+}
+
+void MyAnalysis::enableSelectionBranches() {
+   if (m_selection != 0) {
+      TreeWrapper::enableBranches(*m_selection);
+   }
+}
+
 #include <time.h>
 
 void MyAnalysis::current_time(std::ostream& out)
@@ -15,8 +15,8 @@ $Header$
 class TChain;
 class TFile;
 class TTree;
-class TEventList;
 class TCanvas;
+class TTreeFormula;
 
 namespace embed_python { class Module;}
 
@@ -35,11 +35,20 @@ public:
     void open_input_file();
 
     TTree& tree(){return *m_tree;}
-    TEventList* list(){return m_list;}
 
-    /// @brief apply cuts and select the branch names.
+    /// @brief apply cuts and select the branch names.  If no skim
+    /// file is specified, the cuts are not applied here, but are
+    /// evaluated for each entry by selected().
     void makeCutTree();
 
+    /// @return true if the entry passes the cuts.  Only the branches
+    /// used by the cuts are read.
+    bool selected(long long entry);
+
+    /// @brief enable the branches needed to evaluate the cuts, after
+    /// branches have been disabled.
+    void enableSelectionBranches();
+
     void current_time(std::ostream& out=std::cout);
 
     /// divide a canvas
@@ -47,6 +56,21 @@ public:
 
     const std::string& skim_filename() const {return m_skim_filename;}
 
+    const std::string& cuts() const {return m_cuts;}
+
+    /// The input entries are divided among Data.shard_count shards
+    /// of consecutive entries, and only those of shard
+    /// Data.shard_index are read.
+    int shard_index() const {return m_shard_index;}
+    int shard_count() const {return m_shard_count;}
+
+    /// @brief the entries of this shard, out of nentries, so that the
+    /// shards cover all of the entries in nearly equal parts.
+    /// @param first the first entry of the shard
+    /// @param end the entry after the last entry of the shard
+    void shardRange(long long nentries, long long & first, 
+                    long long & end) const;
+
 
 private:
 
@@ -60,7 +84,9 @@ private:
     TTree* m_tree;
     TChain* m_input_tree;
     TFile* m_out;
-    TEventList* m_list;
+
+    //! the cuts, evaluated entry by entry; zero if there are none
+    TTreeFormula* m_selection;
 
     std::vector<std::string> m_files; ///< input file description (for TChain)
     std::vector<std::string> m_branchNames; ///< branches to keep in prune
@@ -69,6 +95,9 @@ private:
    /// the python setup file. Default is "MeritTuple".
    std::string m_tree_name;
 
+   int m_shard_index;
+   int m_shard_count;
+
    /// Allow for friend trees on a per file basis.
    std::map<std::string, std::vector<std::string> > m_friend_tree_files;
 };
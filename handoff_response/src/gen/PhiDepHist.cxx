@@ -52,6 +52,15 @@ void PhiDepHist::fill(double tangent) {
    m_count++;
 }
 
+void PhiDepHist::add(const TH1 & saved) {
+   if (m_fitted) {
+      throw std::runtime_error("Cannot call PhiDepHist::add after "
+                               "having called PhiDepHist::fit.");
+   }
+   m_hist->Add(&saved);
+   m_count += static_cast<int>(saved.GetEntries());
+}
+
 void PhiDepHist::fit() {
 // Blech.  This function alters the contents of the underlying
 // histogram such that the fill member function cannot be called any
@@ -13,6 +13,7 @@
 #include <vector>
 
 class TF1;
+class TH1;
 class TH1F;
 
 class PhiDepHist {
@@ -27,6 +28,16 @@ public:
    ~PhiDepHist();
 
    void fill(double tangent);
+
+   /// Add the contents and entries of this histogram saved in a
+   /// checkpoint file.
+   void add(const TH1 & saved);
+
+   /// The histogram, to be saved in a checkpoint file; zero for
+   /// the default constructed objects.
+   const TH1F * histogram() const {
+      return m_hist;
+   }
    
    void fit();
 
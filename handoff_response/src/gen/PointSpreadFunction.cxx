@@ -65,40 +65,6 @@ namespace {
        return (ncore*psf_base(ucore, score, gcore) +
                ntail*ncore*psf_base(utail, stail, gtail));
     }
-
-    double psf_integral(double * logx, double * p)
-    {
-       double gcore(p[0]);
-       double gtail(p[1]);
-       double ncore(p[2]);
-       double ntail(p[3]);
-       double score(p[4]);
-       double stail(p[5]);
-
-       double x = pow(10., (*logx));
-       double rcore = x/score;
-       double rtail = x/stail;
-       double ucore = rcore*rcore/2.;
-       double utail = rtail*rtail/2.;
-
-       return (ncore*psf_base_integral(ucore, score, gcore) + 
-               ntail*ncore*psf_base_integral(utail, stail, gtail));
-    }
-
-    TH1F* cumulative_hist(TH1F& h)
-    {
-        // make a cumulative histogram 
-        float y=h.GetBinContent(0);
-        TH1F* hcum = (TH1F*)h.Clone(); hcum->Clear();
-        for(int i=1; i< h.GetNbinsX(); ++i){
-            float x = h.GetBinCenter(i), 
-                dy=h.GetBinContent(i);
-            hcum->Fill(x,y+dy/2.);
-            y = y+dy;
-        }
-        hcum->Scale(1/y);
-        return hcum;
-    }
 }// anon namespace
 
 
@@ -195,10 +161,28 @@ PointSpreadFunction::~PointSpreadFunction()
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 void PointSpreadFunction::fill(double scaled_delta, double weight)
 {
-    hist().Fill( log10(scaled_delta), weight );
+    fill(hist(), scaled_delta, weight);
     m_count++;
 }
 
+TH1F * PointSpreadFunction::newBase(const std::string & name)
+{
+    TH1F * base = new TH1F(name.c_str(), name.c_str(), nbins, xmin, xmax);
+    base->SetDirectory(0);
+    return base;
+}
+
+void PointSpreadFunction::fill(TH1F & base, double scaled_delta, double weight)
+{
+    base.Fill( log10(scaled_delta), weight );
+}
+
+void PointSpreadFunction::add(const TH1 & base)
+{
+    hist().Add(&base);
+    m_count += static_cast<int>(base.GetEntries());
+}
+
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 void PointSpreadFunction::summary_title(std::ostream & out)
 {
@@ -254,6 +238,29 @@ scaleFactor(double energy, double zdir, std::vector<double> scaling_pars) {
    return std::sqrt(::sqr(scaling_pars[0]*t) + ::sqr(scaling_pars[1])); 
 }
 
+void PointSpreadFunction::
+scaleFactors(const std::vector<double> & energies,
+             const std::vector<double> & scaling_pars,
+             std::vector<double> & factors) {
+   int npts(energies.size());
+   factors.resize(npts);
+   if (npts == 0) {
+      return;
+   }
+   const double * energy(&energies[0]);
+   double * factor(&factors[0]);
+   double norm(scaling_pars[0]);
+   double floor2(::sqr(scaling_pars[1]));
+   double index(scaling_pars[2]);
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+   for (int i = 0; i < npts; i++) {
+      double t(std::pow(energy[i]/100., index));
+      factor[i] = std::sqrt(::sqr(norm*t) + floor2);
+   }
+}
+
 void PointSpreadFunction::
 setScaleFactorParameters(const std::vector<double> & pars) {
    if (pars.size() != 3) {
@@ -275,12 +282,9 @@ getScaleFactorParameters(std::vector<double> & pars) {
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-void PointSpreadFunction::fit(std::string opts)
+void PointSpreadFunction::fit(std::ostream & log, std::string opts)
 {
-    // create the cumulative histgram before changing this one
-    m_cumhist = cumulative_hist(hist());
-
-    std::cout << "\rProcessing " << hist().GetTitle()<<std::endl;
+    log << "\rProcessing " << hist().GetTitle()<<std::endl;
     TH1F & h = hist(); 
 
     // now add overflow to last bin
@@ -357,14 +361,6 @@ void PointSpreadFunction::draw(double ymin, double ymax, bool ylog)
         s->SetY1NDC(0.6);
     }
     h.Draw();
-#if 0
-    // overlay the cumulative histogram
-    m_cumhist->Draw("same");
-
-    // finally overlay with psf integral
-    TF1 psf_int("psf_integral", psf_integral, -1, 1, 3);
-    psf_int.SetParameters(m_pars);
-#endif
     h.Write();
 }
 
@@ -14,6 +14,7 @@ $Header$
 #include <string>
 #include <iostream>
 #include <vector>
+class TH1;
 class TH1F;
 
 class PointSpreadFunction {
@@ -30,6 +31,20 @@ public:
     /// add a point with a scaled angular difference delta
     void fill(double scaled_delta, double weight=1.0);
 
+    /// make an empty histogram with the binning of this one, not
+    /// attached to any directory, to accumulate events for add()
+    static TH1F * newBase(const std::string & name);
+
+    /// add a point to a histogram made by newBase
+    static void fill(TH1F & base, double scaled_delta, double weight=1.0);
+
+    /// add the contents and entries of a histogram made by newBase,
+    /// or of this histogram saved in a checkpoint file
+    void add(const TH1 & base);
+
+    /// the managed histogram, to be saved in a checkpoint file
+    const TH1F * histogram() const {return m_hist;}
+
     /// add a summary line to a table, with 68%, 95%, and fit parameters.
     void summarize(std::ostream & out);
 
@@ -37,7 +52,8 @@ public:
     void draw(double ymin=1e-6, double ymax=1.0, bool ylog=true);
 
     /// make a fit, using standard PSF function
-    void fit(std::string opts = "RQ");
+    /// @param log Stream for the progress message
+    void fit(std::ostream & log = std::cout, std::string opts = "RQ");
 
     /// get vector of fit parameters (all zero if not fit)
     void getFitPars(std::vector<double> & pars)const;
@@ -47,6 +63,12 @@ public:
     /// scale factor to apply to data
    static double scaleFactor(double energy, double zdir, std::vector<double> scaling_pars);
 
+   /// scale factors for an array of energies, computed in a single
+   /// vectorizable loop
+   static void scaleFactors(const std::vector<double> & energies,
+                            const std::vector<double> & scaling_pars,
+                            std::vector<double> & factors);
+
    /// Set the scaleFactor scaling parameters.
    void setScaleFactorParameters(const std::vector<double> & pars);
 
@@ -71,7 +93,6 @@ private:
 
     TH1F& hist(){return *m_hist;}
     TH1F* m_hist;  ///< managed histogram
-    TH1F* m_cumhist; ///< a cumulative histogram, generated before fit
     TF1 m_fitfunc; ///< the fit function
 
     std::map<std::string,std::vector<double> > m_parmap;
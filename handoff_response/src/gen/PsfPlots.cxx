@@ -14,6 +14,7 @@ $Header$
 #include "TTree.h"
 #include "TCanvas.h"
 #include "IrfAnalysis.h"
+#include "../fits/IrfTableMap.h"
 
 #include <cmath>
 #include <iomanip>
@@ -66,39 +67,107 @@ PsfPlots::PsfPlots( IrfAnalysis& irf, std::ostream& log,
             m_hists[id].setScaleFactorParameters(m_scaling_pars);
         }
     }
+    // With over-lapping bins, each event is filled once, into its
+    // own bin, and the neighbours are summed by sumOverlaps.
+    if (binner().psfEnergyOverLap() > 0 || binner().psfAngleOverLap() > 0) {
+        m_base.resize(binner().size(), 0);
+        for (int ebin = 0; ebin < binner().energy_bins(); ++ebin) {
+            for (int abin = 0; abin < binner().angle_bins(); ++abin) {
+                m_base[binner().ident(ebin, abin)] =
+                    PointSpreadFunction::newBase(IrfBinner::hist_name(abin, ebin, "psf_base"));
+            }
+        }
+    }
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 PsfPlots::~PsfPlots()
-{}
+{
+    for (size_t i = 0; i < m_base.size(); i++) {
+        delete m_base[i];
+    }
+}
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 void PsfPlots::fill(double angle_diff, double energy, double costheta)
+{
+    fillScaled(angle_diff/PointSpreadFunction::scaleFactor(energy, costheta, m_scaling_pars),
+               energy, costheta);
+}
+
+void PsfPlots::fill(const std::vector<double> & diffs,
+                    const std::vector<double> & energies,
+                    const std::vector<double> & costhetas)
+{
+    std::vector<double> scales;
+    PointSpreadFunction::scaleFactors(energies, m_scaling_pars, scales);
+    for (size_t k = 0; k < diffs.size(); ++k) {
+        fillScaled(diffs[k]/scales[k], energies[k], costhetas[k]);
+    }
+}
+
+void PsfPlots::fillScaled(double scaled_delta, double energy, double costheta)
 {
     int z_bin = binner().angle_bin( costheta );     if( z_bin>= binner().angle_bins()) return;
     int e_bin = binner().energy_bin(energy);        if( e_bin<0 || e_bin>= binner().energy_bins() )return;
 
-//     int id =  binner().ident(e_bin, z_bin);
-     double scaled_delta =angle_diff/PointSpreadFunction::scaleFactor(energy, costheta, m_scaling_pars);
+    int indx(binner().hist_id(e_bin, z_bin));
+    if (indx >= 0) {
+        if (m_base.empty()) {
+            m_hists[indx].fill(scaled_delta);
+        } else {
+            PointSpreadFunction::fill(*m_base[indx], scaled_delta);
+        }
+    }
+
+    // set special combined hist, accumulate all but last bins of angles
+    if( z_bin< binner().angle_bins()-2) {
+        m_hists[binner().ident(e_bin, binner().angle_bins())].fill(scaled_delta);
+    }
 
-//     m_hists[id].fill(scaled_delta);
+}
 
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void PsfPlots::sumOverlaps()
+{
+    if (m_base.empty()) {
+        return;
+    }
 // use over-lapping bins if da, de are non-zero:
     int da(binner().psfEnergyOverLap());
     int de(binner().psfAngleOverLap());
-    for (int eoffset(-de); eoffset < de + 1; eoffset++) {
-      for (int aoffset(-da); aoffset < da + 1; aoffset++) {
-         int indx(binner().hist_id(e_bin + eoffset, z_bin + aoffset));
-         if (indx >= 0) {
-            m_hists[indx].fill(scaled_delta);
-         }
-      }
-   }
+    for (int e_bin = 0; e_bin < binner().energy_bins(); ++e_bin) {
+        for (int z_bin = 0; z_bin < binner().angle_bins(); ++z_bin) {
+            const TH1F & base(*m_base[binner().ident(e_bin, z_bin)]);
+            for (int eoffset(-de); eoffset < de + 1; eoffset++) {
+                for (int aoffset(-da); aoffset < da + 1; aoffset++) {
+                    int indx(binner().hist_id(e_bin + eoffset, z_bin + aoffset));
+                    if (indx >= 0) {
+                        m_hists[indx].add(base);
+                    }
+                }
+            }
+        }
+    }
+    for (size_t i = 0; i < m_base.size(); i++) {
+        if (m_base[i] != 0) {
+            m_base[i]->Reset();
+        }
+    }
+}
 
-    // set special combined hist, accumulate all but last bins of angles
-    if( z_bin< binner().angle_bins()-2) {
-        m_hists[binner().ident(e_bin, binner().angle_bins())].fill(scaled_delta);
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void PsfPlots::writeHists() const
+{
+    for (PSFlist::const_iterator it = m_hists.begin(); it != m_hists.end(); ++it) {
+        it->histogram()->Write();
     }
+}
 
+void PsfPlots::addHists(TDirectory & dir)
+{
+    for (PSFlist::iterator it = m_hists.begin(); it != m_hists.end(); ++it) {
+        it->add(IrfAnalysis::savedHist(dir, it->histogram()->GetName()));
+    }
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -114,9 +183,21 @@ void PsfPlots::summarize()
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 void PsfPlots::fit()
 {
-
-    for( PSFlist::iterator it = m_hists.begin(); it!=m_hists.end(); ++it){
-        (*it).fit();
+    // The bins are fit independently, so share them among the
+    // threads, with the slower fits balanced dynamically.  The
+    // progress messages are printed in bin order afterwards.
+    int nhists(m_hists.size());
+    std::vector<std::string> messages(nhists);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) num_threads(m_irf.threads())
+#endif
+    for (int i = 0; i < nhists; i++) {
+        std::ostringstream message;
+        m_hists[i].fit(message);
+        messages[i] = message.str();
+    }
+    for (int i = 0; i < nhists; i++) {
+        std::cout << messages[i];
     }
 }
 
@@ -156,7 +237,7 @@ void PsfPlots::draw(const std::string &ps_filename ) {
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-void PsfPlots::fillParameterTables()
+void PsfPlots::fillParameterTables(handoff_response::IrfTableMap * tables)
 {
     // make a set of 2-d histograms with values of the fit parameters
     // binning according to energy and costheta bins 
@@ -183,7 +264,12 @@ void PsfPlots::fillParameterTables()
         }
         h2->GetXaxis()->CenterTitle();
         h2->GetYaxis()->CenterTitle();
-        h2->Write();
+        if (tables) {
+            tables->add(name, handoff_response::IrfTable(h2));
+            delete h2;
+        } else {
+            h2->Write();
+        }
 
     }
 
@@ -197,7 +283,12 @@ void PsfPlots::fillParameterTables()
        h1->SetBinContent(i, m_scaling_pars[i]);
     }
     h1->GetXaxis()->CenterTitle();
-    h1->Write();
+    if (tables) {
+        tables->add(histname, handoff_response::IrfTable(h1));
+        delete h1;
+    } else {
+        h1->Write();
+    }
 }
 
 
@@ -9,6 +9,10 @@
 
 class IrfAnalysis;
 class IrfBinner;
+class TDirectory;
+namespace handoff_response {
+   class IrfTableMap;
+}
 
 #include "PointSpreadFunction.h"
 #include "embed_python/Module.h"
@@ -26,6 +30,28 @@ public:
 
     void fill(double diff, double energy, double costheta);
 
+    /// fill with arrays of events, computing the scale factors for
+    /// all of them at once
+    void fill(const std::vector<double> & diffs,
+              const std::vector<double> & energies,
+              const std::vector<double> & costhetas);
+
+    /// With over-lapping bins, add the events accumulated in each
+    /// bin to the histograms of its neighbours, and Reset the
+    /// accumulated events.  Until it is called, the fitted histograms
+    /// hold none of the events filled since the previous call, so it
+    /// must be called after the last fill, before writeHists and
+    /// before fitting.  Repeated calls are safe: IrfAnalysis calls it
+    /// for each checkpoint and at the end of the projection.
+    void sumOverlaps();
+
+    /// write the histograms to the current directory, for a
+    /// checkpoint of the projection
+    void writeHists() const;
+
+    /// add the histograms written by writeHists to dir
+    void addHists(TDirectory & dir);
+
     void fit();
     void summarize();
 
@@ -36,8 +62,9 @@ public:
 
     const PSFlist& hists(){return m_hists;} 
     
-    // make a set of 2-d histograms with values of the fit parameters
-    void fillParameterTables();
+    // make a set of 2-d histograms with values of the fit parameters,
+    // written to the current directory, or added to tables if given
+    void fillParameterTables(handoff_response::IrfTableMap * tables=0);
 
     const IrfBinner & binner()const{return m_binner;}
 
@@ -49,6 +76,11 @@ protected:
     std::ostream& out() {return *m_log;}
 
 private:
+    void fillScaled(double scaled_delta, double energy, double costheta);
+
+    /// Events in each (energy, angle) bin, to be summed into the
+    /// over-lapping bins; empty if the bins do not over-lap.
+    std::vector<TH1F *> m_base;
     std::vector<double> m_scaling_pars;
 };
 
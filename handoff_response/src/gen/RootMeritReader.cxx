@@ -0,0 +1,93 @@
+/**
+ * @file RootMeritReader.cxx
+ * @brief Read blocks of merit quantities from the ROOT TTree or TChain
+ * of an analysis, applying its cuts.
+ * @author J. Chiang
+ *
+ * $Header$
+ */
+
+#include <iostream>
+
+#include "TTree.h"
+
+#include "MyAnalysis.h"
+#include "RootMeritReader.h"
+
+namespace {
+   /// Size in bytes of the TTreeCache.
+   const long long s_cacheSize(200000000);
+}
+
+RootMeritReader::RootMeritReader(MyAnalysis & analysis,
+                                 const std::string & bestXDir,
+                                 const std::string & bestYDir,
+                                 const std::string & bestZDir,
+                                 const std::string & bestEnergy)
+   : m_analysis(analysis), m_entry(0), m_nentries(0), m_size(0),
+     m_evtRun(0), m_mcEnergy(0), m_tkr1FirstLayer(0), 
+     m_mcXDir(0), m_mcYDir(0), m_mcZDir(0), m_bestEnergy(0),
+     m_bestXDir(0), m_bestYDir(0), m_bestZDir(0) {
+   TTree & tree(m_analysis.tree());
+   std::cout << "Selecting columns in tree " << tree.GetName() << std::endl;
+
+   tree.SetBranchAddress("EvtRun", &m_evtRun);
+   tree.SetBranchAddress("McEnergy", &m_mcEnergy);
+   tree.SetBranchAddress("Tkr1FirstLayer", &m_tkr1FirstLayer);
+   tree.SetBranchAddress(bestEnergy.c_str(), &m_bestEnergy);
+   tree.SetBranchAddress("McXDir", &m_mcXDir);
+   tree.SetBranchAddress("McYDir", &m_mcYDir);
+   tree.SetBranchAddress("McZDir", &m_mcZDir);
+   tree.SetBranchAddress(bestXDir.c_str(), &m_bestXDir);
+   tree.SetBranchAddress(bestYDir.c_str(), &m_bestYDir);
+   tree.SetBranchAddress(bestZDir.c_str(), &m_bestZDir);
+
+   // Only read the branches that are used.
+   tree.SetBranchStatus("*", 0);
+   const char * branches[] = {"EvtRun", "McEnergy", "Tkr1FirstLayer",
+                              "McXDir", "McYDir", "McZDir"};
+   for (size_t i(0); i < sizeof(branches)/sizeof(char *); i++) {
+      tree.SetBranchStatus(branches[i], 1);
+   }
+   tree.SetBranchStatus(bestEnergy.c_str(), 1);
+   tree.SetBranchStatus(bestXDir.c_str(), 1);
+   tree.SetBranchStatus(bestYDir.c_str(), 1);
+   tree.SetBranchStatus(bestZDir.c_str(), 1);
+   m_analysis.enableSelectionBranches();
+
+   // The cache learns which branches are read over the first entries,
+   // then prefetches their baskets for the following ones.
+   tree.SetCacheSize(s_cacheSize);
+   tree.SetCacheLearnEntries(100);
+
+   m_size = tree.GetEntries();
+   m_nentries = m_size;
+}
+
+bool RootMeritReader::read(size_t nmax, MeritBlock & block) {
+   TTree & tree(m_analysis.tree());
+   block.resize(nmax);
+   size_t nevents(0);
+   // Only the selected entries are read, one at a time.  The TTreeCache
+   // set up in the constructor reads the baskets of the enabled
+   // branches in bulk.
+   for ( ; m_entry < m_nentries && nevents < nmax; m_entry++) {
+      if (!m_analysis.selected(m_entry)) {
+         continue;
+      }
+      tree.GetEntry(m_entry);
+      block.evtRun[nevents] = m_evtRun;
+      block.mcEnergy[nevents] = m_mcEnergy;
+      block.mcXDir[nevents] = m_mcXDir;
+      block.mcYDir[nevents] = m_mcYDir;
+      block.mcZDir[nevents] = m_mcZDir;
+      block.bestEnergy[nevents] = m_bestEnergy;
+      block.bestXDir[nevents] = m_bestXDir;
+      block.bestYDir[nevents] = m_bestYDir;
+      block.bestZDir[nevents] = m_bestZDir;
+      block.tkr1FirstLayer[nevents] = m_tkr1FirstLayer;
+      nevents++;
+   }
+   block.resize(nevents);
+   return nevents > 0;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file RootMeritReader.h
+ * @brief Read blocks of merit quantities from the ROOT TTree or TChain
+ * of an analysis, applying its cuts.
+ * @author J. Chiang
+ *
+ * $Header$
+ */
+
+#ifndef handoff_response_RootMeritReader_h
+#define handoff_response_RootMeritReader_h
+
+#include <algorithm>
+#include <string>
+
+#include "MeritReader.h"
+
+class MyAnalysis;
+
+/**
+ * @class RootMeritReader
+ * @brief Only the branches that are used are enabled, and they are
+ * read through a TTreeCache, so that the baskets are fetched in large
+ * contiguous reads ahead of the event loop.
+ */
+
+class RootMeritReader : public MeritReader {
+
+public:
+
+   /// @param analysis Provides the tree and the cuts.
+   /// @param bestXDir etc. Names of the reconstructed direction and
+   ///        energy branches.
+   RootMeritReader(MyAnalysis & analysis,
+                   const std::string & bestXDir,
+                   const std::string & bestYDir,
+                   const std::string & bestZDir,
+                   const std::string & bestEnergy);
+
+   virtual bool read(size_t nmax, MeritBlock & block);
+
+   virtual long long entries() const {
+      return m_entry;
+   }
+
+   /// The chain entries are read directly, so the preceding ones
+   /// are not read.
+   virtual void seek(long long entry) {
+      m_entry = entry;
+   }
+
+   virtual long long size() const {
+      return m_size;
+   }
+
+   virtual void setEnd(long long entry) {
+      m_nentries = std::min(entry, m_size);
+   }
+
+private:
+
+   MyAnalysis & m_analysis;
+
+   long long m_entry;
+   long long m_nentries;
+   long long m_size;
+
+   /// Branch buffers.
+   unsigned m_evtRun;
+   float m_mcEnergy;
+   float m_tkr1FirstLayer;
+   double m_mcXDir;
+   double m_mcYDir;
+   double m_mcZDir;
+   double m_bestEnergy;
+   double m_bestXDir;
+   double m_bestYDir;
+   double m_bestZDir;
+
+};
+
+#endif // handoff_response_RootMeritReader_h
@@ -13,6 +13,8 @@
 #include "TKey.h"
 #include "TString.h"
 #include "TLeaf.h"
+#include "TBranch.h"
+#include "TTreeFormula.h"
 #include <stdexcept>
 
 TreeWrapper* TreeWrapper::s_instance=0;
@@ -33,26 +35,32 @@ namespace {
 
 TreeWrapper::TreeWrapper(std::string filename, std::string treename, std::string filter)
 : m_file( new TFile(filename.c_str(),"readonly"))
+, m_filter(0)
 {
     if( ! m_file->IsOpen() ) throw std::invalid_argument("TreeWrapper: could not open "+filename);
     m_tree = findTree(treename);
     if(m_tree==0) throw std::invalid_argument("TreeWrapper: could not find TTree "+treename + " in file "+filename);
 
-    if( ! filter.empty() ){ // apply filter expression by creating new tree
-        int initialsize( static_cast<int>(m_tree->GetEntries()) );
-        TFile * dummy =new TFile("dummy.root", "recreate");// for copy tree.
-        TTree * tnew = m_tree->CopyTree(filter.c_str() );
-        int size ( (int)tnew->GetEntries() );
+    if( ! filter.empty() ){ // apply filter expression as the entries are read
+        m_filter = new TTreeFormula("filter", filter.c_str(), m_tree);
+        if( m_filter->GetNdim() == 0 ) {
+            delete m_filter;
+            delete m_file;
+            throw std::invalid_argument(std::string("TreeWrapper: invalid filter expression \"")+filter+"\"");
+        }
+        // count the selected entries while all the branches are enabled
+        Long64_t initialsize( m_tree->GetEntries() );
+        Long64_t size( m_tree->GetEntries(filter.c_str()) );
         if( size == 0) {
-            delete dummy;
-            throw std::runtime_error(std::string("TreeWapper: Filter expression \"")+filter+"\" yielded no events");
+            delete m_filter;
+            delete m_file;
+            throw std::runtime_error(std::string("TreeWrapper: Filter expression \"")+filter+"\" yielded no events");
         }
-        m_tree = tnew;
         std::cout << "\t " << size << "/" << initialsize << " events" << std::endl;
-        delete dummy; // to silence warnings.
     }
     // turn off all branches: enable them as requested by leaf calls for the event loop
     m_tree->SetBranchStatus("*", 0);
+    if( m_filter != 0 ) enableBranches(*m_filter);
     s_instance = this;
 
 }
@@ -60,6 +68,7 @@ TreeWrapper::TreeWrapper(std::string filename, std::string treename, std::string
 TreeWrapper::TreeWrapper(TTree* tree)
 : m_file(0)
 , m_tree(tree)
+, m_filter(0)
 {
     s_instance = this;
     // if this is really a TChain, we want to be notified if there is a new TTree
@@ -68,6 +77,7 @@ TreeWrapper::TreeWrapper(TTree* tree)
 
 TreeWrapper::~TreeWrapper()
 {
+    delete m_filter;
     delete m_file; // if we own it, delete it
     s_instance=0;
 }
@@ -108,29 +118,63 @@ TreeWrapper::Leaf TreeWrapper::leaf(std::string name)
     return TreeWrapper::Leaf(leaf);
 }
 
-TreeWrapper::Iterator::Iterator(TTree* tree, int rec)
+TreeWrapper::Iterator::Iterator(TTree* tree, int rec, TTreeFormula* filter)
 : m_tree(tree)
+, m_filter(filter)
 , m_rec( rec>=0? rec : tree->GetEntries())
+, m_end( static_cast<size_t>(tree->GetEntries()) )
 {
-    if(rec>=0) m_tree->GetEntry(rec); // prime the pump
+    if(rec>=0) load(); // prime the pump
+}
+
+void TreeWrapper::Iterator::load()
+{
+    if( m_filter != 0 ) {
+        while( m_rec < m_end && !passes(*m_filter, m_rec) ) ++m_rec;
+    }
+    m_tree->GetEntry(m_rec);
 }
 
 TreeWrapper::Iterator TreeWrapper::Iterator::operator++(){ 
-    int read =m_tree->GetEntry(++m_rec);  
+    ++m_rec;
+    load();
     return *this;
 }
 // post-iterator
 TreeWrapper::Iterator TreeWrapper::Iterator::operator++(int){ 
     Iterator temp = *this;
-    m_tree->GetEntry(++m_rec);  
+    ++m_rec;
+    load();
     return temp;
 }
 
 size_t TreeWrapper::size()const{return static_cast<size_t>(m_tree->GetEntries());}
 
-TreeWrapper::Iterator TreeWrapper::begin(int i){return Iterator(m_tree, i);}
+TreeWrapper::Iterator TreeWrapper::begin(int i){return Iterator(m_tree, i, m_filter);}
 TreeWrapper::Iterator TreeWrapper::end(){return Iterator(m_tree, -1);}
 
+void TreeWrapper::enableBranches(TTreeFormula& formula)
+{
+    for( int i = 0; i < formula.GetNcodes(); ++i ) {
+        TLeaf* leaf = formula.GetLeaf(i);
+        if( leaf != 0 ) {
+            formula.GetTree()->SetBranchStatus(leaf->GetBranch()->GetName(), 1);
+        }
+    }
+}
+
+bool TreeWrapper::passes(TTreeFormula& formula, size_t entry)
+{
+    if( formula.GetTree()->LoadTree(entry) < 0 ) return false;
+    // only the branches used by the formula are read here
+    formula.ResetLoading();
+    int ndata = formula.GetNdata();
+    for( int i = 0; i < ndata; ++i ) {
+        if( formula.EvalInstance(i) != 0 ) return true;
+    }
+    return false;
+}
+
 TreeWrapper::Leaf::operator double()const
 {
     return m_leaf->GetValue();
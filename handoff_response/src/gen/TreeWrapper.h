@@ -15,6 +15,7 @@
 class TTree;
 class TFile;
 class TLeaf;
+class TTreeFormula;
 
 /** @class TreeWrapper 
     @brief simple class to open a ROOT file or tree, and support container-like iteration, 
@@ -41,7 +42,10 @@ public:
 
     @param filename name of the root file
     @param treename optional name of a TTree
-    @param filter   expression that will filter the output
+    @param filter   expression that will filter the output.  It is
+                    evaluated as the entries are visited, so the
+                    filtered entries are never copied.
+    @throw std::runtime_error if the filter selects no entries.
     */
     TreeWrapper(std::string filename,  std::string treename="", std::string filter="");
 
@@ -59,17 +63,22 @@ public:
     public:
         ///@param tree tree to control
         ///@param rec starting entry number: if -1, set to end.
-        Iterator(TTree* tree, int rec);
+        ///@param filter if non-zero, entries that fail it are skipped
+        Iterator(TTree* tree, int rec, TTreeFormula* filter=0);
         Iterator operator++(); 
         Iterator operator++(int);
         bool operator!=(const Iterator& other){return m_rec!= other.m_rec;}
         size_t index()const{ return m_rec;} ///< @return entry number
     private:
+        /// load the current entry, after skipping any that fail the filter
+        void load();
         TTree* m_tree;
+        TTreeFormula* m_filter;
         size_t m_rec;
+        size_t m_end;
     };
 
-    size_t size()const; ///< @return number of entries in the tree
+    size_t size()const; ///< @return number of entries in the tree, before any filter
 
     Iterator begin(int i=0); ///< @return a begin iterator, setting the TTree to the first, or indicated entry
     Iterator end();   ///< @return an end iterator, allowing termination of the loop
@@ -90,11 +99,19 @@ public:
     /// Note that this class is not a singleton: this is just the most recent instance
     static TreeWrapper* instance(){return s_instance;}
 
+    ///@brief enable the branches that a formula reads
+    static void enableBranches(TTreeFormula& formula);
+
+    ///@return true if the formula is non-zero for the entry, or, for
+    /// an array-valued formula, for any element
+    static bool passes(TTreeFormula& formula, size_t entry);
+
 private:
     TTree* findTree(std::string treename);
 
     TFile* m_file;  ///< the file: zero if not owned (i.e., opened)
     TTree* m_tree;  ///< the current tree
+    TTreeFormula* m_filter; ///< the filter expression: zero if none
     std::vector<Leaf> m_leaf_list; ///< allow updating leaf pointers
     static TreeWrapper* s_instance; // most recent instance
 };
@@ -18,7 +18,9 @@ int main(int argc, char* argv[]) {
    
    std::string folder(s.root());
    IrfAnalysis irf_analysis(folder, *s.py());
-   irf_analysis.fit();
+   if (!irf_analysis.project_only()) {
+      irf_analysis.fit();
+   }
 
    return ret;
 }
@@ -32,4 +34,22 @@ This application creates the irfs, and expects a single argument, to a folder co
 
 The first is processed by the Setup class to extract values for the log file. 
 
+The event projection can be checkpointed by setting Data.checkpoint_file.
+The filled histograms are saved there every Data.checkpoint_interval
+merit entries and when the projection completes.  A rerun resumes an
+interrupted projection from that file, or skips the projection if it
+completed, so that the fits can be redone with new settings.  With
+Data.project_only set, makeirf stops after the projection.
+
+With tablesOnly = 1 in the setup, only the parameter tables are made:
+there are no plots, the summary ROOT file of histograms is not
+written, and the histograms are kept out of the ROOT directories while
+the IrfAnalysis exists.  The tables are written to parameterFile, for
+make_fits.
+
+With irfVersion set, e.g., irfVersion = 'P8R2', makeirf also writes the
+CALDB FITS files for the event class to the output folder, as make_fits
+would, directly from the fit parameter tables.  With tablesOnly, the
+parameterFile can then be omitted.
+
 */
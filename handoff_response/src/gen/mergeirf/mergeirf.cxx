@@ -0,0 +1,61 @@
+/** @file mergeirf.cxx
+@brief sum the projections of the shards of an IRF analysis
+
+$Header$
+*/
+
+#include "../IrfAnalysis.h"
+
+#include <string>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+//_____________________________________________________________________________
+
+int main(int argc, char* argv[]){
+    int ret=0;
+    try {
+        if (argc < 3) {
+            std::cerr << "usage: " << argv[0] 
+                      << " <output file> <shard file> [<shard file> ...]"
+                      << std::endl;
+            return 1;
+        }
+        std::string outfile(argv[1]);
+        std::vector<std::string> infiles(argv + 2, argv + argc);
+
+        IrfAnalysis::mergeCheckpoints(infiles, outfile);
+
+        std::cout << "Merged " << infiles.size() << " shard(s) into "
+                  << outfile << std::endl;
+    }catch( const std::exception& e){
+        std::cerr << "Caught exception "<< e.what() << std::endl;
+        ret=1;
+    }
+    return ret;
+}
+
+/** @page mergeirf The mergeirf application
+
+Sum the histograms of the shards of a projection into a single
+checkpoint file:
+
+    mergeirf merged.root shard0.root shard1.root ...
+
+Each shard is a makeirf run with Data.shard_index and Data.shard_count
+set in the setup.  The entries of Data.files (or of Data.flat_files)
+are divided into shard_count ranges of consecutive entries, and the
+shard reads range shard_index, so that the shards are of nearly equal
+size however the entries are divided among the files.  Prune.fileName
+must be empty, since the shards cannot share a skim file.  Each shard
+saves its completed projection to Data.checkpoint_file, by default
+<selectionName>_shard<shard_index>.root in the analysis folder, and
+stops before the fits.  The shards may run as separate processes on
+one or several nodes, and only share the files.
+
+The fits are then made by running makeirf with Data.checkpoint_file set
+to the merged file, and without the shard settings.  Since the merged
+projection is complete, no events are read.
+
+*/
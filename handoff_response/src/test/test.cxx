@@ -11,20 +11,47 @@
 #endif
 
 #include <cmath>
+#include <cstdio>
 #include <cstdlib>
 
+#include <algorithm>
+#include <fstream>
+#include <iterator>
 #include <iostream>
+#include <sstream>
 #include <stdexcept>
+#include <string>
+#include <vector>
 
 #include <cppunit/ui/text/TextTestRunner.h>
 #include <cppunit/extensions/HelperMacros.h>
 
+#include "Math/MinimizerOptions.h"
+#include "TFile.h"
+#include "TH1.h"
+#include "TKey.h"
+#include "TParameter.h"
+#include "TRandom3.h"
+#include "TTree.h"
+
+#include "CLHEP/Geometry/Vector3D.h"
+
 #include "astro/SkyDir.h"
 
+#include "embed_python/Module.h"
+
 #include "irfInterface/IrfsFactory.h"
 
 #include "handoff_response/loadIrfs.h"
 
+#include "gen/Dispersion.h"
+#include "gen/EventErrors.h"
+#include "gen/FlatMeritFile.h"
+#include "gen/IrfAnalysis.h"
+#include "gen/IrfBinner.h"
+#include "gen/PointSpreadFunction.h"
+#include "gen/TreeWrapper.h"
+
 namespace {
    std::string getEnv(const std::string & envVarName) {
       char * envvar(::getenv(envVarName.c_str()));
@@ -34,6 +61,146 @@ namespace {
       }
       return envvar;
    }
+
+   /// Synthetic merit events: log-uniform McEnergy from 10^1.5 to
+   /// 10^5.5 MeV, McZDir uniform from -1 to -0.2, and reconstructed
+   /// directions and energies scattered about the true ones by
+   /// roughly the LAT resolution.
+   void makeEvents(size_t nevents, unsigned int seed, MeritBlock & block) {
+      TRandom3 random(seed);
+      block.resize(nevents);
+      for (size_t k(0); k < nevents; k++) {
+         double energy(std::pow(10., 1.5 + 4.*random.Rndm()));
+         double zdir(-1. + 0.8*random.Rndm());
+         double phi(2.*M_PI*random.Rndm());
+         double sintheta(std::sqrt(1. - zdir*zdir));
+         block.evtRun[k] = 1000 + k/10000;
+         block.mcEnergy[k] = energy;
+         block.mcXDir[k] = sintheta*std::cos(phi);
+         block.mcYDir[k] = sintheta*std::sin(phi);
+         block.mcZDir[k] = zdir;
+         double sigma(0.05*std::pow(energy/100., -0.8) + 0.002);
+         block.bestXDir[k] = block.mcXDir[k] + sigma*random.Gaus();
+         block.bestYDir[k] = block.mcYDir[k] + sigma*random.Gaus();
+         block.bestZDir[k] = block.mcZDir[k] + sigma*random.Gaus();
+         block.bestEnergy[k] = energy*(1. + 0.1*random.Gaus());
+         block.tkr1FirstLayer[k] = random.Integer(18);
+      }
+   }
+
+   /// Write the events to a flat merit file, in chunks of at most
+   /// chunk_size events.
+   void writeFlatFile(const std::string & filename, const MeritBlock & events,
+                      size_t chunk_size) {
+      FlatMeritWriter writer(filename);
+      for (size_t first(0); first < events.size(); first += chunk_size) {
+         size_t nevents(std::min(chunk_size, events.size() - first));
+         MeritBlock chunk;
+         chunk.resize(nevents);
+         for (size_t i(0); i < MeritBlock::ncolumns; i++) {
+            std::copy(events.column(i).begin() + first,
+                      events.column(i).begin() + first + nevents,
+                      chunk.column(i).begin());
+         }
+         writer.write(chunk);
+      }
+   }
+
+   /// Remove the last nbytes bytes of a file.
+   void truncateFile(const std::string & filename, size_t nbytes) {
+      std::string contents;
+      std::ifstream infile(filename.c_str(), std::ios::in | std::ios::binary);
+      contents.assign(std::istreambuf_iterator<char>(infile),
+                      std::istreambuf_iterator<char>());
+      infile.close();
+      CPPUNIT_ASSERT(contents.size() > nbytes);
+      std::ofstream outfile(filename.c_str(), 
+                            std::ios::out | std::ios::binary);
+      outfile.write(contents.data(), contents.size() - nbytes);
+   }
+
+   /// Write the events to the MeritTuple tree of a ROOT file, with
+   /// the branch types of the merit files.
+   void writeRootFile(const std::string & filename,
+                      const MeritBlock & events) {
+      TFile file(filename.c_str(), "recreate");
+      // The file owns the tree and deletes it when it is closed.
+      TTree * tree(new TTree("MeritTuple", "MeritTuple"));
+      UInt_t evtRun;
+      Float_t mcEnergy, tkr1FirstLayer;
+      const char * names[] = {"McXDir", "McYDir", "McZDir", "CTBBestEnergy",
+                              "CTBBestXDir", "CTBBestYDir", "CTBBestZDir"};
+      const std::vector<double> * columns[] = {
+         &events.mcXDir, &events.mcYDir, &events.mcZDir, &events.bestEnergy,
+         &events.bestXDir, &events.bestYDir, &events.bestZDir};
+      const size_t ndoubles(sizeof(names)/sizeof(char *));
+      Double_t values[ndoubles];
+      tree->Branch("EvtRun", &evtRun, "EvtRun/i");
+      tree->Branch("McEnergy", &mcEnergy, "McEnergy/F");
+      tree->Branch("Tkr1FirstLayer", &tkr1FirstLayer, "Tkr1FirstLayer/F");
+      for (size_t i(0); i < ndoubles; i++) {
+         tree->Branch(names[i], &values[i], 
+                      (std::string(names[i]) + "/D").c_str());
+      }
+      for (size_t k(0); k < events.size(); k++) {
+         evtRun = static_cast<UInt_t>(events.evtRun[k]);
+         mcEnergy = events.mcEnergy[k];
+         tkr1FirstLayer = events.tkr1FirstLayer[k];
+         for (size_t i(0); i < ndoubles; i++) {
+            values[i] = (*columns[i])[k];
+         }
+         tree->Fill();
+      }
+      tree->Write();
+      file.Close();
+   }
+
+   /// @return The number of events selected by the projection in a
+   /// checkpoint file.
+   Long64_t selectedEvents(const std::string & checkpoint) {
+      TFile file(checkpoint.c_str());
+      CPPUNIT_ASSERT(!file.IsZombie());
+      TParameter<Long64_t> * selected(dynamic_cast<TParameter<Long64_t> *>
+                                      (file.Get("selected_events")));
+      CPPUNIT_ASSERT(selected != 0);
+      return selected->GetVal();
+   }
+
+   /// Assert that two checkpoint files hold the same histograms and
+   /// the same number of selected events.
+   void compareCheckpoints(const std::string & file1,
+                           const std::string & file2) {
+      TFile checkpoint1(file1.c_str());
+      TFile checkpoint2(file2.c_str());
+      CPPUNIT_ASSERT(!checkpoint1.IsZombie() && !checkpoint2.IsZombie());
+      TParameter<Long64_t> * selected1 
+         = dynamic_cast<TParameter<Long64_t> *>
+         (checkpoint1.Get("selected_events"));
+      TParameter<Long64_t> * selected2 
+         = dynamic_cast<TParameter<Long64_t> *>
+         (checkpoint2.Get("selected_events"));
+      CPPUNIT_ASSERT(selected1 != 0 && selected2 != 0);
+      CPPUNIT_ASSERT(selected1->GetVal() == selected2->GetVal());
+      size_t nhists(0);
+      TIter next(checkpoint1.GetListOfKeys());
+      TKey * key;
+      while ((key = dynamic_cast<TKey *>(next())) != 0) {
+         TH1 * hist1(dynamic_cast<TH1 *>(checkpoint1.Get(key->GetName())));
+         if (hist1 == 0) {
+            continue;
+         }
+         nhists++;
+         TH1 * hist2(dynamic_cast<TH1 *>(checkpoint2.Get(key->GetName())));
+         CPPUNIT_ASSERT(hist2 != 0);
+         CPPUNIT_ASSERT(hist1->GetNcells() == hist2->GetNcells());
+         CPPUNIT_ASSERT(hist1->GetEntries() == hist2->GetEntries());
+         for (int bin(0); bin < hist1->GetNcells(); bin++) {
+            CPPUNIT_ASSERT(hist1->GetBinContent(bin) 
+                           == hist2->GetBinContent(bin));
+         }
+      }
+      CPPUNIT_ASSERT(nhists > 0);
+   }
 }
 
 class HandoffResponseTests : public CppUnit::TestFixture {
@@ -309,6 +476,589 @@ void HandoffResponseTests::edisp_sampling() {
    }
 }
 
+/**
+ * @class IrfGenTests
+ * @brief Tests of the event projection of IrfAnalysis, using
+ * synthetic merit events.  Each run is configured by a python setup
+ * module written to the current directory.
+ */
+
+class IrfGenTests : public CppUnit::TestFixture {
+
+   CPPUNIT_TEST_SUITE(IrfGenTests);
+
+   CPPUNIT_TEST(threaded_projection);
+   CPPUNIT_TEST(root_selection);
+   CPPUNIT_TEST(flat_round_trip);
+   CPPUNIT_TEST(flat_byte_order);
+   CPPUNIT_TEST(flat_truncated_header);
+   CPPUNIT_TEST(vectorized_errors);
+   CPPUNIT_TEST(overlap_sums);
+   CPPUNIT_TEST(resume_projection);
+   CPPUNIT_TEST(sharded_projection);
+   CPPUNIT_TEST(tables_only_directory);
+   CPPUNIT_TEST(threaded_fit);
+
+   CPPUNIT_TEST_SUITE_END();
+
+public:
+
+   void tearDown();
+
+   void threaded_projection();
+   void root_selection();
+   void flat_round_trip();
+   void flat_byte_order();
+   void flat_truncated_header();
+   void vectorized_errors();
+   void overlap_sums();
+   void resume_projection();
+   void sharded_projection();
+   void tables_only_directory();
+   void threaded_fit();
+
+private:
+
+   /// Files written by the test, to be removed.
+   std::vector<std::string> m_files;
+
+   std::string addFile(const std::string & filename) {
+      m_files.push_back(filename);
+      return filename;
+   }
+
+   /// Write the setup module for a run named name, with the settings
+   /// appended to the defaults.
+   /// @return The checkpoint file of the run.
+   std::string writeSetup(const std::string & name,
+                          const std::string & settings);
+
+   /// Write the setup module for a run named name, with the settings
+   /// appended to the defaults, and project the events with it.
+   /// @return The checkpoint file of the run.
+   std::string project(const std::string & name, 
+                       const std::string & settings);
+
+   /// @return The message of the exception thrown by project, or an
+   /// empty string if there was none.
+   std::string projectError(const std::string & name,
+                            const std::string & settings);
+
+};
+
+void IrfGenTests::tearDown() {
+   for (size_t i(0); i < m_files.size(); i++) {
+      std::remove(m_files[i].c_str());
+   }
+   m_files.clear();
+}
+
+std::string IrfGenTests::writeSetup(const std::string & name,
+                                    const std::string & settings) {
+   std::string checkpoint(addFile(name + "_checkpoint.root"));
+   addFile(name + ".root");
+   addFile(name + ".pyc");
+   std::ofstream setup(addFile(name + ".py").c_str());
+   // The setup modules share the classes of IRFdefault, so every
+   // setting that a test changes is reset here.
+   setup << "from IRFdefault import *\n"
+         << "className = 'irfgen'\n"
+         << "selectionName = '" << name << "'\n"
+         << "logFile = ''\n"
+         << "parameterFile = ''\n"
+         << "makePlots = 0\n"
+         << "tablesOnly = 0\n"
+         << "Prune.fileName = ''\n"
+         << "Prune.cuts = ''\n"
+         << "Prune.branchNames = []\n"
+         << "Data.files = []\n"
+         << "Data.generated = [1e6]\n"
+         << "Data.logemin = [1.]\n"
+         << "Data.logemax = [6.]\n"
+         << "Data.threads = 1\n"
+         << "Data.flat_files = []\n"
+         << "Data.flat_output = ''\n"
+         << "Data.checkpoint_file = '" << checkpoint << "'\n"
+         << "Data.checkpoint_interval = 1000000\n"
+         << "Data.project_only = 1\n"
+         << "Data.shard_index = 0\n"
+         << "Data.shard_count = 1\n"
+         << "Bins.psf_energy_overlap = 0\n"
+         << "Bins.psf_angle_overlap = 0\n"
+         << "Bins.edisp_energy_overlap = 0\n"
+         << "Bins.edisp_angle_overlap = 0\n"
+         << "Bins.set_energy_bins(1., 6., 0.5)\n"
+         << "Bins.set_angle_bins(0.2, 0.2)\n"
+         << "FisheyeBins.set_energy_bins(1., 6., 0.5)\n"
+         << "FisheyeBins.set_angle_bins(0.2, 0.2)\n"
+         << "PSF.scaling_pars = [6.38e-2, 1.26e-3, -0.8]\n"
+         << "Edisp.scaling_pars = [0.0195, 0.1831, -0.2163, -0.4434, "
+         << "0.0510, 0.6621]\n"
+         << settings;
+   setup.close();
+   return checkpoint;
+}
+
+std::string IrfGenTests::project(const std::string & name,
+                                 const std::string & settings) {
+   std::string checkpoint(writeSetup(name, settings));
+   embed_python::Module py("", name);
+   IrfAnalysis analysis(".", py);
+   return checkpoint;
+}
+
+std::string IrfGenTests::projectError(const std::string & name,
+                                      const std::string & settings) {
+   try {
+      project(name, settings);
+   } catch (std::runtime_error & eObj) {
+      return eObj.what();
+   }
+   return "";
+}
+
+void IrfGenTests::threaded_projection() {
+// The histograms are the same for any number of threads.
+   MeritBlock events;
+   makeEvents(250000, 4357, events);
+   writeFlatFile(addFile("irfgen_threads.irfmerit"), events, 250000);
+   std::string settings("Data.flat_files = ['irfgen_threads.irfmerit']\n");
+   std::string serial(project("irfgen_threads1", 
+                              settings + "Data.threads = 1\n"));
+   std::string threaded(project("irfgen_threads4",
+                                settings + "Data.threads = 4\n"));
+   compareCheckpoints(serial, threaded);
+}
+
+void IrfGenTests::root_selection() {
+// The projection selects the entries of the merit tree that pass the
+// cuts, as TTree::GetEntries does, and a selection of no events is an
+// error, for the projection and for a TreeWrapper filter.
+   MeritBlock events;
+   makeEvents(50000, 6151, events);
+   std::string rootfile(addFile("irfgen_merit.root"));
+   writeRootFile(rootfile, events);
+   std::string cuts("McEnergy > 1000 && Tkr1FirstLayer > 5");
+   std::string settings("Data.files = ['" + rootfile + "']\n"
+                        "Prune.branchNames = ['EvtRun', 'McEnergy', "
+                        "'Tkr1FirstLayer', 'McXDir', 'McYDir', 'McZDir', "
+                        "'CTBBestEnergy', 'CTBBestXDir', 'CTBBestYDir', "
+                        "'CTBBestZDir']\n");
+   std::string checkpoint(project("irfgen_cuts", settings 
+                                  + "Prune.cuts = '" + cuts + "'\n"));
+
+   TFile merit(rootfile.c_str());
+   TTree * tree(dynamic_cast<TTree *>(merit.Get("MeritTuple")));
+   CPPUNIT_ASSERT(tree != 0);
+   Long64_t expected(tree->GetEntries(cuts.c_str()));
+   CPPUNIT_ASSERT(expected > 0 && expected < Long64_t(events.size()));
+   CPPUNIT_ASSERT(selectedEvents(checkpoint) == expected);
+   merit.Close();
+
+   CPPUNIT_ASSERT_THROW(project("irfgen_nocuts", settings 
+                                + "Prune.cuts = 'McEnergy < 0'\n"),
+                        std::runtime_error);
+   CPPUNIT_ASSERT_THROW(TreeWrapper(rootfile, "MeritTuple", "McEnergy < 0"),
+                        std::runtime_error);
+}
+
+void IrfGenTests::flat_round_trip() {
+// The events that RootMeritReader reads from a merit tree and
+// FlatMeritWriter writes are read back unchanged by FlatMeritReader,
+// and they project to the same histograms.
+   MeritBlock events;
+   makeEvents(30000, 3571, events);
+   std::string rootfile(addFile("irfgen_flat.root"));
+   writeRootFile(rootfile, events);
+   std::string flatfile(addFile("irfgen_flat.irfmerit"));
+   std::string from_root(project("irfgen_flat_root", 
+                                 "Data.files = ['" + rootfile + "']\n"
+                                 "Data.flat_output = '" + flatfile 
+                                 + "'\n"));
+
+   std::vector<std::string> flatfiles(1, flatfile);
+   FlatMeritReader reader(flatfiles);
+   MeritBlock block;
+   CPPUNIT_ASSERT(reader.read(events.size() + 1, block));
+   CPPUNIT_ASSERT(block.size() == events.size());
+   CPPUNIT_ASSERT(reader.entries() == Long64_t(events.size()));
+   for (size_t k(0); k < events.size(); k++) {
+      // McEnergy and Tkr1FirstLayer are floats in the merit tree.
+      CPPUNIT_ASSERT(block.evtRun[k] == events.evtRun[k]);
+      CPPUNIT_ASSERT(block.mcEnergy[k] == float(events.mcEnergy[k]));
+      CPPUNIT_ASSERT(block.tkr1FirstLayer[k] == events.tkr1FirstLayer[k]);
+      CPPUNIT_ASSERT(block.mcXDir[k] == events.mcXDir[k]);
+      CPPUNIT_ASSERT(block.mcYDir[k] == events.mcYDir[k]);
+      CPPUNIT_ASSERT(block.mcZDir[k] == events.mcZDir[k]);
+      CPPUNIT_ASSERT(block.bestEnergy[k] == events.bestEnergy[k]);
+      CPPUNIT_ASSERT(block.bestXDir[k] == events.bestXDir[k]);
+      CPPUNIT_ASSERT(block.bestYDir[k] == events.bestYDir[k]);
+      CPPUNIT_ASSERT(block.bestZDir[k] == events.bestZDir[k]);
+   }
+   CPPUNIT_ASSERT(!reader.read(1, block));
+
+   std::string from_flat(project("irfgen_flat_flat", 
+                                 "Data.flat_files = ['" + flatfile 
+                                 + "']\n"));
+   compareCheckpoints(from_root, from_flat);
+}
+
+void IrfGenTests::flat_byte_order() {
+// A flat file written with the opposite byte order is refused.
+   std::string flatfile(addFile("irfgen_swapped.irfmerit"));
+   std::ofstream file(flatfile.c_str(), std::ios::out | std::ios::binary);
+   const unsigned int header[] = {FlatMeritReader::version, 
+                                  FlatMeritReader::byte_order,
+                                  MeritBlock::ncolumns};
+   file.write(FlatMeritReader::tag(), 8);
+   for (size_t i(0); i < 3; i++) {
+      const char * bytes(reinterpret_cast<const char *>(&header[i]));
+      std::string reversed(bytes, bytes + sizeof(header[i]));
+      std::reverse(reversed.begin(), reversed.end());
+      file.write(reversed.data(), reversed.size());
+   }
+   file.close();
+
+   std::vector<std::string> flatfiles(1, flatfile);
+   FlatMeritReader reader(flatfiles);
+   MeritBlock block;
+   std::string message;
+   try {
+      reader.read(1, block);
+   } catch (std::runtime_error & eObj) {
+      message = eObj.what();
+   }
+   CPPUNIT_ASSERT(message.find("byte order") != std::string::npos);
+}
+
+void IrfGenTests::flat_truncated_header() {
+// A flat file that ends within a chunk header is refused, rather
+// than read as if it ended after the last complete chunk.
+   MeritBlock events;
+   makeEvents(1000, 4733, events);
+   std::string flatfile(addFile("irfgen_header.irfmerit"));
+   writeFlatFile(flatfile, events, 1000);
+   std::ofstream file(flatfile.c_str(), 
+                      std::ios::out | std::ios::binary | std::ios::app);
+   file.write("\0\0\0", 3);
+   file.close();
+
+   std::vector<std::string> flatfiles(1, flatfile);
+   FlatMeritReader reader(flatfiles);
+   MeritBlock block;
+   std::string messages[2];
+   try {
+      reader.read(2*events.size(), block);
+   } catch (std::runtime_error & eObj) {
+      messages[0] = eObj.what();
+   }
+   try {
+      reader.size();
+   } catch (std::runtime_error & eObj) {
+      messages[1] = eObj.what();
+   }
+   for (size_t i(0); i < 2; i++) {
+      CPPUNIT_ASSERT(messages[i].find("truncated chunk header") 
+                     != std::string::npos);
+   }
+}
+
+void IrfGenTests::vectorized_errors() {
+// The array versions of the event errors and scale factors agree with
+// the scalar calculations over a grid of directions and energies,
+// including the directions along the z-axis.
+   MeritBlock block;
+   for (int iz(0); iz <= 20; iz++) {
+      double zdir(-1. + 0.1*iz);
+      double sintheta(std::sqrt(std::max(0., 1. - zdir*zdir)));
+      for (int iphi(0); iphi < 8; iphi++) {
+         double phi(M_PI/4.*iphi);
+         for (int ie(0); ie <= 10; ie++) {
+            double energy(std::pow(10., 1. + 0.5*ie));
+            double offset(0.1*std::pow(energy/100., -0.8));
+            block.evtRun.push_back(0);
+            block.tkr1FirstLayer.push_back(0);
+            block.mcEnergy.push_back(energy);
+            block.mcXDir.push_back(sintheta*std::cos(phi));
+            block.mcYDir.push_back(sintheta*std::sin(phi));
+            block.mcZDir.push_back(zdir);
+            block.bestEnergy.push_back(energy*(1. + 0.01*(ie - 5)));
+            block.bestXDir.push_back(block.mcXDir.back() + offset);
+            block.bestYDir.push_back(block.mcYDir.back() - 0.5*offset);
+            block.bestZDir.push_back(zdir + 0.25*offset);
+         }
+      }
+   }
+   EventErrors errors;
+   errors.compute(block, 4);
+   CPPUNIT_ASSERT(errors.diff.size() == block.size());
+
+   std::vector<double> psf_pars;
+   psf_pars.push_back(6.38e-2);
+   psf_pars.push_back(1.26e-3);
+   psf_pars.push_back(-0.8);
+   double edisp_values[] = {0.0195, 0.1831, -0.2163, -0.4434, 0.0510, 0.6621};
+   std::vector<double> edisp_pars(edisp_values, edisp_values + 6);
+   std::vector<double> psf_factors, edisp_factors;
+   PointSpreadFunction::scaleFactors(block.mcEnergy, psf_pars, psf_factors);
+   Dispersion::scaleFactors(block.mcEnergy, block.mcZDir, edisp_pars,
+                            edisp_factors);
+
+   double tol(1e-12);
+   for (size_t k(0); k < block.size(); k++) {
+      HepGeom::Vector3D<double>
+         mc_dir(block.mcXDir[k], block.mcYDir[k], block.mcZDir[k]),
+         fit_dir(block.bestXDir[k], block.bestYDir[k], block.bestZDir[k]);
+      HepGeom::Vector3D<double> 
+         mc_error(mc_dir - fit_dir), zhat(0, 0, 1),
+         phi_hat = zhat.cross(mc_dir).unit(),
+         theta_hat = phi_hat.cross(mc_dir).unit();
+      CPPUNIT_ASSERT(std::fabs(errors.theta_err[k] - mc_error*theta_hat) 
+                     < tol);
+      CPPUNIT_ASSERT(std::fabs(errors.diff[k] - mc_dir.angle(fit_dir)) 
+                     < tol);
+      CPPUNIT_ASSERT(std::fabs(errors.dsp[k] - (block.bestEnergy[k]
+                                                /block.mcEnergy[k] - 1))
+                     < tol);
+      double psf_factor(PointSpreadFunction::scaleFactor(block.mcEnergy[k],
+                                                         block.mcZDir[k],
+                                                         psf_pars));
+      CPPUNIT_ASSERT(std::fabs(psf_factors[k] - psf_factor) 
+                     < tol*psf_factor);
+      double edisp_factor(Dispersion::scaleFactor(block.mcEnergy[k],
+                                                  block.mcZDir[k],
+                                                  edisp_pars));
+      CPPUNIT_ASSERT(std::fabs(edisp_factors[k] - edisp_factor) 
+                     < tol*std::max(1., std::fabs(edisp_factor)));
+   }
+}
+
+void IrfGenTests::overlap_sums() {
+// With over-lapping bins, filling each event once and summing the
+// neighbouring bins gives the PSF and dispersion histograms that
+// filling each event into every over-lapping bin gave.  The
+// checkpoints every 100000 entries sum the overlaps more than once.
+   MeritBlock events;
+   makeEvents(250000, 8191, events);
+   writeFlatFile(addFile("irfgen_overlap.irfmerit"), events, 250000);
+   std::string name("irfgen_overlap");
+   std::string checkpoint(project(name,
+                                  "Data.flat_files = "
+                                  "['irfgen_overlap.irfmerit']\n"
+                                  "Data.checkpoint_interval = 100000\n"
+                                  "Bins.psf_energy_overlap = 1\n"
+                                  "Bins.psf_angle_overlap = 2\n"
+                                  "Bins.edisp_energy_overlap = 2\n"
+                                  "Bins.edisp_angle_overlap = 1\n"));
+
+// Fill each event into all of its over-lapping bins.
+   embed_python::Module py("", name);
+   IrfBinner binner(py);
+   std::vector<double> psf_pars, edisp_pars;
+   py.getList("PSF.scaling_pars", psf_pars);
+   py.getList("Edisp.scaling_pars", edisp_pars);
+   std::vector<PointSpreadFunction> psfs(binner.size());
+   std::vector<Dispersion> disps(binner.size());
+   for (size_t ebin(0); ebin < binner.energy_bins(); ++ebin) {
+      for (size_t abin(0); abin <= binner.angle_bins(); ++abin) {
+         size_t id(binner.ident(ebin, abin));
+         psfs[id] = PointSpreadFunction(IrfBinner::hist_name(abin, ebin,
+                                                             "psf_old"),
+                                        "", py);
+         disps[id] = Dispersion(IrfBinner::hist_name(abin, ebin, "disp_old"),
+                                "", py);
+      }
+   }
+   EventErrors errors;
+   errors.compute(events, 1);
+   int abins(binner.angle_bins());
+   int ebins(binner.energy_bins());
+   for (size_t k(0); k < events.size(); k++) {
+      double energy(events.mcEnergy[k]);
+      double zdir(events.mcZDir[k]);
+      int z_bin(binner.angle_bin(zdir));
+      int e_bin(binner.energy_bin(energy));
+      if (z_bin >= abins || e_bin < 0 || e_bin >= ebins) {
+         continue;
+      }
+      double psf_delta(errors.diff[k]
+                       /PointSpreadFunction::scaleFactor(energy, zdir,
+                                                         psf_pars));
+      double disp_delta(errors.dsp[k]
+                        /Dispersion::scaleFactor(energy, zdir, edisp_pars));
+      // As in the old fill, the energy bin offset spans the angle
+      // overlap, and the angle bin offset spans the energy overlap.
+      for (int eoffset(-2); eoffset < 3; eoffset++) {
+         for (int aoffset(-2); aoffset < 3; aoffset++) {
+            int indx(binner.hist_id(e_bin + eoffset, z_bin + aoffset));
+            if (indx < 0) {
+               continue;
+            }
+            if (std::abs(eoffset) <= binner.psfAngleOverLap()
+                && std::abs(aoffset) <= binner.psfEnergyOverLap()) {
+               psfs[indx].fill(psf_delta);
+            }
+            if (std::abs(eoffset) <= binner.edispAngleOverLap()
+                && std::abs(aoffset) <= binner.edispEnergyOverLap()) {
+               disps[indx].fill(disp_delta);
+            }
+         }
+      }
+      if (z_bin < abins - 2) {
+         psfs[binner.ident(e_bin, abins)].fill(psf_delta);
+         disps[binner.ident(e_bin, abins)].fill(disp_delta);
+      }
+   }
+
+   TFile file(checkpoint.c_str());
+   CPPUNIT_ASSERT(!file.IsZombie());
+   for (size_t id(0); id < binner.size(); id++) {
+      const TH1 * old_hists[] = {psfs[id].histogram(), disps[id].histogram()};
+      for (size_t j(0); j < 2; j++) {
+         std::string hist_name(old_hists[j]->GetName());
+         hist_name.erase(hist_name.find("_old"), 4);
+         TH1 * hist(dynamic_cast<TH1 *>(file.Get(hist_name.c_str())));
+         CPPUNIT_ASSERT(hist != 0);
+         CPPUNIT_ASSERT(hist->GetNcells() == old_hists[j]->GetNcells());
+         CPPUNIT_ASSERT(hist->GetEntries() == old_hists[j]->GetEntries());
+         for (int bin(0); bin < hist->GetNcells(); bin++) {
+            CPPUNIT_ASSERT(hist->GetBinContent(bin) 
+                           == old_hists[j]->GetBinContent(bin));
+         }
+      }
+   }
+}
+
+void IrfGenTests::resume_projection() {
+// A projection stopped by a truncated flat file keeps its last
+// checkpoint.  Once the file is complete, the projection resumes from
+// the checkpoint and gives the histograms of an uninterrupted run.  A
+// run with other settings does not resume from the checkpoint.
+   MeritBlock events;
+   makeEvents(250000, 1597, events);
+   std::string flatfile(addFile("irfgen_resume.irfmerit"));
+   writeFlatFile(flatfile, events, 100000);
+   std::string settings("Data.flat_files = ['" + flatfile + "']\n"
+                        "Data.checkpoint_interval = 100000\n");
+   std::string uninterrupted(project("irfgen_resume_all", settings));
+
+// The third chunk is truncated, so the reader throws after the
+// checkpoint of the first 100000 events.
+   truncateFile(flatfile, 1000);
+   std::string checkpoint("irfgen_resume_checkpoint.root");
+   std::string message(projectError("irfgen_resume", settings));
+   CPPUNIT_ASSERT(message.find("truncated chunk") != std::string::npos);
+   CPPUNIT_ASSERT(selectedEvents(checkpoint) == 100000);
+
+   std::string resume_settings(settings + "Data.checkpoint_file = '" 
+                               + checkpoint + "'\n");
+   message = projectError("irfgen_resume_cuts", resume_settings
+                          + "Prune.cuts = 'McEnergy > 100'\n");
+   CPPUNIT_ASSERT(message.find("different") != std::string::npos);
+   message = projectError("irfgen_resume_bins", resume_settings
+                          + "Bins.set_energy_bins(1., 6., 0.25)\n");
+   CPPUNIT_ASSERT(message.find("different") != std::string::npos);
+   message = projectError("irfgen_resume_shard", resume_settings
+                          + "Data.shard_count = 2\n");
+   CPPUNIT_ASSERT(message.find("shard") != std::string::npos);
+   CPPUNIT_ASSERT(selectedEvents(checkpoint) == 100000);
+
+   writeFlatFile(flatfile, events, 100000);
+   project("irfgen_resume_rest", resume_settings);
+   compareCheckpoints(uninterrupted, checkpoint);
+}
+
+void IrfGenTests::sharded_projection() {
+// The merged projections of the shards are the projection of all of
+// the entries by a single process, for the flat and the ROOT inputs.
+// The shard boundaries of the flat file fall inside its chunks.
+   MeritBlock events;
+   makeEvents(250000, 2357, events);
+   std::string flatfile(addFile("irfgen_shards.irfmerit"));
+   writeFlatFile(flatfile, events, 100000);
+   std::string rootfile(addFile("irfgen_shards.root"));
+   writeRootFile(rootfile, events);
+   std::string inputs[] = {
+      "Data.flat_files = ['" + flatfile + "']\n",
+      "Data.files = ['" + rootfile + "']\n"
+      "Prune.cuts = 'Tkr1FirstLayer > 5'\n"};
+   int shard_counts[] = {2, 3};
+   for (size_t i(0); i < 2; i++) {
+      std::ostringstream name;
+      name << "irfgen_shards" << i;
+      std::string single(project(name.str(), inputs[i]));
+      std::vector<std::string> shards;
+      for (int shard(0); shard < shard_counts[i]; shard++) {
+         std::ostringstream shard_name, shard_settings;
+         shard_name << name.str() << "_shard" << shard;
+         shard_settings << inputs[i] 
+                        << "Data.shard_index = " << shard << "\n"
+                        << "Data.shard_count = " << shard_counts[i] << "\n";
+         shards.push_back(project(shard_name.str(), shard_settings.str()));
+      }
+      std::string merged(addFile(name.str() + "_merged.root"));
+      IrfAnalysis::mergeCheckpoints(shards, merged);
+      compareCheckpoints(single, merged);
+   }
+
+   std::string message(projectError("irfgen_shards_skim", inputs[1]
+                                     + "Prune.fileName = "
+                                     "'irfgen_shards_skim.root'\n"
+                                     "Data.shard_count = 2\n"));
+   CPPUNIT_ASSERT(message.find("Prune.fileName") != std::string::npos);
+}
+
+void IrfGenTests::tables_only_directory() {
+// tablesOnly keeps the histograms out of the ROOT directories only
+// while the analysis exists, even if it throws.
+   MeritBlock events;
+   makeEvents(20000, 4099, events);
+   writeFlatFile(addFile("irfgen_tables.irfmerit"), events, 20000);
+   std::string settings("tablesOnly = 1\n"
+                        "parameterFile = 'irfgen_tables_pars.root'\n");
+   addFile("irfgen_tables_pars.root");
+   CPPUNIT_ASSERT(TH1::AddDirectoryStatus());
+   project("irfgen_tables", settings 
+           + "Data.flat_files = ['irfgen_tables.irfmerit']\n");
+   CPPUNIT_ASSERT(TH1::AddDirectoryStatus());
+   std::string message(projectError("irfgen_tables_missing", settings 
+                                    + "Data.flat_files = "
+                                    "['irfgen_tables_missing.irfmerit']\n"));
+   CPPUNIT_ASSERT(message.find("could not open") != std::string::npos);
+   CPPUNIT_ASSERT(TH1::AddDirectoryStatus());
+}
+
+void IrfGenTests::threaded_fit() {
+// The histograms restored from a complete checkpoint can be fit on
+// several threads.  Only the threaded fits use Minuit2, and the
+// default minimizer is restored after each fit.
+   MeritBlock events;
+   makeEvents(100000, 7919, events);
+   writeFlatFile(addFile("irfgen_fit.irfmerit"), events, 100000);
+   std::string settings("Data.flat_files = ['irfgen_fit.irfmerit']\n");
+   std::string checkpoint(project("irfgen_fit", settings));
+   Long64_t selected(selectedEvents(checkpoint));
+   settings += "Data.checkpoint_file = '" + checkpoint + "'\n"
+      "Data.project_only = 0\n";
+
+   std::string minimizer(ROOT::Math::MinimizerOptions::DefaultMinimizerType());
+   int threads[] = {4, 1};
+   for (size_t i(0); i < 2; i++) {
+      std::ostringstream name, thread_settings;
+      name << "irfgen_fit" << threads[i];
+      thread_settings << settings << "Data.threads = " << threads[i] << "\n";
+      writeSetup(name.str(), thread_settings.str());
+      embed_python::Module py("", name.str());
+      IrfAnalysis analysis(".", py);
+      CPPUNIT_ASSERT(!analysis.project_only());
+      analysis.fit(false);
+      CPPUNIT_ASSERT(ROOT::Math::MinimizerOptions::DefaultMinimizerType() 
+                     == minimizer);
+   }
+// The fits leave the checkpoint as it was.
+   CPPUNIT_ASSERT(selectedEvents(checkpoint) == selected);
+}
+
 int main(int argc, char* argv[]) {
    (void)(argc);
    (void)(argv);
@@ -326,6 +1076,15 @@ int main(int argc, char* argv[]) {
 //       std::exit(1);
 //    }
     int rc(0);
+    try {
+        CppUnit::TextTestRunner runner;
+        runner.addTest(IrfGenTests::suite());
+        rc = runner.run() ? 0 : 1;
+    } catch (const std::exception & eObj) {
+        std::cout << "Caught exception: ";
+        std::cout << eObj.what() << std::endl;
+        rc = 1;
+    }
 //     try{
 //         handoff_response::load_irfs();
 
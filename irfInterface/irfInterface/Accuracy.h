@@ -0,0 +1,67 @@
+/**
+ * @file Accuracy.h
+ * @brief Accuracy policy for the numerical integrations performed by
+ * the IRF classes.
+ *
+ * @author J. Chiang
+ *
+ * $Header$
+ */
+
+#ifndef irfInterface_Accuracy_h
+#define irfInterface_Accuracy_h
+
+#include <algorithm>
+#include <cstddef>
+
+namespace irfInterface {
+
+/**
+ * @class Accuracy
+ *
+ * @brief Scale the quadrature tolerances and the number of sample
+ * points used by the IRF integrations.
+ *
+ * Each integration site has a nominal tolerance (or number of
+ * points) that is used as is in DEFAULT mode.  FAST relaxes the
+ * tolerance by a factor of 100, to at most 1e-2, and uses a quarter
+ * of the points, for exploratory scans.  PRECISE tightens the
+ * tolerance by a factor of 100 and uses four times the points.
+ */
+
+class Accuracy {
+
+public:
+
+   enum Mode {FAST, DEFAULT, PRECISE};
+
+   /// @return The tolerance to use in place of the nominal value tol.
+   static double tolerance(Mode mode, double tol) {
+      switch (mode) {
+      case FAST:
+         return std::max(tol, std::min(1e2*tol, 1e-2));
+      case PRECISE:
+         return std::max(1e-2*tol, 1e-12);
+      default:
+         return tol;
+      }
+   }
+
+   /// @return The number of points to use in place of the nominal
+   ///         value npts.
+   static size_t npts(Mode mode, size_t npts) {
+      switch (mode) {
+      case FAST:
+         return std::max(npts/4, static_cast<size_t>(2));
+      case PRECISE:
+         return 4*npts;
+      default:
+         return npts;
+      }
+   }
+
+};
+
+} // namespace irfInterface
+
+#endif // irfInterface_Accuracy_h
@@ -9,6 +9,8 @@
 #ifndef irfInterface_IAeff_h
 #define irfInterface_IAeff_h
 
+#include <cmath>
+
 #include <stdexcept>
 #include <vector>
 
@@ -77,6 +79,32 @@ public:
      return vals;     
    }
 
+   /// Phi-averaged effective area (cm^2) on a grid, for contraction
+   /// with livetime distributions in exposure calculations.
+   /// @param energies True photon energies (MeV).
+   /// @param costhetas Cosines of the true inclination angle.
+   /// @param values On return, values[i*costhetas.size() + j] is the
+   ///        effective area at energies[i] and costhetas[j].
+   /// @param time Photon arrival time (MET s).
+   virtual void valueMatrix(const std::vector<double> & energies,
+                            const std::vector<double> & costhetas,
+                            std::vector<double> & values,
+                            double time=0) const {
+      // Average over the centers of 5-degree phi bins if need be.
+      size_t nphi(usePhiDependence() ? 72 : 1);
+      values.resize(energies.size()*costhetas.size());
+      for (size_t j(0); j < costhetas.size(); j++) {
+         double theta(std::acos(costhetas[j])*180./M_PI);
+         for (size_t i(0); i < energies.size(); i++) {
+            double sum(0);
+            for (size_t k(0); k < nphi; k++) {
+               sum += value(energies[i], theta, 360.*(k + 0.5)/nphi, time);
+            }
+            values[i*costhetas.size() + j] = sum/nphi;
+         }
+      }
+   }
+
    /// This method is also virtual, in case the sub-classes wish to
    /// overload it.
    virtual double operator()(double energy, 
@@ -92,6 +120,14 @@ public:
    /// area for all energies and directions (cm^2).
    virtual double upperLimit() const = 0;
 
+   /// @return An upper limit on the value of the effective area at
+   /// the given true energy (MeV) for all directions (cm^2), e.g.,
+   /// for rejection sampling.  By default, this is upperLimit().
+   virtual double upperLimit(double energy) const {
+      (void)(energy);
+      return upperLimit();
+   }
+
    virtual void setPhiDependence(bool usePhiDependence) {
       m_usePhiDependence = usePhiDependence;
    }
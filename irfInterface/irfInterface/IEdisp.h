@@ -11,6 +11,8 @@
 
 #include <vector>
 
+#include "irfInterface/Accuracy.h"
+
 namespace astro {
    class SkyDir;
 }
@@ -31,6 +33,8 @@ class IEdisp {
     
 public:
 
+   IEdisp() : m_accuracy(Accuracy::DEFAULT) {}
+
    virtual ~IEdisp() {}
 
    /// Pure virtual method to define the interface for the member
@@ -152,8 +156,20 @@ public:
 
    virtual IEdisp * clone() = 0;
 
+   /// Set the accuracy of the integrations over the energy
+   /// dispersion.
+   virtual void setAccuracy(Accuracy::Mode mode) {
+      m_accuracy = mode;
+   }
+
+   Accuracy::Mode accuracy() const {
+      return m_accuracy;
+   }
+
 private:
 
+   Accuracy::Mode m_accuracy;
+
    class EdispIntegrand {
    public:
       EdispIntegrand(const IEdisp & edisp, double energy, double theta,
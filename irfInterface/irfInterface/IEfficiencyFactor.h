@@ -18,6 +18,8 @@
 #include <string>
 #include <vector>
 
+#include "irfInterface/LivetimeHistory.h"
+
 namespace irfInterface {
 
 /**
@@ -42,16 +44,36 @@ public:
 
    virtual IEfficiencyFactor * clone() const = 0;
 
+   /// Efficiency factors for a batch of events, using the livetime
+   /// fractions from the FT2 file.  The livetime intervals are walked
+   /// linearly, so this is fastest if met is in increasing order.
+   virtual void getValues(const std::vector<double> & energy,
+                          const std::vector<double> & met,
+                          std::vector<double> & values) const;
+
+   /// Read the livetime history from ft2file.  If the
+   /// LIVETIME_CACHE_DIR environment variable is set, a
+   /// memory-mapped livetime cache in that directory is used.
    void readFt2File(std::string ft2file);
 
    void clearFt2Data();
 
+protected:
+
+   const LivetimeHistory & livetimeHistory() const {
+      return m_ltHistory;
+   }
+
+   /// @return Livetime fraction of the FT2 interval containing met.
+   ///         For times in gaps between intervals, the preceding
+   ///         interval is used.
+   double livetimeFraction(double met) const {
+      return m_ltHistory.livetimefrac(m_ltHistory.index(met));
+   }
 
 private:
 
-   std::vector<double> m_start;
-   std::vector<double> m_stop;
-   std::vector<double> m_livetimefrac;
+   LivetimeHistory m_ltHistory;
 
    void readPars(std::string parfile);
 
@@ -11,6 +11,8 @@
 
 #include <vector>
 
+#include "irfInterface/Accuracy.h"
+
 namespace astro {
    class SkyDir;
 }
@@ -141,6 +143,15 @@ public:
 
    virtual IPsf * clone() = 0;
 
+   /// Set the accuracy of the angular integrations of the PSF.
+   virtual void setAccuracy(Accuracy::Mode mode) {
+      m_accuracy = mode;
+   }
+
+   Accuracy::Mode accuracy() const {
+      return m_accuracy;
+   }
+
    /// Angular integral of the PSF over the intersection of acceptance
    /// cones.
    static double psfIntegral(IPsf * self, double energy,
@@ -168,6 +179,8 @@ public:
 
 private:
 
+   Accuracy::Mode m_accuracy;
+
    static double s_energy;
    static double s_theta;
    static double s_phi;
@@ -190,6 +203,57 @@ private:
    static double psfIntegrand2(double * mu);
 
 #ifndef SWIG
+   /// The integrands, which carry their own parameters so that the
+   /// integrals can be done concurrently.  The static functions above
+   /// wrap them for the non-reentrant SLATEC routine.
+   class ConeIntegrand {
+   public:
+      ConeIntegrand(const IPsf & psf, double energy, double theta,
+                    double phi, double time)
+         : m_psf(psf), m_energy(energy), m_theta(theta), m_phi(phi),
+           m_time(time) {}
+      double operator()(double offset) const;
+   private:
+      const IPsf & m_psf;
+      double m_energy;
+      double m_theta;
+      double m_phi;
+      double m_time;
+   };
+
+   class PsfIntegrand1 {
+   public:
+      PsfIntegrand1(const IPsf & psf, double energy, double theta,
+                    double phi, double time)
+         : m_psf(psf), m_energy(energy), m_theta(theta), m_phi(phi),
+           m_time(time) {}
+      double operator()(double mu) const;
+   private:
+      const IPsf & m_psf;
+      double m_energy;
+      double m_theta;
+      double m_phi;
+      double m_time;
+   };
+
+   class PsfIntegrand2 {
+   public:
+      PsfIntegrand2(const IPsf & psf, double energy, double theta,
+                    double phi, double time, double cp, double sp, double cr)
+         : m_psf(psf), m_energy(energy), m_theta(theta), m_phi(phi),
+           m_time(time), m_cp(cp), m_sp(sp), m_cr(cr) {}
+      double operator()(double mu) const;
+   private:
+      const IPsf & m_psf;
+      double m_energy;
+      double m_theta;
+      double m_phi;
+      double m_time;
+      double m_cp;
+      double m_sp;
+      double m_cr;
+   };
+
    class IntegralFunctor {
 
    public:
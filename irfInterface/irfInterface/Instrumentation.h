@@ -0,0 +1,144 @@
+/**
+ * @file Instrumentation.h
+ * @brief Run-time switchable counters and timers for the IRF hot
+ * paths.
+ *
+ * @author J. Chiang
+ *
+ * $Header$
+ */
+
+#ifndef irfInterface_Instrumentation_h
+#define irfInterface_Instrumentation_h
+
+#include <map>
+#include <string>
+
+namespace irfInterface {
+
+/**
+ * @class Instrumentation
+ *
+ * @brief Library-wide registry of named counters.
+ *
+ * Counters are declared as static Counter objects next to the code
+ * they measure and are updated only when instrumentation is enabled,
+ * so the cost when disabled is a test of a static flag.
+ * Instrumentation is enabled by calling enable() or by setting the
+ * IRF_INSTRUMENTATION environment variable.  Counter names have the
+ * form "<component>/<quantity>", e.g., "Aeff::value/calls",
+ * "PsfIntegralCache/misses" or "dgaus8/seconds".  Counters with the
+ * same name are summed.
+ */
+
+class Instrumentation {
+
+public:
+
+   static void enable(bool flag=true) {
+      s_enabled = flag;
+   }
+
+   static bool enabled() {
+      return s_enabled;
+   }
+
+   /// Zero all counters.
+   static void reset();
+
+   /// @return Current values of all counters, keyed by name.
+   static std::map<std::string, double> counters();
+
+   /// @return Value of the named counter, or zero if there is none.
+   static double counter(const std::string & name);
+
+   /// @return Table of the non-zero counters, one per line.
+   static std::string report();
+
+   /// @return Wall-clock time in seconds.
+   static double wallTime();
+
+private:
+
+   static bool s_enabled;
+
+};
+
+/**
+ * @class Counter
+ * @brief A named count or accumulated time, registered with
+ * Instrumentation on construction.
+ */
+
+class Counter {
+
+public:
+
+   Counter(const std::string & name);
+
+   ~Counter();
+
+   void add(double amount=1) {
+      if (Instrumentation::enabled()) {
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+         m_value += amount;
+      }
+   }
+
+   const std::string & name() const {
+      return m_name;
+   }
+
+   double value() const {
+      return m_value;
+   }
+
+   void reset() {
+      m_value = 0;
+   }
+
+private:
+
+   std::string m_name;
+
+   double m_value;
+
+   // Disable copying.
+   Counter(const Counter &);
+   Counter & operator=(const Counter &);
+
+};
+
+/**
+ * @class ScopedTimer
+ * @brief Add the wall-clock time spent in the enclosing scope to a
+ * Counter, in seconds.
+ */
+
+class ScopedTimer {
+
+public:
+
+   ScopedTimer(Counter & counter)
+      : m_counter(counter),
+        m_start(Instrumentation::enabled() ? Instrumentation::wallTime() : 0) {}
+
+   ~ScopedTimer() {
+      if (m_start != 0) {
+         m_counter.add(Instrumentation::wallTime() - m_start);
+      }
+   }
+
+private:
+
+   Counter & m_counter;
+
+   double m_start;
+
+};
+
+} // namespace irfInterface
+
+#endif // irfInterface_Instrumentation_h
@@ -11,6 +11,7 @@
 #define irfInterface_IrfLoader_h
 
 #include <string>
+#include <vector>
 
 namespace irfInterface {
 
@@ -33,6 +34,34 @@ public:
 
    virtual std::string name() const = 0;
 
+   /// @return true if this loader can defer loading to resolveIrfs()
+   /// and resolveEventClasses().  In that case, IrfRegistry::loadIrfs
+   /// will not call loadIrfs() or registerEventClasses().
+   virtual bool deferrable() const {
+      return false;
+   }
+
+   /// Names, e.g., "P8R2_SOURCE_V6::FRONT", of the Irfs that can be
+   /// provided by resolveIrfs().  This should only scan the metadata.
+   virtual void getIrfsNames(std::vector<std::string> & names) const {
+      (void)(names);
+   }
+
+   /// Add the single Irfs object named irfsName to IrfsFactory.
+   /// @return false if this loader does not provide irfsName.
+   virtual bool resolveIrfs(const std::string & irfsName) const {
+      (void)(irfsName);
+      return false;
+   }
+
+   /// Register the event classes for the response named respName
+   /// with IrfRegistry.
+   /// @return false if this loader does not provide respName.
+   virtual bool resolveEventClasses(const std::string & respName) const {
+      (void)(respName);
+      return false;
+   }
+
 };
 
 } // namespace irfInterface
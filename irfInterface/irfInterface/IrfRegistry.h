@@ -37,6 +37,9 @@ public:
    void registerEventClass(const std::string & name,
                            const std::string & className);
 
+   /// Load the IRFs provided by the loader named irfsName.  For
+   /// deferrable loaders, the individual Irfs objects and event
+   /// classes are only loaded when they are first requested.
    void loadIrfs(const std::string & irfsName);
 
    std::vector<std::string> irfNames() const;
@@ -44,9 +47,19 @@ public:
    const std::vector<std::string> & 
    operator[](const std::string & respName) const;
    
-   const std::map<std::string, std::vector<std::string> > & respIds() const {
-      return m_respIds;
-   }
+   /// This registers the event classes of all deferred loaders.
+   const std::map<std::string, std::vector<std::string> > & respIds() const;
+
+   /// Ask the deferred loaders to add the Irfs named irfsName to
+   /// IrfsFactory.
+   /// @return true if one of them did.
+   bool resolveIrfs(const std::string & irfsName) const;
+
+   /// Append the names of the Irfs available from the deferred
+   /// loaders, starting with loader number nloaders.  On return,
+   /// nloaders is the number of deferred loaders.
+   void getDeferredIrfsNames(std::vector<std::string> & names,
+                             size_t & nloaders) const;
    
 protected:
 
@@ -58,7 +71,13 @@ private:
 
    std::map<std::string, IrfLoader *> m_irfLoaders;
 
-   std::map<std::string, std::vector<std::string> > m_respIds; 
+   mutable std::map<std::string, std::vector<std::string> > m_respIds; 
+
+   /// Loaders whose IRFs are loaded on demand.
+   std::vector<IrfLoader *> m_deferred;
+
+   /// Deferred loaders whose event classes have all been registered.
+   mutable std::vector<IrfLoader *> m_registered;
 
 };
 
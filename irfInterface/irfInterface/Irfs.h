@@ -9,6 +9,7 @@
 #ifndef irfInterface_Irfs_h
 #define irfInterface_Irfs_h
 
+#include "irfInterface/Accuracy.h"
 #include "irfInterface/IAeff.h"
 #include "irfInterface/IPsf.h"
 #include "irfInterface/IEdisp.h"
@@ -29,11 +30,12 @@ class Irfs {
 public:
 
    Irfs() : m_aeff(0), m_psf(0), m_edisp(0), m_efficiencyFactor(0),
-            m_irfID(0) {}
+            m_irfID(0), m_accuracy(Accuracy::DEFAULT) {}
 
    Irfs(IAeff * aeff, IPsf * psf, IEdisp * edisp, int irfID) 
       : m_aeff(aeff), m_psf(psf), m_edisp(edisp), 
-        m_efficiencyFactor(0), m_irfID(irfID) {}
+        m_efficiencyFactor(0), m_irfID(irfID),
+        m_accuracy(Accuracy::DEFAULT) {}
 
    Irfs(const Irfs & rhs) {
       if (rhs.m_psf != 0) {
@@ -57,6 +59,7 @@ public:
          m_efficiencyFactor = 0;
       }
       m_irfID = rhs.m_irfID;
+      setAccuracy(rhs.m_accuracy);
    }
 
    virtual ~Irfs() {
@@ -92,10 +95,32 @@ public:
 
    void setPsf(IPsf * psf) {
       m_psf = psf;
+      if (m_psf) {
+         m_psf->setAccuracy(m_accuracy);
+      }
    }
 
    void setEdisp(IEdisp * edisp) {
       m_edisp = edisp;
+      if (m_edisp) {
+         m_edisp->setAccuracy(m_accuracy);
+      }
+   }
+
+   /// Set the accuracy of the numerical integrations performed by
+   /// the psf and edisp, including those created after this call.
+   void setAccuracy(Accuracy::Mode mode) {
+      m_accuracy = mode;
+      if (m_psf) {
+         m_psf->setAccuracy(mode);
+      }
+      if (m_edisp) {
+         m_edisp->setAccuracy(mode);
+      }
+   }
+
+   Accuracy::Mode accuracy() const {
+      return m_accuracy;
    }
 
    virtual Irfs * clone() {
@@ -121,6 +146,8 @@ private:
    
    int m_irfID;
 
+   Accuracy::Mode m_accuracy;
+
 };
 
 } // namespace irfInterface
@@ -11,6 +11,7 @@
 
 #include <string>
 #include <map>
+#include <set>
 
 #include <vector>
 #include <string>
@@ -38,23 +39,36 @@ class IrfsFactory {
 
 public:
 
+   /// Irfs that have not been added are first requested from the
+   /// IrfRegistry's deferred loaders.
    Irfs * create(const std::string & name) const;
 
+   /// Add a prototype.  The factory takes ownership of irfs.
    void addIrfs(const std::string & name, Irfs * irfs, bool verbose=false);
 
+   /// Add several prototypes at once, e.g., all of the event types
+   /// for a set of IRFs.  The factory takes ownership of the Irfs.
+   void addIrfs(const std::vector<std::string> & names,
+                const std::vector<Irfs *> & irfs, bool verbose=false);
+
    void getIrfsNames(std::vector<std::string> & names) const;
 
-   const std::vector<std::string> & irfNames() const {
-      return m_irfNames;
+   /// @return true if an Irfs object named name has been added.
+   bool hasIrfs(const std::string & name) const {
+      return m_prototypes.count(name) > 0;
    }
 
+   /// Names of the Irfs that have been added or that can be
+   /// provided by the IrfRegistry's deferred loaders.
+   const std::vector<std::string> & irfNames() const;
+
    static IrfsFactory * instance();
 
    static void delete_instance();
 
 protected:
 
-   IrfsFactory() {}
+   IrfsFactory() : m_numDeferred(0) {}
 
    ~IrfsFactory();
 
@@ -62,10 +76,19 @@ private:
 
    std::map<std::string, Irfs *> m_prototypes;
 
-   std::vector<std::string> m_irfNames;
+   mutable std::vector<std::string> m_irfNames;
+
+   /// The names in m_irfNames, to find duplicates.
+   mutable std::set<std::string> m_irfIndex;
+
+   /// Number of IrfRegistry deferred loaders whose names have been
+   /// added to m_irfNames.
+   mutable size_t m_numDeferred;
 
    static IrfsFactory * s_instance;
 
+   void addIrfsName(const std::string & name) const;
+
 };
 
 } // namespace irfInterface
@@ -0,0 +1,102 @@
+/**
+ * @file LivetimeHistory.h
+ * @brief Livetime fractions of the intervals in an FT2 file.
+ *
+ * @author J. Chiang
+ *
+ * $Header$
+ */
+
+#ifndef irfInterface_LivetimeHistory_h
+#define irfInterface_LivetimeHistory_h
+
+#include <string>
+#include <vector>
+
+namespace irfInterface {
+
+/**
+ * @class LivetimeHistory
+ *
+ * @brief START and STOP times and livetime fractions of the
+ * intervals in the SC_DATA extension of an FT2 file.
+ *
+ * Only the START, STOP and LIVETIME columns are used.  If a cache
+ * directory is given, the arrays are written to a binary cache file
+ * there and subsequently memory-mapped, so that processes using the
+ * same FT2 file share a single copy.  The cache files are keyed on
+ * the absolute path, size and modification time of the FT2 file.
+ * Copies share the underlying arrays.
+ */
+
+class LivetimeHistory {
+
+public:
+
+   LivetimeHistory();
+
+   LivetimeHistory(const LivetimeHistory & other);
+
+   LivetimeHistory & operator=(const LivetimeHistory & rhs);
+
+   ~LivetimeHistory();
+
+   /// Read the intervals from ft2file.
+   /// @param cacheDir Directory for livetime cache files.  If empty,
+   ///        no cache is used.
+   void readFt2File(const std::string & ft2file,
+                    const std::string & cacheDir="");
+
+   void clear();
+
+   size_t size() const;
+
+   bool empty() const {
+      return size() == 0;
+   }
+
+   double tmin() const;
+
+   double tmax() const;
+
+   double start(size_t i) const;
+
+   double stop(size_t i) const;
+
+   double livetimefrac(size_t i) const;
+
+   /// @return Index of the last interval with START <= met.  If met
+   ///         is not before start(hint), the search proceeds
+   ///         linearly from hint, so that successive calls with
+   ///         increasing times are fast.
+   /// @throw std::runtime_error if met lies outside [tmin, tmax].
+   size_t index(double met, size_t hint=0) const;
+
+   /// @return Name of the cache file for the current version of
+   ///         ft2file in cacheDir.
+   static std::string cacheFile(const std::string & ft2file,
+                                const std::string & cacheDir);
+
+private:
+
+   class Data;
+
+   Data * m_data;
+
+   void acquire();
+
+   void release();
+
+   void readFits(const std::string & ft2file);
+
+   /// @return true if cachefile exists, matches ft2file, and was mapped.
+   bool mapCache(const std::string & cachefile, const std::string & ft2file);
+
+   void writeCache(const std::string & cachefile,
+                   const std::string & ft2file) const;
+
+};
+
+} // namespace irfInterface
+
+#endif // irfInterface_LivetimeHistory_h
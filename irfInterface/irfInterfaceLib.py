@@ -7,6 +7,7 @@ def generate(env, **kw):
         env.Tool('addLibrary', library=['irfInterface'])
     env.Tool('astroLib')
     env.Tool('st_facilitiesLib')
+    env.Tool('tipLib')
 
 def exists(env):
     return 1
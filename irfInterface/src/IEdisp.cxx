@@ -18,8 +18,14 @@
 #include "st_facilities/GaussianQuadrature.h"
 
 #include "irfInterface/IEdisp.h"
+#include "irfInterface/Instrumentation.h"
 
 namespace {
+   irfInterface::Counter s_appEnergyCalls("IEdisp::appEnergy/calls");
+   irfInterface::Counter s_integralCalls("IEdisp::integral/calls");
+   irfInterface::Counter s_quadratureCalls("dgaus8/calls");
+   irfInterface::Counter s_quadratureTime("dgaus8/seconds");
+
    void fill_energies(double emin, double emax, size_t nee,
                       std::vector<double> & energies) {
       energies.clear();
@@ -58,13 +64,12 @@ double IEdisp::appEnergy(double energy,
                          const astro::SkyDir & scXAxis,
                          double time) const {
    (void)(scXAxis);
+   s_appEnergyCalls.add();
    double theta(srcDir.difference(scZAxis)*180./M_PI);
    double phi(0);
    double emin(energy/10.);
    double emax(energy*10.);
-   size_t nee(200);
-//    size_t nee(1000);
-//    size_t nee(2000);
+   size_t nee(Accuracy::npts(m_accuracy, 200));
    std::vector<double> energies;
    ::fill_energies(emin, emax, nee, energies);
    
@@ -97,6 +102,7 @@ double IEdisp::integral(double emin, double emax, double energy,
                         const astro::SkyDir & scZAxis,
                         const astro::SkyDir & scXAxis, double time) const {
    (void)(scXAxis);
+   s_integralCalls.add();
    double theta(srcDir.difference(scZAxis)*180./M_PI);
    double phi(0);
    EdispIntegrand func(*this, energy, theta, phi, time);
@@ -105,6 +111,7 @@ double IEdisp::integral(double emin, double emax, double energy,
 
 double IEdisp::integral(double emin, double emax, double energy,
                         double theta, double phi, double time) const {
+   s_integralCalls.add();
    EdispIntegrand func(*this, energy, theta, phi, time);
    double value(0);
    try {
@@ -135,11 +142,13 @@ double IEdisp::meanAppEnergy(double energy, double theta, double phi,
    double integral;
    double emin(0);
    double emax(energy*10.);
-   double err(1e-5);
+   double err(Accuracy::tolerance(m_accuracy, 1e-5));
    int ierr(0);
 
    MeanEnergyIntegrand func(*this, energy, theta, phi, time);
 
+   s_quadratureCalls.add(2);
+   irfInterface::ScopedTimer timer(s_quadratureTime);
    integral = 
       st_facilities::GaussianQuadrature::dgaus8(func, emin, emax, err, ierr);
                                                 
@@ -169,10 +178,12 @@ double IEdisp::meanTrueEnergy(double appEnergy, double theta, double phi,
 //   double emin(0);
    double emin(30);
    double emax(std::min(1.76e5, appEnergy*10.));
-   double err(1e-5);
+   double err(Accuracy::tolerance(m_accuracy, 1e-5));
    int ierr(0);
 
    MeanTrueEnergyIntegrand func(*this, appEnergy, theta, phi, time);
+   s_quadratureCalls.add(2);
+   irfInterface::ScopedTimer timer(s_quadratureTime);
    integral = 
       st_facilities::GaussianQuadrature::dgaus8(func, emin, emax, err, ierr);
 
@@ -187,7 +198,7 @@ double IEdisp::meanTrueEnergy(double appEnergy, double theta, double phi,
 
 double IEdisp::adhocIntegrator(const EdispIntegrand & func, 
                                double emin, double emax) const {
-   double err(1e-7);
+   double err(Accuracy::tolerance(m_accuracy, 1e-7));
    double integral(0);
    try {
       integral = accuracyKluge(func, emin, emax, err);
@@ -215,6 +226,8 @@ double IEdisp::accuracyKluge(const EdispIntegrand & func,
    double integral;
    int ier;
    double factor(1e3);
+   s_quadratureCalls.add();
+   irfInterface::ScopedTimer timer(s_quadratureTime);
    try {
       integral = st_facilities::GaussianQuadrature::dgaus8(func, emin, emax, 
                                                            err, ier);
@@ -223,6 +236,7 @@ double IEdisp::accuracyKluge(const EdispIntegrand & func,
          throw;
       }
       err *= factor;
+      s_quadratureCalls.add();
       integral = st_facilities::GaussianQuadrature::dgaus8(func, emin, emax,
                                                            err, ier);
    }
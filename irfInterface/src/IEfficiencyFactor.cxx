@@ -9,6 +9,7 @@
  */
 
 #include <cmath>
+#include <cstdlib>
 
 #include <algorithm>
 #include <iostream>
@@ -16,9 +17,6 @@
 
 #include "facilities/Util.h"
 
-#include "tip/IFileSvc.h"
-#include "tip/Table.h"
-
 #include "st_facilities/Util.h"
 
 #include "irfInterface/IEfficiencyFactor.h"
@@ -36,25 +34,35 @@ double IEfficiencyFactor::value(double energy, double livetimefrac,
            value(energy, livetimefrac, false, met))/2.;
 }
 
+void IEfficiencyFactor::getValues(const std::vector<double> & energy,
+                                  const std::vector<double> & met,
+                                  std::vector<double> & values) const {
+   if (energy.size() != met.size()) {
+      throw std::invalid_argument("IEfficiencyFactor::getValues: "
+                                  "energy and met sizes differ.");
+   }
+   values.resize(energy.size());
+   if (m_ltHistory.empty() || ::getenv("OMIT_EFFICIENCY_FACTOR")) {
+      for (size_t i(0); i < energy.size(); i++) {
+         values[i] = operator()(energy[i], met[i]);
+      }
+      return;
+   }
+   size_t indx(0);
+   for (size_t i(0); i < energy.size(); i++) {
+      indx = m_ltHistory.index(met[i], indx);
+      values[i] = value(energy[i], m_ltHistory.livetimefrac(indx), met[i]);
+   }
+}
+
 void IEfficiencyFactor::readFt2File(std::string ft2file) {
    facilities::Util::expandEnvVar(&ft2file);
-   const tip::Table * scData = 
-      tip::IFileSvc::instance().readTable(ft2file, "SC_DATA");
-   tip::Table::ConstIterator it(scData->begin());
-   tip::ConstTableRecord & row(*it);
-   for ( ; it != scData->end(); ++it) {
-      m_start.push_back(row["START"].get());
-      m_stop.push_back(row["STOP"].get());
-      double duration(m_stop.back() - m_start.back());
-      m_livetimefrac.push_back(row["livetime"].get()/duration);
-   }
-   delete scData;
+   char * cacheDir(::getenv("LIVETIME_CACHE_DIR"));
+   m_ltHistory.readFt2File(ft2file, cacheDir ? cacheDir : "");
 }
 
 void IEfficiencyFactor::clearFt2Data() {
-   m_start.clear();
-   m_stop.clear();
-   m_livetimefrac.clear();
+   m_ltHistory.clear();
 }
 
 } // namespace irfInterface
@@ -10,6 +10,10 @@
 #include <cmath>
 #include <algorithm>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "CLHEP/Random/RandFlat.h"
 #include "CLHEP/Geometry/Vector3D.h"
 
@@ -20,6 +24,69 @@
 
 #include "irfInterface/AcceptanceCone.h"
 #include "irfInterface/IPsf.h"
+#include "irfInterface/Instrumentation.h"
+
+namespace {
+   irfInterface::Counter s_appDirCalls("IPsf::appDir/calls");
+   irfInterface::Counter s_angularIntegralCalls("IPsf::angularIntegral/calls");
+   irfInterface::Counter 
+   s_angularContainmentCalls("IPsf::angularContainment/calls");
+   irfInterface::Counter s_integrandEvals("IPsf/integrand evaluations");
+   irfInterface::Counter s_quadratureCalls("dgaus8/calls");
+   irfInterface::Counter s_quadratureTime("dgaus8/seconds");
+
+   /// Scoped lock for the static integrand variables used with the
+   /// non-reentrant SLATEC routine, which is only called if the
+   /// reentrant dgaus8 template fails, when IPsf objects are used on
+   /// several OpenMP threads.
+   class StaticsLock {
+   public:
+      StaticsLock() {
+#ifdef _OPENMP
+         omp_set_nest_lock(lock());
+#endif
+      }
+      ~StaticsLock() {
+#ifdef _OPENMP
+         omp_unset_nest_lock(lock());
+#endif
+      }
+   private:
+#ifdef _OPENMP
+      class NestLock {
+      public:
+         NestLock() {
+            omp_init_nest_lock(&m_lock);
+         }
+         ~NestLock() {
+            omp_destroy_nest_lock(&m_lock);
+         }
+         omp_nest_lock_t m_lock;
+      };
+      static omp_nest_lock_t * lock() {
+         static NestLock s_lock;
+         return &s_lock.m_lock;
+      }
+#endif
+   };
+
+   template <typename Functor>
+   double integrate(const Functor & func, double a, double b, double err) {
+      int ierr(0);
+      s_quadratureCalls.add();
+      irfInterface::ScopedTimer timer(s_quadratureTime);
+      return st_facilities::GaussianQuadrature::dgaus8(func, a, b, err, ierr);
+   }
+
+   double integrate(double (*func)(double *), double a, double b,
+                    double err) {
+      long ierr(0);
+      s_quadratureCalls.add();
+      irfInterface::ScopedTimer timer(s_quadratureTime);
+      return st_facilities::GaussianQuadrature::integrate(func, a, b,
+                                                          err, ierr);
+   }
+}
 
 namespace irfInterface {
 
@@ -35,9 +102,14 @@ double IPsf::s_cr(0);
 
 std::vector<double> IPsf::s_psi_values;
 
-IPsf::IPsf() {
-   if (s_psi_values.size() == 0) {
-      fill_psi_values();
+IPsf::IPsf() : m_accuracy(Accuracy::DEFAULT) {
+#ifdef _OPENMP
+#pragma omp critical(irfInterface_IPsf_psi_values)
+#endif
+   {
+      if (s_psi_values.size() == 0) {
+         fill_psi_values();
+      }
    }
 }
 
@@ -70,8 +142,9 @@ astro::SkyDir IPsf::appDir(double energy,
 // Compute source inclination
    double theta(srcDir.difference(scZAxis)*180./M_PI);
 
-   static double phi(0);
-   setStaticVariables(energy, theta, phi, time, this);
+   double phi(0);
+   s_appDirCalls.add();
+   ConeIntegrand coneIntegrand(*this, energy, theta, phi, time);
 
    // Draw offset angle.
    double psi;
@@ -80,7 +153,7 @@ astro::SkyDir IPsf::appDir(double energy,
       std::vector<double> integrand;
       for (std::vector<double>::iterator psi_it(s_psi_values.begin());
            psi_it != s_psi_values.end(); ++psi_it) {
-         integrand.push_back(coneIntegrand(&(*psi_it)));
+         integrand.push_back(coneIntegrand(*psi_it));
       }
 
       std::vector<double> integralDist;
@@ -103,11 +176,11 @@ astro::SkyDir IPsf::appDir(double energy,
       std::vector<double> yy;
       std::vector<double> aa;
       std::vector<double> bb;
-      yy.push_back(coneIntegrand(&s_psi_values[0]));
+      yy.push_back(coneIntegrand(s_psi_values[0]));
       std::vector<double> integralDist;
       integralDist.push_back(0);
       for (size_t i(1); i < s_psi_values.size(); i++) {
-         yy.push_back(coneIntegrand(&s_psi_values[i]));
+         yy.push_back(coneIntegrand(s_psi_values[i]));
          aa.push_back((yy[i] - yy[i-1])/(xx[i] - xx[i-1]));
          bb.push_back(yy[i-1] - xx[i-1]*aa.back());
          double value(integralDist.back()
@@ -142,15 +215,17 @@ astro::SkyDir IPsf::appDir(double energy,
 
 double IPsf::angularIntegral(double energy, double theta, 
                              double phi, double radius, double time) const {
-   setStaticVariables(energy, theta, phi, time, this);
-   double integral;
-   double err(1e-5);
-   long ierr(0);
-   double zero(0);
-   integral = st_facilities::GaussianQuadrature::integrate(&coneIntegrand,
-                                                           zero, radius,
-                                                           err, ierr);
-   return integral;
+   s_angularIntegralCalls.add();
+   double err(Accuracy::tolerance(m_accuracy, 1e-5));
+   try {
+      return integrate(ConeIntegrand(*this, energy, theta, phi, time),
+                       0, radius, err);
+   } catch (st_facilities::GaussianQuadrature::dgaus8Exception &) {
+      // Return the best estimate of the SLATEC routine, as before.
+      StaticsLock lock;
+      setStaticVariables(energy, theta, phi, time, this);
+      return integrate(&coneIntegrand, 0, radius, err);
+   }
 }
 
 std::vector<double> IPsf::angularIntegral(const std::vector<double>& energy, 
@@ -179,8 +254,13 @@ void IPsf::setStaticVariables(double energy, double theta, double phi,
 }
 
 double IPsf::coneIntegrand(double * offset) {
-   return s_self->value(*offset, s_energy, s_theta, s_phi, s_time)
-      *std::sin(*offset*M_PI/180.)*2.*M_PI*M_PI/180.;
+   return ConeIntegrand(*s_self, s_energy, s_theta, s_phi, s_time)(*offset);
+}
+
+double IPsf::ConeIntegrand::operator()(double offset) const {
+   s_integrandEvals.add();
+   return m_psf.value(offset, m_energy, m_theta, m_phi, m_time)
+      *std::sin(offset*M_PI/180.)*2.*M_PI*M_PI/180.;
 }
 
 void IPsf::fill_psi_values() {
@@ -216,6 +296,7 @@ double IPsf::angularIntegral(double energy,
 
 double IPsf::angularContainment(double energy, double theta, double phi, 
 				double frac, double time, double rtol) const {
+  s_angularContainmentCalls.add();
   double fmax = angularIntegral(energy,theta,phi,180.);
   IntegralFunctor fn = IntegralFunctor(*this, energy, theta, phi, time);
   return st_facilities::RootFinder::find_root(fn, 0.0, 180.0, frac*fmax, rtol);
@@ -260,7 +341,7 @@ double IPsf::psfIntegral(IPsf * self,
                          const std::vector<irfInterface::AcceptanceCone *> 
                          & acceptanceCones,
                          double time) {
-   setStaticVariables(energy, theta, phi, time, self);
+   s_angularIntegralCalls.add();
    
    const irfInterface::AcceptanceCone & roiCone(*acceptanceCones.front());
    double roi_radius(roiCone.radius()*M_PI/180.);
@@ -270,37 +351,61 @@ double IPsf::psfIntegral(IPsf * self,
    double mup(std::cos(roi_radius + psi));
    double mum(std::cos(roi_radius - psi));
    
-   s_cp = std::cos(psi);
-   s_sp = std::sin(psi);
-   s_cr = std::cos(roi_radius);
+   double cp(std::cos(psi));
+   double sp(std::sin(psi));
+   double cr(std::cos(roi_radius));
 
-   double err(1e-5);
-   long ierr(0);
+   double err(Accuracy::tolerance(self->accuracy(), 1e-5));
+
+   PsfIntegrand1 integrand1(*self, energy, theta, phi, time);
+   PsfIntegrand2 integrand2(*self, energy, theta, phi, time, cp, sp, cr);
 
    double firstIntegral(0);
    if (mum < 0.99) {
-      firstIntegral = 
-         st_facilities::GaussianQuadrature::integrate(&psfIntegrand1, mum, 
-                                                      one, err, ierr);
+      try {
+         firstIntegral = integrate(integrand1, mum, one, err);
+      } catch (st_facilities::GaussianQuadrature::dgaus8Exception &) {
+         StaticsLock lock;
+         setStaticVariables(energy, theta, phi, time, self);
+         firstIntegral = integrate(&psfIntegrand1, mum, one, err);
+      }
    }
    
    double secondIntegral(0);
-   secondIntegral = 
-      st_facilities::GaussianQuadrature::integrate(&psfIntegrand2, mup, 
-                                                   mum, err, ierr);
+   try {
+      secondIntegral = integrate(integrand2, mup, mum, err);
+   } catch (st_facilities::GaussianQuadrature::dgaus8Exception &) {
+      StaticsLock lock;
+      setStaticVariables(energy, theta, phi, time, self);
+      s_cp = cp;
+      s_sp = sp;
+      s_cr = cr;
+      secondIntegral = integrate(&psfIntegrand2, mup, mum, err);
+   }
 
    return firstIntegral + secondIntegral;
 }
 
 double IPsf::psfIntegrand1(double * mu) {
-   double sep(std::acos(*mu)*180./M_PI);
-   return 2.*M_PI*s_self->value(sep, s_energy, s_theta, s_phi, s_time);
+   return PsfIntegrand1(*s_self, s_energy, s_theta, s_phi, s_time)(*mu);
 }
 
 double IPsf::psfIntegrand2(double * mu) {
-   double sep(std::acos(*mu)*180./M_PI);
+   return PsfIntegrand2(*s_self, s_energy, s_theta, s_phi, s_time,
+                        s_cp, s_sp, s_cr)(*mu);
+}
+
+double IPsf::PsfIntegrand1::operator()(double mu) const {
+   s_integrandEvals.add();
+   double sep(std::acos(mu)*180./M_PI);
+   return 2.*M_PI*m_psf.value(sep, m_energy, m_theta, m_phi, m_time);
+}
+
+double IPsf::PsfIntegrand2::operator()(double mu) const {
+   s_integrandEvals.add();
+   double sep(std::acos(mu)*180./M_PI);
    double phimin(0);
-   double arg((s_cr - *mu*s_cp)/std::sqrt(1. - *mu*(*mu))/s_sp);
+   double arg((m_cr - mu*m_cp)/std::sqrt(1. - mu*mu)/m_sp);
    if (arg >= 1.) {
       phimin = 0;
    } else if (arg <= -1.) {
@@ -308,7 +413,7 @@ double IPsf::psfIntegrand2(double * mu) {
    } else {
       phimin = std::acos(arg);
    }
-   return 2.*phimin*s_self->value(sep, s_energy, s_theta, s_phi, s_time);
+   return 2.*phimin*m_psf.value(sep, m_energy, m_theta, m_phi, m_time);
 }
 
 double IPsf::IntegralFunctor::operator()(double sep) const {
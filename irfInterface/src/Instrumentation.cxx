@@ -0,0 +1,113 @@
+/**
+ * @file Instrumentation.cxx
+ * @brief Registry of the instrumentation counters.
+ *
+ * @author J. Chiang
+ *
+ * $Header$
+ */
+
+#ifndef WIN32
+#include <sys/time.h>
+#endif
+
+#include <cstdlib>
+#include <ctime>
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+#include "irfInterface/Instrumentation.h"
+
+namespace {
+   /// The counters are file-scope statics in several translation
+   /// units, so the registry is constructed on first use.
+   std::vector<irfInterface::Counter *> & registry() {
+      static std::vector<irfInterface::Counter *> s_registry;
+      return s_registry;
+   }
+}
+
+namespace irfInterface {
+
+bool Instrumentation::s_enabled(::getenv("IRF_INSTRUMENTATION") != 0);
+
+Counter::Counter(const std::string & name) : m_name(name), m_value(0) {
+#ifdef _OPENMP
+#pragma omp critical(irfInterface_Instrumentation)
+#endif
+   registry().push_back(this);
+}
+
+Counter::~Counter() {
+#ifdef _OPENMP
+#pragma omp critical(irfInterface_Instrumentation)
+#endif
+   {
+      std::vector<Counter *> & counters(registry());
+      counters.erase(std::remove(counters.begin(), counters.end(), this),
+                     counters.end());
+   }
+}
+
+void Instrumentation::reset() {
+#ifdef _OPENMP
+#pragma omp critical(irfInterface_Instrumentation)
+#endif
+   {
+      std::vector<Counter *> & counters(registry());
+      for (size_t i(0); i < counters.size(); i++) {
+         counters[i]->reset();
+      }
+   }
+}
+
+std::map<std::string, double> Instrumentation::counters() {
+   std::map<std::string, double> values;
+#ifdef _OPENMP
+#pragma omp critical(irfInterface_Instrumentation)
+#endif
+   {
+      std::vector<Counter *> & counters(registry());
+      for (size_t i(0); i < counters.size(); i++) {
+         values[counters[i]->name()] += counters[i]->value();
+      }
+   }
+   return values;
+}
+
+double Instrumentation::counter(const std::string & name) {
+   std::map<std::string, double> values(counters());
+   std::map<std::string, double>::const_iterator it(values.find(name));
+   if (it == values.end()) {
+      return 0;
+   }
+   return it->second;
+}
+
+std::string Instrumentation::report() {
+   std::map<std::string, double> values(counters());
+   std::ostringstream output;
+   std::map<std::string, double>::const_iterator it(values.begin());
+   for ( ; it != values.end(); ++it) {
+      if (it->second != 0) {
+         output << std::left << std::setw(48) << it->first << " "
+                << it->second << "\n";
+      }
+   }
+   return output.str();
+}
+
+double Instrumentation::wallTime() {
+#ifndef WIN32
+   struct timeval tv;
+   ::gettimeofday(&tv, 0);
+   return tv.tv_sec + 1e-6*tv.tv_usec;
+#else
+   return static_cast<double>(std::clock())/CLOCKS_PER_SEC;
+#endif
+}
+
+} // namespace irfInterface
@@ -7,6 +7,7 @@
  * $Header$
  */
 
+#include <algorithm>
 #include <stdexcept>
 
 #include "irfInterface/IrfLoader.h"
@@ -41,8 +42,15 @@ registerEventClass(const std::string & name, const std::string & className) {
 
 void IrfRegistry::loadIrfs(const std::string & irfsName) {
    if (m_irfLoaders.find(irfsName) != m_irfLoaders.end()) {
-      m_irfLoaders[irfsName]->loadIrfs();
-      m_irfLoaders[irfsName]->registerEventClasses();
+      IrfLoader * loader(m_irfLoaders[irfsName]);
+      if (loader->deferrable()) {
+         if (!std::count(m_deferred.begin(), m_deferred.end(), loader)) {
+            m_deferred.push_back(loader);
+         }
+         return;
+      }
+      loader->loadIrfs();
+      loader->registerEventClasses();
    } else {
       throw std::runtime_error("IrfRegistry::loadIrfs: Cannot load IRFs named "
                                + irfsName);
@@ -61,6 +69,13 @@ std::vector<std::string> IrfRegistry::irfNames() const {
 const std::vector<std::string> & 
 IrfRegistry::operator[](const std::string & respName) const {
    std::map<std::string, std::vector<std::string> >::const_iterator it;
+   if (m_respIds.find(respName) == m_respIds.end()) {
+      for (size_t i(0); i < m_deferred.size(); i++) {
+         if (m_deferred[i]->resolveEventClasses(respName)) {
+            break;
+         }
+      }
+   }
    if ((it = m_respIds.find(respName)) == m_respIds.end()) {
       throw std::runtime_error("IrfRegistry: Cannot find response named " 
                                + respName);
@@ -68,4 +83,32 @@ IrfRegistry::operator[](const std::string & respName) const {
    return it->second;
 }
 
+const std::map<std::string, std::vector<std::string> > & 
+IrfRegistry::respIds() const {
+   for (size_t i(0); i < m_deferred.size(); i++) {
+      IrfLoader * loader(m_deferred[i]);
+      if (!std::count(m_registered.begin(), m_registered.end(), loader)) {
+         loader->registerEventClasses();
+         m_registered.push_back(loader);
+      }
+   }
+   return m_respIds;
+}
+
+bool IrfRegistry::resolveIrfs(const std::string & irfsName) const {
+   for (size_t i(0); i < m_deferred.size(); i++) {
+      if (m_deferred[i]->resolveIrfs(irfsName)) {
+         return true;
+      }
+   }
+   return false;
+}
+
+void IrfRegistry::getDeferredIrfsNames(std::vector<std::string> & names,
+                                       size_t & nloaders) const {
+   for ( ; nloaders < m_deferred.size(); nloaders++) {
+      m_deferred[nloaders]->getIrfsNames(names);
+   }
+}
+
 } // namespace irfInterface
@@ -6,10 +6,11 @@
  * $Header$
  */
 
-#include <algorithm>
 #include <iostream>
 #include <stdexcept>
 
+#include "irfInterface/IrfRegistry.h"
+
 #define ST_DLL_EXPORTS
 #include "irfInterface/IrfsFactory.h"
 #undef ST_DLL_EXPORTS
@@ -36,17 +37,23 @@ IrfsFactory::~IrfsFactory() {
       delete itor->second;
    }
    m_irfNames.clear();
+   m_irfIndex.clear();
 }
 
 Irfs * IrfsFactory::create(const std::string & name) const {
    std::map<std::string, Irfs *>::const_iterator itor 
       = m_prototypes.find(name);
+   if (itor == m_prototypes.end() 
+       && IrfRegistry::instance().resolveIrfs(name)) {
+      itor = m_prototypes.find(name);
+   }
    if (itor == m_prototypes.end()) {
       std::string message("irfInterface::IrfsFactory::create: ");
       message += "Cannot create Irfs object named " + name + ".\n";
       message += "Valid names are\n";
-      for (itor = m_prototypes.begin(); itor != m_prototypes.end(); ++itor) {
-         message += itor->first + "\n";
+      const std::vector<std::string> & names(irfNames());
+      for (size_t i(0); i < names.size(); i++) {
+         message += names[i] + "\n";
       }
       throw std::invalid_argument(message);
    } 
@@ -55,21 +62,52 @@ Irfs * IrfsFactory::create(const std::string & name) const {
 
 void IrfsFactory::addIrfs(const std::string & name, Irfs * irfs, 
                           bool verbose) {
-   if (m_prototypes.count(name) && verbose) {
-      std::cerr << "irfInterface::IrfsFactory::addIrfs: "
-                << "An Irfs object named " + name 
-                << " already exists and is being replaced."
-                << std::endl;
-      delete m_prototypes[name];
+   std::pair<std::map<std::string, Irfs *>::iterator, bool> 
+      result(m_prototypes.insert(std::make_pair(name, irfs)));
+   if (!result.second) {
+      if (verbose) {
+         std::cerr << "irfInterface::IrfsFactory::addIrfs: "
+                   << "An Irfs object named " + name 
+                   << " already exists and is being replaced."
+                   << std::endl;
+      }
+      if (result.first->second != irfs) {
+         delete result.first->second;
+      }
+      result.first->second = irfs;
+   }
+   addIrfsName(name);
+}
+
+void IrfsFactory::addIrfs(const std::vector<std::string> & names,
+                          const std::vector<Irfs *> & irfs, bool verbose) {
+   if (names.size() != irfs.size()) {
+      throw std::invalid_argument("irfInterface::IrfsFactory::addIrfs: "
+                                  "numbers of names and Irfs differ.");
    }
-   m_prototypes[name] = irfs;
-   if (!std::count(m_irfNames.begin(), m_irfNames.end(), name)) {
+   m_irfNames.reserve(m_irfNames.size() + names.size());
+   for (size_t i(0); i < names.size(); i++) {
+      addIrfs(names[i], irfs[i], verbose);
+   }
+}
+
+void IrfsFactory::addIrfsName(const std::string & name) const {
+   if (m_irfIndex.insert(name).second) {
       m_irfNames.push_back(name);
    }
 }
 
+const std::vector<std::string> & IrfsFactory::irfNames() const {
+   std::vector<std::string> deferred;
+   IrfRegistry::instance().getDeferredIrfsNames(deferred, m_numDeferred);
+   for (size_t i(0); i < deferred.size(); i++) {
+      addIrfsName(deferred[i]);
+   }
+   return m_irfNames;
+}
+
 void IrfsFactory::getIrfsNames(std::vector<std::string> & names) const {
-   names = m_irfNames;
+   names = irfNames();
 //    names.clear();
 //    std::map<std::string, Irfs *>::const_iterator itor = m_prototypes.begin();
 //    for (; itor != m_prototypes.end(); ++itor) {
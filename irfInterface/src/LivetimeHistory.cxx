@@ -0,0 +1,395 @@
+/**
+ * @file LivetimeHistory.cxx
+ * @brief FT2 livetime reader and memory-mapped livetime cache.
+ *
+ * @author J. Chiang
+ *
+ * $Header$
+ */
+
+#include <limits.h>
+#include <stdint.h>
+#include <sys/stat.h>
+#ifndef WIN32
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <cstdio>
+#include <cstring>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#include "tip/IFileSvc.h"
+#include "tip/Table.h"
+
+#include "irfInterface/LivetimeHistory.h"
+
+namespace {
+   const char s_magic[8] = {'L', 'T', 'C', 'A', 'C', 'H', 'E', '\0'};
+   const uint32_t s_version(2);
+   const uint32_t s_byteOrderMark(0x01020304);
+
+   /// Header of a livetime cache file.  The START, STOP and
+   /// livetime fraction arrays follow, each of length nrows.
+   struct CacheHeader {
+      char magic[8];
+      uint32_t version;
+      uint32_t byteOrderMark;
+      uint64_t pathHash;
+      int64_t mtime;
+      int64_t size;
+      uint64_t nrows;
+   };
+
+   bool fileStamp(const std::string & filename, int64_t & mtime,
+                  int64_t & size) {
+      struct stat info;
+      if (::stat(filename.c_str(), &info) != 0) {
+         return false;
+      }
+      mtime = static_cast<int64_t>(info.st_mtime);
+      size = static_cast<int64_t>(info.st_size);
+      return true;
+   }
+
+   std::string absolutePath(const std::string & filename) {
+#ifndef WIN32
+      char path[PATH_MAX];
+      if (::realpath(filename.c_str(), path)) {
+         return path;
+      }
+#endif
+      return filename;
+   }
+
+   /// FNV-1a hash of text, continuing from hash.
+   uint64_t fnv1a(const std::string & text,
+                  uint64_t hash=14695981039346656037ULL) {
+      for (size_t i(0); i < text.size(); i++) {
+         hash ^= static_cast<unsigned char>(text[i]);
+         hash *= 1099511628211ULL;
+      }
+      return hash;
+   }
+
+   uint64_t pathHash(const std::string & filename) {
+      return fnv1a(absolutePath(filename));
+   }
+}
+
+namespace irfInterface {
+
+/**
+ * @class LivetimeHistory::Data
+ * @brief Reference-counted arrays, held either in vectors or in a
+ * mapped cache file.
+ */
+
+class LivetimeHistory::Data {
+public:
+   Data() : refs(1), nrows(0), start(0), stop(0), ltfrac(0),
+            mapping(0), mapLength(0) {}
+   ~Data() {
+#ifndef WIN32
+      if (mapping) {
+         ::munmap(mapping, mapLength);
+      }
+#endif
+   }
+   void setPointers() {
+      nrows = m_start.size();
+      start = nrows ? &m_start[0] : 0;
+      stop = nrows ? &m_stop[0] : 0;
+      ltfrac = nrows ? &m_ltfrac[0] : 0;
+   }
+   int refs;
+   size_t nrows;
+   const double * start;
+   const double * stop;
+   const double * ltfrac;
+   std::vector<double> m_start;
+   std::vector<double> m_stop;
+   std::vector<double> m_ltfrac;
+   void * mapping;
+   size_t mapLength;
+};
+
+LivetimeHistory::LivetimeHistory() : m_data(0) {}
+
+LivetimeHistory::LivetimeHistory(const LivetimeHistory & other)
+   : m_data(other.m_data) {
+   acquire();
+}
+
+LivetimeHistory & LivetimeHistory::operator=(const LivetimeHistory & rhs) {
+   if (m_data != rhs.m_data) {
+      release();
+      m_data = rhs.m_data;
+      acquire();
+   }
+   return *this;
+}
+
+LivetimeHistory::~LivetimeHistory() {
+   release();
+}
+
+// Copies of an IEfficiencyFactor may be made and destroyed on
+// different threads, so the reference count is only changed inside a
+// critical section.
+
+void LivetimeHistory::acquire() {
+   if (m_data) {
+#pragma omp critical(irfInterface_LivetimeHistory_refs)
+      m_data->refs++;
+   }
+}
+
+void LivetimeHistory::release() {
+   if (m_data) {
+      int refs;
+#pragma omp critical(irfInterface_LivetimeHistory_refs)
+      refs = --m_data->refs;
+      if (refs == 0) {
+         delete m_data;
+      }
+   }
+   m_data = 0;
+}
+
+void LivetimeHistory::clear() {
+   release();
+}
+
+size_t LivetimeHistory::size() const {
+   return m_data ? m_data->nrows : 0;
+}
+
+double LivetimeHistory::tmin() const {
+   return start(0);
+}
+
+double LivetimeHistory::tmax() const {
+   return stop(size() - 1);
+}
+
+double LivetimeHistory::start(size_t i) const {
+   if (i >= size()) {
+      throw std::out_of_range("irfInterface::LivetimeHistory::start");
+   }
+   return m_data->start[i];
+}
+
+double LivetimeHistory::stop(size_t i) const {
+   if (i >= size()) {
+      throw std::out_of_range("irfInterface::LivetimeHistory::stop");
+   }
+   return m_data->stop[i];
+}
+
+double LivetimeHistory::livetimefrac(size_t i) const {
+   if (i >= size()) {
+      throw std::out_of_range("irfInterface::LivetimeHistory::livetimefrac");
+   }
+   return m_data->ltfrac[i];
+}
+
+size_t LivetimeHistory::index(double met, size_t hint) const {
+   if (empty()) {
+      throw std::runtime_error("irfInterface::LivetimeHistory::index: "
+                               "no FT2 data have been read.");
+   }
+   const double * start(m_data->start);
+   size_t nrows(m_data->nrows);
+   if (met < start[0] || met > m_data->stop[nrows - 1]) {
+      std::ostringstream message;
+      message << "Requested MET of " << met << " "
+              << "lies outside the range of valid times in the "
+              << "pointing/livetime history: "
+              << start[0] << " to " << m_data->stop[nrows - 1] << "MET s";
+      throw std::runtime_error(message.str());
+   }
+   size_t first(0);
+   if (hint < nrows && start[hint] <= met) {
+      // Walk forward a few intervals before resorting to a search
+      // of the remainder of the list.
+      size_t i(hint);
+      for (size_t step(0); step < 8; step++, i++) {
+         if (i + 1 == nrows || start[i + 1] > met) {
+            return i;
+         }
+      }
+      first = i;
+   }
+   return std::upper_bound(start + first, start + nrows, met) - start - 1;
+}
+
+std::string LivetimeHistory::cacheFile(const std::string & ft2file,
+                                       const std::string & cacheDir) {
+   // Files with the same name in different directories, or a file
+   // that has been replaced, get different cache files.
+   uint64_t hash(pathHash(ft2file));
+   int64_t mtime(0), size(0);
+   if (fileStamp(ft2file, mtime, size)) {
+      std::ostringstream stamp;
+      stamp << mtime << ":" << size;
+      hash = fnv1a(stamp.str(), hash);
+   }
+   std::string basename(ft2file.substr(ft2file.find_last_of("/") + 1));
+   std::ostringstream cachefile;
+   cachefile << cacheDir << "/" << basename << "."
+             << std::hex << std::setw(16) << std::setfill('0') << hash
+             << ".ltcache";
+   return cachefile.str();
+}
+
+void LivetimeHistory::readFt2File(const std::string & ft2file,
+                                  const std::string & cacheDir) {
+   release();
+   if (cacheDir == "") {
+      readFits(ft2file);
+      return;
+   }
+   std::string cachefile(cacheFile(ft2file, cacheDir));
+   if (mapCache(cachefile, ft2file)) {
+      return;
+   }
+   readFits(ft2file);
+   try {
+      writeCache(cachefile, ft2file);
+   } catch (std::exception &) {
+      // The cache is an optimization, so proceed without it.
+   }
+}
+
+void LivetimeHistory::readFits(const std::string & ft2file) {
+   const tip::Table * scData(tip::IFileSvc::instance().readTable(ft2file,
+                                                                 "SC_DATA"));
+   Data * data(new Data());
+   try {
+      size_t nrows(scData->getNumRecords());
+      data->m_start.reserve(nrows);
+      data->m_stop.reserve(nrows);
+      data->m_ltfrac.reserve(nrows);
+      // tip has no multi-row column reads, so the rows are read one
+      // at a time.  A cache file avoids doing this again for the same
+      // FT2 file.
+      double start, stop, livetime;
+      tip::Table::ConstIterator it(scData->begin());
+      tip::ConstTableRecord & row(*it);
+      for ( ; it != scData->end(); ++it) {
+         row["START"].get(start);
+         row["STOP"].get(stop);
+         row["LIVETIME"].get(livetime);
+         data->m_start.push_back(start);
+         data->m_stop.push_back(stop);
+         data->m_ltfrac.push_back(livetime/(stop - start));
+      }
+   } catch (...) {
+      delete data;
+      delete scData;
+      throw;
+   }
+   delete scData;
+   data->setPointers();
+   m_data = data;
+}
+
+bool LivetimeHistory::mapCache(const std::string & cachefile,
+                               const std::string & ft2file) {
+#ifndef WIN32
+   int64_t mtime, size;
+   if (!fileStamp(ft2file, mtime, size)) {
+      return false;
+   }
+   int fd(::open(cachefile.c_str(), O_RDONLY));
+   if (fd < 0) {
+      return false;
+   }
+   struct stat info;
+   if (::fstat(fd, &info) != 0
+       || static_cast<size_t>(info.st_size) < sizeof(CacheHeader)) {
+      ::close(fd);
+      return false;
+   }
+   size_t length(static_cast<size_t>(info.st_size));
+   void * address(::mmap(0, length, PROT_READ, MAP_SHARED, fd, 0));
+   ::close(fd);
+   if (address == MAP_FAILED) {
+      return false;
+   }
+   const CacheHeader * header(static_cast<const CacheHeader *>(address));
+   bool valid(std::memcmp(header->magic, s_magic, sizeof(s_magic)) == 0
+              && header->version == s_version
+              && header->byteOrderMark == s_byteOrderMark
+              && header->pathHash == pathHash(ft2file)
+              && header->mtime == mtime && header->size == size
+              && length == sizeof(CacheHeader)
+              + 3*header->nrows*sizeof(double));
+   if (!valid) {
+      ::munmap(address, length);
+      return false;
+   }
+   Data * data(new Data());
+   data->mapping = address;
+   data->mapLength = length;
+   data->nrows = static_cast<size_t>(header->nrows);
+   const double * arrays(reinterpret_cast<const double *>(header + 1));
+   data->start = arrays;
+   data->stop = arrays + data->nrows;
+   data->ltfrac = arrays + 2*data->nrows;
+   m_data = data;
+   return true;
+#else
+   (void)(cachefile);
+   (void)(ft2file);
+   return false;
+#endif
+}
+
+void LivetimeHistory::writeCache(const std::string & cachefile,
+                                 const std::string & ft2file) const {
+#ifndef WIN32
+   CacheHeader header;
+   std::memcpy(header.magic, s_magic, sizeof(s_magic));
+   header.version = s_version;
+   header.byteOrderMark = s_byteOrderMark;
+   header.pathHash = pathHash(ft2file);
+   if (!fileStamp(ft2file, header.mtime, header.size)) {
+      return;
+   }
+   header.nrows = size();
+
+   // Write to a temporary file and rename it so that other processes
+   // never map a partially written cache.
+   std::ostringstream tmpfile;
+   tmpfile << cachefile << "." << ::getpid() << ".tmp";
+   std::ofstream output(tmpfile.str().c_str(),
+                        std::ios::out | std::ios::binary);
+   if (!output) {
+      return;
+   }
+   output.write(reinterpret_cast<const char *>(&header), sizeof(header));
+   const double * arrays[] = {m_data->start, m_data->stop, m_data->ltfrac};
+   for (size_t i(0); i < 3; i++) {
+      output.write(reinterpret_cast<const char *>(arrays[i]),
+                   size()*sizeof(double));
+   }
+   output.close();
+   if (!output || std::rename(tmpfile.str().c_str(), cachefile.c_str())) {
+      std::remove(tmpfile.str().c_str());
+   }
+#else
+   (void)(cachefile);
+   (void)(ft2file);
+#endif
+}
+
+} // namespace irfInterface
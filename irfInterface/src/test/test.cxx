@@ -10,9 +10,16 @@
 #include <fenv.h>
 #endif
 
+#include <sys/stat.h>
+
+#include <cmath>
+#include <cstdio>
+
 #include <algorithm>
 #include <stdexcept>
 
+#include "fitsio.h"
+
 #include <cppunit/ui/text/TextTestRunner.h>
 #include <cppunit/extensions/HelperMacros.h>
 
@@ -21,7 +28,9 @@
 #include "astro/SkyDir.h"
 
 #include "irfInterface/AcceptanceCone.h"
+#include "irfInterface/Instrumentation.h"
 #include "irfInterface/IrfsFactory.h"
+#include "irfInterface/LivetimeHistory.h"
 
 #include "Aeff.h"
 #include "Psf.h"
@@ -30,6 +39,32 @@
 
 using namespace irfInterface;
 
+namespace {
+   void writeFt2File(const std::string & ft2file,
+                     std::vector<double> & start,
+                     std::vector<double> & stop,
+                     std::vector<double> & livetime) {
+      std::remove(ft2file.c_str());
+      int status(0);
+      fitsfile * fptr(0);
+      fits_create_file(&fptr, ft2file.c_str(), &status);
+      char * ttype[] = {const_cast<char *>("START"),
+                        const_cast<char *>("STOP"),
+                        const_cast<char *>("LIVETIME")};
+      char * tform[] = {const_cast<char *>("D"), const_cast<char *>("D"),
+                        const_cast<char *>("D")};
+      fits_create_tbl(fptr, BINARY_TBL, 0, 3, ttype, tform, 0,
+                      const_cast<char *>("SC_DATA"), &status);
+      fits_write_col(fptr, TDOUBLE, 1, 1, 1, start.size(), &start[0],
+                     &status);
+      fits_write_col(fptr, TDOUBLE, 2, 1, 1, stop.size(), &stop[0], &status);
+      fits_write_col(fptr, TDOUBLE, 3, 1, 1, livetime.size(), &livetime[0],
+                     &status);
+      fits_close_file(fptr, &status);
+      CPPUNIT_ASSERT(status == 0);
+   }
+}
+
 class irfInterfaceTests : public CppUnit::TestFixture {
 
    CPPUNIT_TEST_SUITE(irfInterfaceTests);
@@ -38,10 +73,14 @@ class irfInterfaceTests : public CppUnit::TestFixture {
    CPPUNIT_TEST(test_create);
    CPPUNIT_TEST_EXCEPTION(test_creation_failure, std::invalid_argument);
    CPPUNIT_TEST(test_getIrfsNames);
+   CPPUNIT_TEST(test_addIrfs_bulk);
    CPPUNIT_TEST(psf_normalization);
    CPPUNIT_TEST(psf_integral);
    CPPUNIT_TEST(edisp_normalization);
    CPPUNIT_TEST(test_IrfRegistry);
+   CPPUNIT_TEST(test_LivetimeHistory);
+   CPPUNIT_TEST(test_Instrumentation);
+   CPPUNIT_TEST(test_Accuracy);
 
    CPPUNIT_TEST_SUITE_END();
 
@@ -54,10 +93,14 @@ public:
    void test_create();
    void test_creation_failure();
    void test_getIrfsNames();
+   void test_addIrfs_bulk();
    void psf_normalization();
    void psf_integral();
    void edisp_normalization();
    void test_IrfRegistry();
+   void test_LivetimeHistory();
+   void test_Instrumentation();
+   void test_Accuracy();
 
 private:
 
@@ -116,6 +159,26 @@ void irfInterfaceTests::test_getIrfsNames() {
    }
 }
 
+void irfInterfaceTests::test_addIrfs_bulk() {
+   std::vector<Irfs *> irfs;
+   for (unsigned int i = 0; i < m_irfNames.size(); i++) {
+      irfs.push_back(m_irfs[m_irfNames[i]]->clone());
+   }
+   m_irfsFactory->addIrfs(m_irfNames, irfs);
+// Re-adding replaces the prototypes without duplicating the names.
+   m_irfsFactory->addIrfs(m_irfNames.front(), 
+                          m_irfs[m_irfNames.front()]->clone());
+   std::vector<std::string> names;
+   m_irfsFactory->getIrfsNames(names);
+   CPPUNIT_ASSERT(names == m_irfNames);
+   for (unsigned int i = 0; i < m_irfNames.size(); i++) {
+      CPPUNIT_ASSERT(m_irfsFactory->hasIrfs(m_irfNames[i]));
+      Irfs * my_irfs = m_irfsFactory->create(m_irfNames[i]);
+      CPPUNIT_ASSERT(my_irfs->irfID() == static_cast<int>(i));
+      delete my_irfs;
+   }
+}
+
 void irfInterfaceTests::psf_normalization() {
    double energy(100);
    double theta(0);
@@ -192,6 +255,141 @@ void irfInterfaceTests::test_IrfRegistry() {
    }
 }
 
+void irfInterfaceTests::test_LivetimeHistory() {
+// Write a small FT2 file with 30 s intervals, a gap after the fifth
+// interval, and livetime fractions of i/100.
+   std::string ft2file("test_livetime_ft2.fits");
+   size_t nrows(10);
+   std::vector<double> start, stop, livetime;
+   for (size_t i(0); i < nrows; i++) {
+      start.push_back(100. + 30.*i + (i > 4 ? 50. : 0));
+      stop.push_back(start.back() + 30.);
+      livetime.push_back(30.*i/100.);
+   }
+   writeFt2File(ft2file, start, stop, livetime);
+
+// Read it directly, then twice using the cache in the current directory.
+   for (size_t k(0); k < 3; k++) {
+      LivetimeHistory history;
+      history.readFt2File(ft2file, k == 0 ? "" : ".");
+      CPPUNIT_ASSERT(history.size() == nrows);
+      CPPUNIT_ASSERT(history.tmin() == start.front());
+      CPPUNIT_ASSERT(history.tmax() == stop.back());
+      size_t indx(0);
+      for (size_t i(0); i < nrows; i++) {
+         indx = history.index(start[i] + 15., indx);
+         CPPUNIT_ASSERT(indx == i);
+         CPPUNIT_ASSERT(std::fabs(history.livetimefrac(i) - i/100.) < 1e-12);
+      }
+// A time in the gap is assigned to the preceding interval.
+      CPPUNIT_ASSERT(history.index(stop[4] + 10.) == 4);
+      CPPUNIT_ASSERT_THROW(history.index(start.front() - 1.), 
+                           std::runtime_error);
+   }
+
+// A file with the same name in another directory has its own cache
+// file, so its livetime fractions are not taken from the first one.
+   std::string ft2dir("test_livetime_dir");
+   ::mkdir(ft2dir.c_str(), 0755);
+   std::string other_ft2file(ft2dir + "/" + ft2file);
+   std::vector<double> other_livetime;
+   for (size_t i(0); i < nrows; i++) {
+      other_livetime.push_back(30.*(nrows - i)/100.);
+   }
+   writeFt2File(other_ft2file, start, stop, other_livetime);
+   CPPUNIT_ASSERT(LivetimeHistory::cacheFile(ft2file, ".") !=
+                  LivetimeHistory::cacheFile(other_ft2file, "."));
+   LivetimeHistory other_history;
+   other_history.readFt2File(other_ft2file, ".");
+   for (size_t i(0); i < nrows; i++) {
+      CPPUNIT_ASSERT(std::fabs(other_history.livetimefrac(i) 
+                               - (nrows - i)/100.) < 1e-12);
+   }
+
+// Copies made and destroyed concurrently share the arrays safely.
+#pragma omp parallel for
+   for (int i = 0; i < 1000; i++) {
+      LivetimeHistory copy(other_history);
+      LivetimeHistory assigned;
+      assigned = copy;
+      assigned.clear();
+   }
+   CPPUNIT_ASSERT(other_history.size() == nrows);
+
+   std::remove(LivetimeHistory::cacheFile(ft2file, ".").c_str());
+   std::remove(LivetimeHistory::cacheFile(other_ft2file, ".").c_str());
+   std::remove(other_ft2file.c_str());
+   std::remove(ft2dir.c_str());
+   std::remove(ft2file.c_str());
+}
+
+void irfInterfaceTests::test_Instrumentation() {
+   bool enabled(Instrumentation::enabled());
+
+   Counter counter("test/calls");
+   Instrumentation::enable(false);
+   counter.add();
+   CPPUNIT_ASSERT(Instrumentation::counter("test/calls") == 0);
+
+   Instrumentation::enable();
+   Instrumentation::reset();
+   counter.add();
+   counter.add(2);
+   CPPUNIT_ASSERT(Instrumentation::counter("test/calls") == 3);
+
+// Counters with the same name are summed.
+   {
+      Counter other("test/calls");
+      other.add();
+      CPPUNIT_ASSERT(Instrumentation::counter("test/calls") == 4);
+   }
+   CPPUNIT_ASSERT(Instrumentation::counter("test/calls") == 3);
+
+   Psf psf;
+   psf.angularIntegral(100., 0., 0., 5.);
+   CPPUNIT_ASSERT(Instrumentation::counter("IPsf::angularIntegral/calls") == 1);
+   CPPUNIT_ASSERT(Instrumentation::counter("dgaus8/calls") == 1);
+   CPPUNIT_ASSERT(Instrumentation::counter("IPsf/integrand evaluations") > 0);
+   CPPUNIT_ASSERT(Instrumentation::report().find("test/calls") 
+                  != std::string::npos);
+
+   Instrumentation::reset();
+   CPPUNIT_ASSERT(Instrumentation::counter("test/calls") == 0);
+   Instrumentation::enable(enabled);
+}
+
+void irfInterfaceTests::test_Accuracy() {
+   Irfs & irfs(*m_irfs["Moe"]);
+   CPPUNIT_ASSERT(irfs.psf()->accuracy() == Accuracy::DEFAULT);
+
+// The mode is applied to the existing components and to their clones.
+   irfs.setAccuracy(Accuracy::FAST);
+   CPPUNIT_ASSERT(irfs.psf()->accuracy() == Accuracy::FAST);
+   CPPUNIT_ASSERT(irfs.edisp()->accuracy() == Accuracy::FAST);
+   Irfs * my_irfs(irfs.clone());
+   CPPUNIT_ASSERT(my_irfs->accuracy() == Accuracy::FAST);
+   CPPUNIT_ASSERT(my_irfs->psf()->accuracy() == Accuracy::FAST);
+
+// Components set later inherit it.
+   my_irfs->setAccuracy(Accuracy::PRECISE);
+   delete my_irfs->edisp();
+   my_irfs->setEdisp(new Edisp());
+   CPPUNIT_ASSERT(my_irfs->edisp()->accuracy() == Accuracy::PRECISE);
+   delete my_irfs;
+
+// The normalizations hold at the relaxed tolerances of FAST.
+   double e0(100.);
+   double integral(irfs.edisp()->integral(0, 1000., e0, 0, 0));
+   CPPUNIT_ASSERT(std::fabs(integral - 1) < 1e-3);
+   integral = irfs.psf()->angularIntegral(100., 0, 0, 10.);
+   CPPUNIT_ASSERT(std::fabs(integral - 1) < 1e-3);
+
+   CPPUNIT_ASSERT(Accuracy::tolerance(Accuracy::DEFAULT, 1e-5) == 1e-5);
+   CPPUNIT_ASSERT(Accuracy::tolerance(Accuracy::FAST, 1e-5) > 1e-5);
+   CPPUNIT_ASSERT(Accuracy::tolerance(Accuracy::PRECISE, 1e-5) < 1e-5);
+   CPPUNIT_ASSERT(Accuracy::tolerance(Accuracy::FAST, 0.1) == 0.1);
+}
+
 int main() {
 #if defined(TRAP_FPE) || defined(HEADAS)
       feenableexcept(FE_INVALID | FE_DIVBYZERO | FE_OVERFLOW);
@@ -33,7 +33,10 @@ class Loader {
 
 public:
 
-   /// This method loads all of the available irfs.
+   /// This method loads all of the available irfs.  For loaders
+   /// that support it (e.g., LATRESPONSE), the individual Irfs
+   /// objects are only created when first requested from
+   /// irfInterface::IrfsFactory.
    static void go();
 
    /// This method loads only those requested.
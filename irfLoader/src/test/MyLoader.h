@@ -36,6 +36,62 @@ public:
 
 };
 
+class MyDeferredLoader : public irfInterface::IrfLoader {
+
+public:
+
+   MyDeferredLoader() : m_nresolved(0) {}
+
+   virtual void registerEventClasses() const {
+      irfInterface::IrfRegistry::instance().registerEventClass(name(),
+                                                               name() 
+                                                               + "::Lazy");
+   }
+
+   virtual void loadIrfs() const {
+      resolveIrfs(name() + "::Lazy");
+   }
+   
+   virtual std::string name() const {
+      return "my_deferred_classes";
+   }
+
+   virtual bool deferrable() const {
+      return true;
+   }
+
+   virtual void getIrfsNames(std::vector<std::string> & names) const {
+      names.push_back(name() + "::Lazy");
+   }
+
+   virtual bool resolveIrfs(const std::string & irfsName) const {
+      if (irfsName != name() + "::Lazy") {
+         return false;
+      }
+      m_nresolved++;
+      irfInterface::IrfsFactory::
+         instance()->addIrfs(irfsName, new irfInterface::Irfs(0, 0, 0, 7));
+      return true;
+   }
+
+   virtual bool resolveEventClasses(const std::string & respName) const {
+      if (respName != name()) {
+         return false;
+      }
+      registerEventClasses();
+      return true;
+   }
+
+   int nresolved() const {
+      return m_nresolved;
+   }
+
+private:
+
+   mutable int m_nresolved;
+
+};
+
 } // namespace irfLoader
 
 #endif // irfLoader_MyLoader_h
@@ -29,6 +29,7 @@ class irfLoaderTests : public CppUnit::TestFixture {
 
    CPPUNIT_TEST_SUITE(irfLoaderTests);
    CPPUNIT_TEST(load_single_irfs);
+   CPPUNIT_TEST(load_deferred_irfs);
    CPPUNIT_TEST_EXCEPTION(access_missing_irfs, std::invalid_argument);
 
    CPPUNIT_TEST_SUITE_END();
@@ -39,6 +40,7 @@ public:
    void tearDown();
 
    void load_single_irfs();
+   void load_deferred_irfs();
    void access_missing_irfs();
 
    void test_IrfRegistry();
@@ -71,6 +73,33 @@ void irfLoaderTests::load_single_irfs() {
                             std::string("my_classes::BackB")) != names.end());
 }
 
+void irfLoaderTests::load_deferred_irfs() {
+   MyDeferredLoader * loader(new MyDeferredLoader());
+   irfInterface::IrfRegistry & registry(irfInterface::IrfRegistry::instance());
+   registry.registerLoader(loader);
+   Loader::go(loader->name());
+   CPPUNIT_ASSERT(loader->nresolved() == 0);
+
+   IrfsFactory * myFactory = IrfsFactory::instance();
+   std::vector<std::string> names;
+   myFactory->getIrfsNames(names);
+   CPPUNIT_ASSERT(std::find(names.begin(), names.end(), 
+                            std::string("my_deferred_classes::Lazy"))
+                  != names.end());
+   CPPUNIT_ASSERT(loader->nresolved() == 0);
+
+   irfInterface::Irfs * irfs(myFactory->create("my_deferred_classes::Lazy"));
+   CPPUNIT_ASSERT(irfs->irfID() == 7);
+   CPPUNIT_ASSERT(loader->nresolved() == 1);
+   delete irfs;
+
+   irfs = myFactory->create("my_deferred_classes::Lazy");
+   CPPUNIT_ASSERT(loader->nresolved() == 1);
+   delete irfs;
+
+   CPPUNIT_ASSERT(registry["my_deferred_classes"].size() == 1);
+}
+
 void irfLoaderTests::access_missing_irfs() {
    Loader::go("DEV");
 }
@@ -51,6 +51,16 @@ private:
 
    static EventTypeMapper * s_instance;
 
+   /// Contents of irf_index.fits, read on first use.
+   mutable bool m_haveIndex;
+   mutable std::map<std::string, unsigned int> m_allowedEvtypes;
+   mutable EvTypeMapping_t m_eventTypes;
+
+   void readIndex() const;
+
+   /// Fill m_mappings and m_full_bitmasks for irfName.
+   void buildMapping(const std::string & irfName) const;
+
    mutable std::map<std::string, EvTypeMapping_t> m_mappings;
 
    mutable std::map<std::string, 
@@ -25,22 +25,22 @@ namespace irfUtil {
 
 EventTypeMapper * EventTypeMapper::s_instance(0);
 
-EventTypeMapper::EventTypeMapper() {
+EventTypeMapper::EventTypeMapper() : m_haveIndex(false) {}
+
+void EventTypeMapper::readIndex() const {
+   if (m_haveIndex) {
+      return;
+   }
    // Find the irf_index.fits file.
    std::string sub_path;
    Util::joinPaths("data glast lat bcf irf_index.fits", sub_path);
    std::string irf_index = facilities::commonUtilities::joinPath(
       st_facilities::Environment::getEnv("CALDB"), sub_path);
    
-   // Open the bitmask_mapping extension.
+   // Read the allowed event types for each event_class from the
+   // bitmask_mapping extension.
    const tip::Table * evclass_map
       = tip::IFileSvc::instance().readTable(irf_index, "BITMASK_MAPPING");
-
-   // Open event_type_mapping extension.
-   const tip::Table * evtype_map
-      = tip::IFileSvc::instance().readTable(irf_index, "EVENT_TYPE_MAPPING");
-
-   // Loop over event_class names in BITMASK_MAPPING extension.
    tip::Table::ConstIterator evclass(evclass_map->begin());
    tip::ConstTableRecord & evclass_row(*evclass);
    for ( ; evclass != evclass_map->end(); ++evclass) {
@@ -48,41 +48,63 @@ EventTypeMapper::EventTypeMapper() {
       unsigned int allowed_evtypes(0);
       evclass_row["event_class"].get(event_class);
       evclass_row["event_types"].get(allowed_evtypes);
+      m_allowedEvtypes[event_class] = allowed_evtypes;
+   }
+   delete evclass_map;
 
-      // Create mapping of event_type name to allowed bit positions
-      // and mapping of partition name to full bit-masks for each
-      // event_class.
-      EventTypeMapper::EvTypeMapping_t mapping;
-      std::map<std::string, unsigned int> full_bitmasks;
-
-      // Loop over event_types.
-      tip::Table::ConstIterator evtype;
-      tip::ConstTableRecord & evtype_row(*evtype);
-      for (evtype = evtype_map->begin(); evtype != evtype_map->end();
-           ++evtype) {
-         std::string event_type;
-         int bitpos;
-         std::string partition;
-         evtype_row["event_type"].get(event_type);
-         evtype_row["bitposition"].get(bitpos);
-         evtype_row["event_type_partition"].get(partition);
-         if ((allowed_evtypes >> bitpos) & 1) {
-            mapping[event_type] = std::make_pair(bitpos, partition);
-         }
-         if (full_bitmasks.find(partition) == full_bitmasks.end()) {
-            full_bitmasks[partition] = 0;
-         }
-      }
-      m_mappings[event_class] = mapping;
+   // Read the bit positions and partitions from the
+   // event_type_mapping extension.
+   const tip::Table * evtype_map
+      = tip::IFileSvc::instance().readTable(irf_index, "EVENT_TYPE_MAPPING");
+   tip::Table::ConstIterator evtype(evtype_map->begin());
+   tip::ConstTableRecord & evtype_row(*evtype);
+   for ( ; evtype != evtype_map->end(); ++evtype) {
+      std::string event_type;
+      int bitpos;
+      std::string partition;
+      evtype_row["event_type"].get(event_type);
+      evtype_row["bitposition"].get(bitpos);
+      evtype_row["event_type_partition"].get(partition);
+      m_eventTypes[event_type] = std::make_pair(bitpos, partition);
+   }
+   delete evtype_map;
 
-      for (EventTypeMapper::EvTypeMapping_t::const_iterator 
-              itor(mapping.begin()); itor != mapping.end(); ++itor) {
-         full_bitmasks[itor->second.second] += (1 << itor->second.first);
+   m_haveIndex = true;
+}
+
+void EventTypeMapper::buildMapping(const std::string & irfName) const {
+   readIndex();
+   std::map<std::string, unsigned int>::const_iterator allowed
+      = m_allowedEvtypes.find(irfName);
+   if (allowed == m_allowedEvtypes.end()) {
+      return;
+   }
+   unsigned int allowed_evtypes(allowed->second);
+
+   // Create mapping of event_type name to allowed bit positions
+   // and mapping of partition name to full bit-masks for this
+   // event_class.
+   EventTypeMapper::EvTypeMapping_t mapping;
+   std::map<std::string, unsigned int> full_bitmasks;
+
+   EvTypeMapping_t::const_iterator evtype(m_eventTypes.begin());
+   for ( ; evtype != m_eventTypes.end(); ++evtype) {
+      unsigned int bitpos(evtype->second.first);
+      const std::string & partition(evtype->second.second);
+      if ((allowed_evtypes >> bitpos) & 1) {
+         mapping[evtype->first] = evtype->second;
+      }
+      if (full_bitmasks.find(partition) == full_bitmasks.end()) {
+         full_bitmasks[partition] = 0;
       }
-      m_full_bitmasks[event_class] = full_bitmasks;
    }
-   delete evtype_map;
-   delete evclass_map;
+   m_mappings[irfName] = mapping;
+
+   for (EventTypeMapper::EvTypeMapping_t::const_iterator 
+           itor(mapping.begin()); itor != mapping.end(); ++itor) {
+      full_bitmasks[itor->second.second] += (1 << itor->second.first);
+   }
+   m_full_bitmasks[irfName] = full_bitmasks;
 }
 
 EventTypeMapper & EventTypeMapper::instance() {
@@ -112,6 +134,10 @@ const EventTypeMapper::EvTypeMapping_t &
 EventTypeMapper::mapping(const std::string & irfName) const {
    std::map<std::string, EvTypeMapping_t>::const_iterator it 
       = m_mappings.find(irfName);
+   if (it == m_mappings.end()) {
+      buildMapping(irfName);
+      it = m_mappings.find(irfName);
+   }
    if (it == m_mappings.end()) {
       throw std::runtime_error("IRFs named " + irfName + 
                                " not found in CALDB.");
@@ -123,6 +149,10 @@ const std::map<std::string, unsigned int> &
 EventTypeMapper::full_bitmasks_by_partition(const std::string & irfName) const {
    std::map<std::string, std::map<std::string, unsigned int> >::const_iterator
       it = m_full_bitmasks.find(irfName);
+   if (it == m_full_bitmasks.end()) {
+      buildMapping(irfName);
+      it = m_full_bitmasks.find(irfName);
+   }
    if (it == m_full_bitmasks.end()) {
       throw std::runtime_error("IRFs named " + irfName + 
                                " not found in CALDB.");
@@ -55,6 +55,22 @@ public:
    
    virtual double value(double energy, double theta, double phi,
                         double time=0) const;
+
+   /// Vectorized version of value(energy, theta, phi, time).  The
+   /// phi modulation parameters are looked up from tables made on
+   /// construction, and the modulation is evaluated in a single
+   /// loop over the inputs.
+   virtual std::vector<double> value(const std::vector<double> & energy,
+                                     const std::vector<double> & theta,
+                                     const std::vector<double> & phi,
+                                     double time=0) const;
+
+   /// The phi modulation has unit mean, so the phi-averaged
+   /// effective area is interpolated directly from the table.
+   virtual void valueMatrix(const std::vector<double> & energies,
+                            const std::vector<double> & costhetas,
+                            std::vector<double> & values,
+                            double time=0) const;
    
    virtual irfInterface::IAeff * clone() {
       return new Aeff(*this);
@@ -62,6 +78,11 @@ public:
 
    virtual double upperLimit() const;
 
+   /// Bounds the bilinear interpolation by the maxima of the table
+   /// columns bracketing the energy, times the largest phi
+   /// modulation in the energy bin of the phi dependence tables.
+   virtual double upperLimit(double energy) const;
+
    double max_phi_modulation() const;
 
    std::pair<double, double> pars(double logE, double costh,
@@ -82,6 +103,7 @@ public:
 
    void setValues(const std::vector<double>& values) { 
      m_aeffTable.setValues(values); 
+     setupUpperLimits();
    }
 
 private:
@@ -90,6 +112,33 @@ private:
 
    ParTables * m_phiDepPars;
 
+   /// Cell boundaries of the phi dependence tables and, for each
+   /// cell, the modulation parameters and normalization.
+   std::vector<double> m_phiEbounds;
+   std::vector<double> m_phiTbounds;
+   std::vector<double> m_phiPar0;
+   std::vector<double> m_phiPar1;
+   std::vector<double> m_phiNorm;
+
+   void setupPhiModulation();
+
+   /// @return Index of the phi dependence table cell containing
+   ///         (logE, costheta), as in FitsTable::value(..., false).
+   size_t phiCell(double logE, double costheta) const;
+
+   /// @return Energy index of the phi dependence table cells
+   ///         containing logE.
+   size_t phiEnergyBin(double logE) const;
+
+   /// Maximum effective area table value for each energy, maximum
+   /// phi modulation for each energy bin of the phi dependence
+   /// tables, and the overall maximum phi modulation.
+   std::vector<double> m_aeffMaxima;
+   std::vector<double> m_phiModulationMaxima;
+   double m_maxPhiModulation;
+
+   void setupUpperLimits();
+
    double phi_modulation(double par0, double par1, double phi) const;
 
 };
@@ -8,6 +8,7 @@
 #ifndef latResponse_Bilinear_h
 #define latResponse_Bilinear_h
 
+#include <string>
 #include <vector>
 
 namespace latResponse {
@@ -48,6 +49,12 @@ public:
    static double evaluate(double tt, double uu, 
                           const double * zvals);
 
+   /// Interpolate at each (x[k], y[l]), so that on return
+   /// values[k*y.size() + l] is the value at that point.
+   void evaluateGrid(const std::vector<double> & x,
+                     const std::vector<double> & y,
+                     std::vector<double> & values) const;
+
    double getPar(size_t i, size_t j) const;
 
    void setPar(size_t i, size_t j, double value);
@@ -57,6 +64,11 @@ private:
    std::vector<double> m_x;
    std::vector<double> m_y;
    std::vector<double> m_values;
+
+   /// @return Index of the upper bound of the interval in xx that
+   ///         contains x, as used by getCorners.
+   static int upperIndex(const std::vector<double> & xx, double x,
+                         const std::string & axis);
    
 };
 
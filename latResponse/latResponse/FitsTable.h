@@ -13,6 +13,7 @@
 #define latResponse_FitsTable_h
 
 #include <map>
+#include <string>
 #include <vector>
 
 namespace tip {
@@ -46,6 +47,19 @@ public:
    /// @param interpolate [true] if true, make linear
    /// interpolation. Otherwise, return value for given cell.
    double value(double logenergy, double costh, bool interpolate=true) const;
+
+   /// @brief Interpolated values for arrays of log10(energy) and
+   /// cos(theta), with the same conventions as value(...).
+   void value(const std::vector<double> & logenergies,
+              const std::vector<double> & costhetas,
+              std::vector<double> & values) const;
+
+   /// @brief Interpolated values on the grid of log10(energy) and
+   /// cos(theta) values, with values[i*costhetas.size() + j]
+   /// corresponding to logenergies[i] and costhetas[j].
+   void valueGrid(const std::vector<double> & logenergies,
+                  const std::vector<double> & costhetas,
+                  std::vector<double> & values) const;
     
    double maximum() const {
       return m_maxValue;
@@ -60,6 +74,14 @@ public:
                              std::vector<double> & values,
                              size_t nrow=0);
 
+   /// Read a column from fitsfile[extname], using the loaded
+   /// IrfSnapshot if it contains the data.
+   static void getVectorData(const std::string & fitsfile,
+                             const std::string & extname,
+                             const std::string & fieldName,
+                             std::vector<double> & values,
+                             size_t nrow=0);
+
    void getValues(std::vector<double> & values) const;
 
    void getCornerPars(double logE, double costh, 
@@ -46,6 +46,18 @@ public:
       return "LATRESPONSE";
    }
 
+   /// The Irfs objects for each IRF name and event type are created
+   /// only when requested from IrfsFactory.
+   virtual bool deferrable() const {
+      return true;
+   }
+
+   virtual void getIrfsNames(std::vector<std::string> & names) const;
+
+   virtual bool resolveIrfs(const std::string & irfsName) const;
+
+   virtual bool resolveEventClasses(const std::string & respName) const;
+
    static void set_edisp_interpolation(bool flag) {
       s_interpolate_edisp = flag;
    }
@@ -54,6 +66,39 @@ public:
       return s_interpolate_edisp;
    }
 
+   /// Build the epochs of each IRF component, and the components
+   /// in prefetch(), on several threads.  This has no effect unless
+   /// OpenMP is enabled.
+   static void set_parallel_loading(bool flag) {
+      s_parallel_loading = flag;
+   }
+
+   static bool parallel_loading() {
+      return s_parallel_loading;
+   }
+
+   /// Compute all of the Psf angular integrals needed for an
+   /// acceptance cone when the cone is first used, rather than on
+   /// demand, so that the time per angularIntegral call is
+   /// predictable.  The default is set by the
+   /// LATRESPONSE_EAGER_PSF_INTEGRALS environment variable.
+   static void set_eager_psf_integrals(bool flag) {
+      s_eager_psf_integrals = flag;
+   }
+
+   static bool eager_psf_integrals() {
+      return s_eager_psf_integrals;
+   }
+
+   /// Load the aeff, psf, edisp and efficiency factor components of
+   /// the named Irfs, e.g., "P8R2_SOURCE_V6::PSF0", and make the
+   /// loaded objects the IrfsFactory prototypes so that subsequent
+   /// IrfsFactory::create calls copy them rather than reading the
+   /// FITS files again.  An error in building any of the components,
+   /// including the efficiency factor, is rethrown as a
+   /// std::runtime_error once all of them have been attempted.
+   static void prefetch(const std::vector<std::string> & irfsNames);
+
    /// @return Single or multi-epoch Aeff.
    static irfInterface::IAeff * aeff(const irfUtil::IrfHdus & aeff_hdus);
 
@@ -71,6 +116,10 @@ private:
    
    static bool s_interpolate_edisp;
 
+   static bool s_parallel_loading;
+
+   static bool s_eager_psf_integrals;
+
    std::vector<std::string> m_caldbNames;
 
    std::string m_customIrfDir;
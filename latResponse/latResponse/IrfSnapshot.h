@@ -0,0 +1,186 @@
+/**
+ * @file IrfSnapshot.h
+ * @brief Versioned binary snapshot of the prepared (padded and
+ * renormalized) IRF tables that can be read at startup in place of
+ * re-reading and re-processing the CALDB FITS files.
+ *
+ * @author J. Chiang
+ *
+ * $Header$
+ */
+
+#ifndef latResponse_IrfSnapshot_h
+#define latResponse_IrfSnapshot_h
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace latResponse {
+
+/**
+ * @class IrfSnapshot
+ *
+ * @brief Store of named double-precision arrays keyed by the FITS
+ * file, extension and table from which they were derived.
+ *
+ * A snapshot is created by enabling recording (see
+ * startRecording()), constructing the IRF objects of interest, and
+ * writing the recorded entries with write().  The resulting file is
+ * loaded either explicitly via load() or by setting the
+ * LATRESPONSE_IRF_SNAPSHOT environment variable before the
+ * latResponse::IrfLoader is created.  Each record carries the
+ * modification time and size of its source FITS file; records whose
+ * source has changed are ignored so that the FITS file is read
+ * instead.
+ *
+ * The IRF objects copy the arrays they need out of the snapshot into
+ * their own tables, as they would from the FITS files, so the time
+ * saved is that of the FITS parsing and the renormalizations.  The
+ * file is mapped only to avoid reading it into a buffer first; the
+ * copies are private to each process, and no memory is shared among
+ * processes using the same snapshot.
+ *
+ * File layout (native byte order, all sections 8-byte aligned):
+ * @verbatim
+ * header:  char[8] magic "IRFSNAP", uint32 version, uint32 byte-order mark,
+ *          uint64 number of records
+ * record:  uint64 record size, uint32 key length, uint32 source length,
+ *          int64 source mtime, int64 source size, uint32 number of names,
+ *          uint32 number of arrays, key, source, names (uint32 length +
+ *          chars each), padding, arrays (uint64 length + doubles each)
+ * @endverbatim
+ */
+
+class IrfSnapshot {
+
+public:
+
+   /// @class Record
+   /// @brief Read-only view of a single record.  The array data
+   /// point into the snapshot file contents, which are only valid
+   /// while the snapshot is loaded, so the IRF classes copy them.
+   class Record {
+   public:
+      Record() : m_mtime(0), m_fileSize(0) {}
+
+      const std::string & source() const {
+         return m_source;
+      }
+
+      const std::vector<std::string> & names() const {
+         return m_names;
+      }
+
+      size_t narrays() const {
+         return m_data.size();
+      }
+
+      const double * data(size_t i) const {
+         return m_data.at(i);
+      }
+
+      size_t size(size_t i) const {
+         return m_sizes.at(i);
+      }
+
+      /// Copy the ith array into values.
+      void copy(size_t i, std::vector<double> & values) const;
+
+   private:
+      friend class IrfSnapshot;
+      std::string m_source;
+      long m_mtime;
+      long m_fileSize;
+      std::vector<std::string> m_names;
+      std::vector<const double *> m_data;
+      std::vector<size_t> m_sizes;
+   };
+
+   /// Create an empty snapshot to which records can be added.
+   IrfSnapshot();
+
+   /// Map an existing snapshot file into memory.
+   IrfSnapshot(const std::string & filename);
+
+   ~IrfSnapshot();
+
+   /// @return The record for key, or zero if it is absent or if its
+   ///         source file has changed since the snapshot was made.
+   const Record * find(const std::string & key) const;
+
+   /// Add a record.  Existing records with the same key are replaced.
+   void add(const std::string & key, const std::string & source,
+            const std::vector<std::string> & names,
+            const std::vector<std::vector<double> > & arrays);
+
+   /// Write the added records to filename.
+   void write(const std::string & filename) const;
+
+   /// @return Number of records.
+   size_t size() const;
+
+   /// Format version written to and required of snapshot files.
+   static const unsigned int s_version;
+
+   /// Make the snapshot in filename available to the IRF classes.
+   static void load(const std::string & filename);
+
+   /// Stop using any previously loaded snapshot.
+   static void unload();
+
+   /// @return The loaded snapshot record for key, or zero.
+   static const Record * lookup(const std::string & key);
+
+   /// Start collecting records from IRF objects as they are built.
+   static void startRecording();
+
+   /// Stop collecting records and discard those collected.
+   static void stopRecording();
+
+   /// @return The recording snapshot, or zero if not recording.
+   static IrfSnapshot * recorder();
+
+   /// @return Key identifying the data of the given kind read from
+   ///         row nrow of table tablename in fitsfile[extname].
+   static std::string key(const std::string & kind,
+                          const std::string & fitsfile,
+                          const std::string & extname,
+                          const std::string & tablename="",
+                          size_t nrow=0);
+
+private:
+
+   /// Entries collected while recording.
+   struct Entry {
+      std::string source;
+      std::vector<std::string> names;
+      std::vector<std::vector<double> > arrays;
+   };
+
+   std::map<std::string, Entry> m_entries;
+
+   std::map<std::string, Record> m_records;
+
+   char * m_buffer;
+   size_t m_length;
+   bool m_mapped;
+
+   void readIndex(const std::string & filename);
+
+   bool isCurrent(const Record & record) const;
+
+   mutable std::map<std::string, bool> m_current;
+
+   static IrfSnapshot * s_loaded;
+   static IrfSnapshot * s_recorder;
+
+   // Disable copying.
+   IrfSnapshot(const IrfSnapshot &);
+   IrfSnapshot & operator=(const IrfSnapshot &);
+
+};
+
+} // namespace latResponse
+
+#endif // latResponse_IrfSnapshot_h
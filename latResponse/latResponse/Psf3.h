@@ -107,6 +107,10 @@ public:
       return new Psf3(*this);
    }
 
+   /// Set the accuracy, discarding any cached angular integrals
+   /// computed at a different accuracy.
+   virtual void setAccuracy(irfInterface::Accuracy::Mode mode);
+
    void setParams(size_t indx, const std::vector<double>& params);
 
    static int findIndex(const std::vector<double> & xx, double x);
@@ -128,6 +132,14 @@ private:
 
    void normalize_pars(double radius=90.);
 
+   /// Restore the normalized parameters from the loaded IrfSnapshot.
+   /// @return false if the snapshot does not have them.
+   bool restoreSnapshot(const std::string & fitsfile,
+                        const std::string & extname, size_t nrow);
+
+   void recordSnapshot(const std::string & fitsfile,
+                       const std::string & extname, size_t nrow) const;
+
    double evaluate(double energy, double sep, const double * pars) const;
 
    void getCornerPars(double energy, double theta, double & tt,
@@ -140,6 +152,10 @@ private:
    double angularIntegral(double energy, double psi, 
                           const std::vector<double> & pars);
 
+   /// Compute the cached integrals for every sigma and gamma on the
+   /// parameter grid.
+   void fillIntegralCache();
+
    static void generateBoundaries(const std::vector<double> & x,
                                   const std::vector<double> & y,
                                   const std::vector<double> & values,
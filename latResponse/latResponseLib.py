@@ -9,6 +9,8 @@ def generate(env, **kw):
     env.Tool('irfUtilLib')
     env.Tool('tipLib')
     env.Tool('addLibrary', library=env['clhepLibs'])
+    if env['PLATFORM'] == 'posix':
+        env.AppendUnique(LINKFLAGS=['-fopenmp'])
 
 def exists(env):
     return 1
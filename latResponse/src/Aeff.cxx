@@ -9,10 +9,15 @@
 
 #include <cmath>
 
+#include <algorithm>
+#include <stdexcept>
+
 #include "astro/SkyDir.h"
 
 #include "tip/TipException.h"
 
+#include "irfInterface/Instrumentation.h"
+
 #include "irfUtil/IrfHdus.h"
 
 #include "latResponse/FitsTable.h"
@@ -20,6 +25,11 @@
 
 #include "latResponse/Aeff.h"
 
+namespace {
+   irfInterface::Counter s_valueCalls("Aeff::value/calls");
+   irfInterface::Counter s_batchCalls("Aeff::value/batch calls");
+}
+
 namespace latResponse {
 
 Aeff::Aeff(const irfUtil::IrfHdus & irf_hdus, size_t iepoch, size_t nrow) 
@@ -33,8 +43,10 @@ Aeff::Aeff(const irfUtil::IrfHdus & irf_hdus, size_t iepoch, size_t nrow)
                                    irf_hdus("PHI_DEP").at(iepoch).second,
                                    nrow);
       m_usePhiDependence = true;
+      setupPhiModulation();
    } catch (tip::TipException & eobj) {
    }
+   setupUpperLimits();
 }
 
 Aeff::Aeff(const std::string & fitsfile, const std::string & extname,
@@ -48,15 +60,25 @@ Aeff::Aeff(const std::string & fitsfile, const std::string & extname,
    }
    if (m_phiDepPars) {
       m_usePhiDependence = true;
+      setupPhiModulation();
    } else {
       m_usePhiDependence = false;
    }
+   setupUpperLimits();
 }
 
 Aeff::Aeff(const Aeff & other) 
    : irfInterface::IAeff(other),
      m_aeffTable(other.m_aeffTable),
-     m_phiDepPars(0) {
+     m_phiDepPars(0),
+     m_phiEbounds(other.m_phiEbounds),
+     m_phiTbounds(other.m_phiTbounds),
+     m_phiPar0(other.m_phiPar0),
+     m_phiPar1(other.m_phiPar1),
+     m_phiNorm(other.m_phiNorm),
+     m_aeffMaxima(other.m_aeffMaxima),
+     m_phiModulationMaxima(other.m_phiModulationMaxima),
+     m_maxPhiModulation(other.m_maxPhiModulation) {
    if (other.m_phiDepPars != 0) {
       m_phiDepPars = new ParTables(*other.m_phiDepPars);
    }
@@ -71,6 +93,14 @@ Aeff & Aeff::operator=(const Aeff & rhs) {
       if (rhs.m_phiDepPars != 0) {
          m_phiDepPars = new ParTables(*rhs.m_phiDepPars);
       }
+      m_phiEbounds = rhs.m_phiEbounds;
+      m_phiTbounds = rhs.m_phiTbounds;
+      m_phiPar0 = rhs.m_phiPar0;
+      m_phiPar1 = rhs.m_phiPar1;
+      m_phiNorm = rhs.m_phiNorm;
+      m_aeffMaxima = rhs.m_aeffMaxima;
+      m_phiModulationMaxima = rhs.m_phiModulationMaxima;
+      m_maxPhiModulation = rhs.m_maxPhiModulation;
    }
    return *this;
 }
@@ -94,6 +124,7 @@ double Aeff::value(double energy,
 double Aeff::value(double energy, double theta, double phi,
                    double time) const {
    (void)(time);
+   s_valueCalls.add();
    double costheta(std::cos(theta*M_PI/180.));
    if (costheta < m_aeffTable.minCosTheta()) {
       return 0;
@@ -108,6 +139,148 @@ double Aeff::value(double energy, double theta, double phi,
    return aeff_value*phi_mod;
 }
 
+std::vector<double> Aeff::value(const std::vector<double> & energy,
+                                const std::vector<double> & theta,
+                                const std::vector<double> & phi,
+                                double time) const {
+   (void)(time);
+   if (energy.size() != theta.size() || energy.size() != phi.size()) {
+      throw std::runtime_error("Input arrays must have same dimension.");
+   }
+   size_t npts(energy.size());
+   s_batchCalls.add();
+   s_valueCalls.add(npts);
+   std::vector<double> values;
+   if (npts == 0) {
+      return values;
+   }
+
+   std::vector<double> logEs(npts);
+   std::vector<double> costhetas(npts);
+   for (size_t i(0); i < npts; i++) {
+      logEs[i] = std::log10(energy[i]);
+      costhetas[i] = std::min(std::cos(theta[i]*M_PI/180.), 0.99999);
+   }
+   m_aeffTable.value(logEs, costhetas, values);
+   double minCosTheta(m_aeffTable.minCosTheta());
+   for (size_t i(0); i < npts; i++) {
+      values[i] = costhetas[i] < minCosTheta ? 0 : values[i]*1e4;
+   }
+   if (!m_phiDepPars || !m_usePhiDependence) {
+      return values;
+   }
+
+   // Gather the parameters for each point so that the modulation
+   // itself is a loop the compiler can vectorize.
+   std::vector<double> par0(npts);
+   std::vector<double> par1(npts);
+   std::vector<double> norm(npts);
+   for (size_t i(0); i < npts; i++) {
+      size_t indx(phiCell(logEs[i], costhetas[i]));
+      par0[i] = m_phiPar0[indx];
+      par1[i] = m_phiPar1[indx];
+      norm[i] = m_phiNorm[indx];
+   }
+   const double * phis(&phi[0]);
+   double * aeff(&values[0]);
+   int n(static_cast<int>(npts));
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+   for (int i = 0; i < n; i++) {
+      double my_phi(phis[i] < 0 ? phis[i] + 360. : phis[i]);
+      double phi_pv(std::fmod(my_phi*M_PI/180., M_PI) - M_PI/2.);
+      double xx(2.*std::fabs(2./M_PI*std::fabs(phi_pv) - 0.5));
+      aeff[i] *= norm[i]*(1. + par0[i]*std::pow(xx, par1[i]));
+   }
+   return values;
+}
+
+void Aeff::valueMatrix(const std::vector<double> & energies,
+                       const std::vector<double> & costhetas,
+                       std::vector<double> & values,
+                       double time) const {
+   (void)(time);
+   std::vector<double> logEs(energies.size());
+   for (size_t i(0); i < energies.size(); i++) {
+      logEs[i] = std::log10(energies[i]);
+   }
+   std::vector<double> cosths(costhetas.size());
+   for (size_t j(0); j < costhetas.size(); j++) {
+      cosths[j] = std::min(costhetas[j], 0.99999);
+   }
+   m_aeffTable.valueGrid(logEs, cosths, values);
+   double minCosTheta(m_aeffTable.minCosTheta());
+   size_t ncosth(cosths.size());
+   for (size_t i(0); i < energies.size(); i++) {
+      for (size_t j(0); j < ncosth; j++) {
+         double & value(values[i*ncosth + j]);
+         value = cosths[j] < minCosTheta ? 0 : value*1e4;
+      }
+   }
+}
+
+void Aeff::setupPhiModulation() {
+   m_phiEbounds = m_phiDepPars->ebounds();
+   m_phiTbounds = m_phiDepPars->tbounds();
+   const std::vector<std::string> & parNames(m_phiDepPars->parNames());
+   m_phiDepPars->getParVector(parNames.at(0), m_phiPar0);
+   m_phiDepPars->getParVector(parNames.at(1), m_phiPar1);
+   m_phiNorm.resize(m_phiPar0.size());
+   for (size_t i(0); i < m_phiPar0.size(); i++) {
+      m_phiNorm[i] = 1./(1. + m_phiPar0[i]/(1. + m_phiPar1[i]));
+   }
+}
+
+size_t Aeff::phiEnergyBin(double logE) const {
+   size_t ix(std::upper_bound(m_phiEbounds.begin(), m_phiEbounds.end(), logE)
+             - m_phiEbounds.begin());
+   if (ix == m_phiEbounds.size()) {
+      ix -= 1;
+   }
+   if (ix == 0) {
+      ix = 1;
+   }
+   return ix - 1;
+}
+
+size_t Aeff::phiCell(double logE, double costheta) const {
+   size_t iy(std::upper_bound(m_phiTbounds.begin(), m_phiTbounds.end(),
+                              costheta) - m_phiTbounds.begin());
+   if (iy == 0) {
+      iy = 1;
+   }
+   if (iy > m_phiTbounds.size() - 1) {
+      iy = m_phiTbounds.size() - 1;
+   }
+   return (iy - 1)*(m_phiEbounds.size() - 1) + phiEnergyBin(logE);
+}
+
+void Aeff::setupUpperLimits() {
+   const std::vector<double> & values(m_aeffTable.values());
+   size_t nee(m_aeffTable.logEnergies().size());
+   m_aeffMaxima.assign(nee, 0);
+   for (size_t k(0); k < values.size(); k++) {
+      m_aeffMaxima[k % nee] = std::max(m_aeffMaxima[k % nee], values[k]);
+   }
+   // The modulation is monotonic in xx, which ranges over [0, 1], so
+   // its maximum is at one of the end points.
+   m_maxPhiModulation = 1;
+   m_phiModulationMaxima.clear();
+   if (m_phiPar0.empty()) {
+      return;
+   }
+   size_t nphi(m_phiEbounds.size() - 1);
+   m_phiModulationMaxima.assign(nphi, 0);
+   m_maxPhiModulation = 0;
+   for (size_t k(0); k < m_phiPar0.size(); k++) {
+      double max_mod(m_phiNorm[k]*std::max(1., 1. + m_phiPar0[k]));
+      m_phiModulationMaxima[k % nphi] 
+         = std::max(m_phiModulationMaxima[k % nphi], max_mod);
+      m_maxPhiModulation = std::max(m_maxPhiModulation, max_mod);
+   }
+}
+
 double Aeff::phi_modulation(double par0, double par1, double phi) const {
    if (phi < 0) {
       phi += 360.;
@@ -124,6 +297,10 @@ double Aeff::phi_modulation(double logE, double costheta,
    if (!m_phiDepPars || !m_usePhiDependence) {
       return 1.;
    }
+   if (!interpolate) {
+      size_t indx(phiCell(logE, costheta));
+      return phi_modulation(m_phiPar0[indx], m_phiPar1[indx], phi);
+   }
    m_phiDepPars->getPars(logE, costheta, par, interpolate);
    return phi_modulation(par[0], par[1], phi);
 }
@@ -132,24 +309,7 @@ double Aeff::max_phi_modulation() const {
    if (!m_phiDepPars || !m_usePhiDependence) {
       return 1.;
    }
-   const std::vector<std::string> & parNames(m_phiDepPars->parNames());
-   std::vector<double> par0;
-   m_phiDepPars->getParVector(parNames.at(0), par0);
-   std::vector<double> par1;
-   m_phiDepPars->getParVector(parNames.at(1), par1);
-
-   double max_mod(0);
-   for (size_t i(0); i < par0.size(); i++) {
-      double mod0(phi_modulation(par0.at(i), par1.at(i), M_PI/4.));
-      if (mod0 > max_mod) {
-         max_mod = mod0;
-      }
-      double mod1(phi_modulation(par0.at(i), par1.at(i), M_PI/2.));
-      if (mod1 > max_mod) {
-         max_mod = mod1;
-      }
-   }
-   return max_mod;
+   return m_maxPhiModulation;
 }
 
 std::pair<double, double> 
@@ -166,4 +326,24 @@ double Aeff::upperLimit() const {
    return m_aeffTable.maximum()*1e4*max_phi_modulation();
 }
 
+double Aeff::upperLimit(double energy) const {
+   double logE(std::log10(energy));
+   const std::vector<double> & logEs(m_aeffTable.logEnergies());
+   size_t k(std::upper_bound(logEs.begin(), logEs.end(), logE) 
+            - logEs.begin());
+   double aeff_max;
+   if (k == 0) {
+      aeff_max = m_aeffMaxima.front();
+   } else if (k == logEs.size()) {
+      aeff_max = m_aeffMaxima.back();
+   } else {
+      aeff_max = std::max(m_aeffMaxima[k - 1], m_aeffMaxima[k]);
+   }
+   double phi_mod(1);
+   if (m_phiDepPars && m_usePhiDependence) {
+      phi_mod = m_phiModulationMaxima[phiEnergyBin(logE)];
+   }
+   return aeff_max*1e4*phi_mod;
+}
+
 } // namespace latResponse
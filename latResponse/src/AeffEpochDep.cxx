@@ -9,6 +9,8 @@
  * $Header$
  */
 
+#include <algorithm>
+
 #include "AeffEpochDep.h"
 
 namespace latResponse {
@@ -62,10 +64,34 @@ double AeffEpochDep::value(double energy, double theta, double phi,
    return m_aeffs[indx]->value(energy, theta, phi, time);
 }
 
+std::vector<double> AeffEpochDep::value(const std::vector<double> & energy,
+                                        const std::vector<double> & theta,
+                                        const std::vector<double> & phi,
+                                        double time) const {
+   size_t indx(index(time));
+   return m_aeffs[indx]->value(energy, theta, phi, time);
+}
+
+void AeffEpochDep::valueMatrix(const std::vector<double> & energies,
+                               const std::vector<double> & costhetas,
+                               std::vector<double> & values,
+                               double time) const {
+   size_t indx(index(time));
+   m_aeffs[indx]->valueMatrix(energies, costhetas, values, time);
+}
+
 double AeffEpochDep::upperLimit() const {
    return m_upperLimit;
 }
 
+double AeffEpochDep::upperLimit(double energy) const {
+   double my_upperLimit(0);
+   for (size_t i(0); i < m_aeffs.size(); i++) {
+      my_upperLimit = std::max(my_upperLimit, m_aeffs[i]->upperLimit(energy));
+   }
+   return my_upperLimit;
+}
+
 void AeffEpochDep::addAeff(const irfInterface::IAeff & aeff,
                            double epoch_start) {
    appendEpoch(epoch_start);
@@ -40,12 +40,24 @@ public:
    virtual double value(double energy, double theta, double phi,
                         double time) const;
 
+   virtual std::vector<double> value(const std::vector<double> & energy,
+                                     const std::vector<double> & theta,
+                                     const std::vector<double> & phi,
+                                     double time) const;
+
+   virtual void valueMatrix(const std::vector<double> & energies,
+                            const std::vector<double> & costhetas,
+                            std::vector<double> & values,
+                            double time) const;
+
    virtual AeffEpochDep * clone() {
       return new AeffEpochDep(*this);
    }
 
    virtual double upperLimit() const;
 
+   virtual double upperLimit(double energy) const;
+
    void addAeff(const irfInterface::IAeff & aeff, double epoch_start);
    
 private:
@@ -10,6 +10,7 @@
 #include <algorithm>
 #include <iostream>
 #include <stdexcept>
+#include <string>
 #include <vector>
 
 #include "latResponse/Bilinear.h"
@@ -45,6 +46,7 @@ Bilinear::Bilinear(const std::vector<double> & x,
    m_y.back() = yhi;
 
    Array array(values, x.size());
+   m_values.reserve((x.size() + 2)*(y.size() + 2));
    m_values.push_back(array(0, 0));
    for (size_t i(0); i < x.size(); i++) {
       m_values.push_back(array(0, i));
@@ -66,11 +68,9 @@ Bilinear::Bilinear(const std::vector<double> & x,
 
 double Bilinear::operator()(double x, double y) const {
    double tt, uu;
-   std::vector<double> xvals(4);
-   std::vector<double> yvals(4);
-   std::vector<double> zvals(4);
-   getCorners(x, y, tt, uu, &xvals[0], &yvals[0], &zvals[0]);
-   return evaluate(tt, uu, &zvals[0]);
+   double xvals[4], yvals[4], zvals[4];
+   getCorners(x, y, tt, uu, xvals, yvals, zvals);
+   return evaluate(tt, uu, zvals);
 }
 
 double Bilinear::evaluate(double tt, double uu, 
@@ -82,34 +82,30 @@ double Bilinear::evaluate(double tt, double uu,
    return value;
 }
 
+int Bilinear::upperIndex(const std::vector<double> & xx, double x,
+                         const std::string & axis) {
+   typedef std::vector<double>::const_iterator const_iterator_t;
+
+   const_iterator_t ix(std::upper_bound(xx.begin(), xx.end(), x));
+   if (ix == xx.end() && x != xx.back()) {
+      throw std::invalid_argument("Bilinear::operator: " + axis 
+                                  + " out of range");
+   }
+   if (x == xx.back()) {
+      ix = xx.end() - 1;
+   } else if (x <= xx.front()) {
+      ix = xx.begin() + 1;
+   }
+   return ix - xx.begin();
+}
+
 void Bilinear::getCorners(double x, double y, 
                           double & tt, double & uu,
                           double * corner_xvals,
                           double * corner_yvals,
                           double * zvals) const {
-   typedef std::vector<double>::const_iterator const_iterator_t;
-
-   const_iterator_t ix(std::upper_bound(m_x.begin(), m_x.end(), x));
-   if (ix == m_x.end() && x != m_x.back()) {
-      throw std::invalid_argument("Bilinear::operator: x out of range");
-   }
-   if (x == m_x.back()) {
-      ix = m_x.end() - 1;
-   } else if (x <= m_x.front()) {
-      ix = m_x.begin() + 1;
-   }
-   int i(ix - m_x.begin());
-    
-   const_iterator_t iy(std::upper_bound(m_y.begin(), m_y.end(), y));
-   if (iy == m_y.end() && y != m_y.back()) {
-      throw std::invalid_argument("Bilinear::operator: y out of range");
-   }
-   if (y == m_y.back()) {
-      iy = m_y.end() - 1;
-   } else if (y <= m_y.front()) {
-      iy = m_y.begin() + 1;
-   }
-   int j(iy - m_y.begin());
+   int i(upperIndex(m_x, x, "x"));
+   int j(upperIndex(m_y, y, "y"));
 
    tt = (x - m_x[i-1])/(m_x[i] - m_x[i-1]);
    uu = (y - m_y[j-1])/(m_y[j] - m_y[j-1]);
@@ -132,6 +128,39 @@ void Bilinear::getCorners(double x, double y,
    zvals[3] = m_values[xsize*(j) + (i-1)];
 }
 
+void Bilinear::evaluateGrid(const std::vector<double> & x,
+                            const std::vector<double> & y,
+                            std::vector<double> & values) const {
+   // Find the cells and weights along each axis once, rather than
+   // for each grid point.
+   std::vector<int> ix(x.size());
+   std::vector<double> tt(x.size());
+   for (size_t k(0); k < x.size(); k++) {
+      ix[k] = upperIndex(m_x, x[k], "x");
+      tt[k] = (x[k] - m_x[ix[k]-1])/(m_x[ix[k]] - m_x[ix[k]-1]);
+   }
+   std::vector<int> iy(y.size());
+   std::vector<double> uu(y.size());
+   for (size_t k(0); k < y.size(); k++) {
+      iy[k] = upperIndex(m_y, y[k], "y");
+      uu[k] = (y[k] - m_y[iy[k]-1])/(m_y[iy[k]] - m_y[iy[k]-1]);
+   }
+   size_t xsize(m_x.size());
+   values.resize(x.size()*y.size());
+   double zvals[4];
+   for (size_t k(0); k < x.size(); k++) {
+      int i(ix[k]);
+      for (size_t l(0); l < y.size(); l++) {
+         int j(iy[l]);
+         zvals[0] = m_values[xsize*(j-1) + (i-1)];
+         zvals[1] = m_values[xsize*(j-1) + (i)];
+         zvals[2] = m_values[xsize*(j) + (i)];
+         zvals[3] = m_values[xsize*(j) + (i-1)];
+         values[k*y.size() + l] = evaluate(tt[k], uu[l], zvals);
+      }
+   }
+}
+
 double Bilinear::getPar(size_t i, size_t j) const {
    Array array(m_values, m_x.size());
    return array(j+1, i+1);
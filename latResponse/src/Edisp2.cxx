@@ -45,6 +45,14 @@ Edisp2::~Edisp2() {
    delete m_interpolator;
 }
 
+void Edisp2::setAccuracy(irfInterface::Accuracy::Mode mode) {
+   if (mode != accuracy()) {
+      m_loge_last = 0;
+      m_costh_last = 0;
+   }
+   irfInterface::IEdisp::setAccuracy(mode);
+}
+
 void Edisp2::renormalize(double logE, double costh, double * params) const {
    double energy(std::pow(10., logE));
    double scale_factor(scaleFactor(logE, costh));
@@ -189,7 +197,7 @@ double * Edisp2::pars(double energy, double costh) const {
    if (IrfLoader::interpolate_edisp()) {
       // Ensure proper normalization
       EdispIntegrand foo(m_pars, energy, scaleFactor(loge, costh), *this);
-      double err(1e-5);
+      double err(irfInterface::Accuracy::tolerance(accuracy(), 1e-5));
       int ierr;
       double norm = 
          st_facilities::GaussianQuadrature::dgaus8(foo, energy/10.,
@@ -57,6 +57,10 @@ public:
       return new Edisp2(*this);
    }
 
+   /// Set the accuracy, discarding the cached normalization
+   /// computed at a different accuracy.
+   virtual void setAccuracy(irfInterface::Accuracy::Mode mode);
+
    double scaleFactor(double energy, double costheta) const;
 
    double evaluate(double emeas, double energy,
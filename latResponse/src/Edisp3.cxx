@@ -18,14 +18,19 @@
 
 #include "st_facilities/GaussianQuadrature.h"
 
+#include "irfInterface/Instrumentation.h"
+
 #include "irfUtil/IrfHdus.h"
 
 #include "latResponse/FitsTable.h"
 #include "latResponse/IrfLoader.h"
+#include "latResponse/IrfSnapshot.h"
 
 #include "latResponse/Edisp3.h"
 
 namespace {
+   irfInterface::Counter s_valueCalls("Edisp3::value/calls");
+
    double gammln(double x){
       double tmp, sum;
       static double cof[6] =
@@ -55,6 +60,10 @@ Edisp3::Edisp3(const irfUtil::IrfHdus & edisp_hdus, size_t iepoch,
      m_loge_last(0), m_costh_last(0), m_interpolator(0) {
    readScaling(edisp_hdus("EDISP_SCALING").at(iepoch).first,
                edisp_hdus("EDISP_SCALING").at(iepoch).second);
+   if (IrfSnapshot::recorder()) {
+      // Build the interpolator now so that its tables are recorded.
+      interpolator();
+   }
 }
 
 Edisp3::Edisp3(const std::string & fitsfile, 
@@ -65,6 +74,10 @@ Edisp3::Edisp3(const std::string & fitsfile,
      m_fitsfile(fitsfile), m_extname(extname),
      m_nrow(nrow), m_interpolator(0) {
    readScaling(fitsfile, scaling_extname);
+   if (IrfSnapshot::recorder()) {
+      // Build the interpolator now so that its tables are recorded.
+      interpolator();
+   }
 }
 
 Edisp3::~Edisp3() {
@@ -98,6 +111,7 @@ double Edisp3::evaluate(double emeas, double energy,
 
 double Edisp3::value(double appEnergy, double energy,
                      double theta, double phi, double time) const {
+   s_valueCalls.add();
    if (::getenv("DISABLE_EDISP_INTERP")) {
       double costh(std::cos(theta*M_PI/180.));
       costh = std::min(costh, m_parTables.costhetas().back());
@@ -196,10 +210,7 @@ double * Edisp3::pars(double energy, double costh) const {
 
 void Edisp3::readScaling(const std::string & fitsfile, 
                          const std::string & extname) {
-   tip::IFileSvc & fileSvc(tip::IFileSvc::instance());
-   const tip::Table * table(fileSvc.readTable(fitsfile, extname));
-   FitsTable::getVectorData(table, "EDISPSCALE", m_scalePars);
-   delete table;
+   FitsTable::getVectorData(fitsfile, extname, "EDISPSCALE", m_scalePars);
 }
 
 void Edisp3::setParams(size_t indx, const std::vector<double>& params) {  
@@ -61,6 +61,14 @@ void EdispEpochDep::addEdisp(const irfInterface::IEdisp & edisp,
                              double epoch_start) {
    appendEpoch(epoch_start);
    m_edisps.push_back(const_cast<irfInterface::IEdisp &>(edisp).clone());
+   m_edisps.back()->setAccuracy(accuracy());
+}
+
+void EdispEpochDep::setAccuracy(irfInterface::Accuracy::Mode mode) {
+   irfInterface::IEdisp::setAccuracy(mode);
+   for (size_t i(0); i < m_edisps.size(); i++) {
+      m_edisps[i]->setAccuracy(mode);
+   }
 }
 
 } // namespace latResponse
@@ -46,6 +46,9 @@ public:
       return new EdispEpochDep(*this);
    }
 
+   /// Set the accuracy of this object and of the Edisp for each epoch.
+   virtual void setAccuracy(irfInterface::Accuracy::Mode mode);
+
    void addEdisp(const irfInterface::IEdisp & edisp,
                  double epoch_start);
 
@@ -17,8 +17,10 @@
 #include "tip/Table.h"
 
 #include "latResponse/FitsTable.h"
+#include "latResponse/IrfSnapshot.h"
 
 #include "latResponse/EdispInterpolator.h"
+#include "FitsLock.h"
 
 namespace {
    double sqr(double x) {
@@ -51,6 +53,25 @@ EdispInterpolator::~EdispInterpolator() throw() {
 }
 
 void EdispInterpolator::readFits() {
+   FitsLock lock;
+   std::string key(IrfSnapshot::key("EdispInterpolator", m_fitsfile,
+                                    m_extname, "", m_nrow));
+   const IrfSnapshot::Record * record(IrfSnapshot::lookup(key));
+   if (record) {
+      record->copy(0, m_logEs);
+      record->copy(1, m_energies);
+      record->copy(2, m_cosths);
+      record->copy(3, m_thetas);
+      size_t ncells(m_logEs.size()*m_cosths.size());
+      size_t npars(record->size(4)/ncells);
+      const double * pars(record->data(4));
+      m_parVectors.resize(ncells);
+      for (size_t i(0); i < ncells; i++) {
+         m_parVectors[i].assign(pars + i*npars, pars + (i + 1)*npars);
+      }
+      return;
+   }
+
    tip::IFileSvc & fileSvc(tip::IFileSvc::instance());
    const tip::Table * table(fileSvc.readTable(m_fitsfile, m_extname));
    const std::vector<std::string> & validFields(table->getValidFields());
@@ -77,6 +98,7 @@ void EdispInterpolator::readFits() {
    FitsTable::getVectorData(table, "ENERG_LO", elo, m_nrow);
    FitsTable::getVectorData(table, "ENERG_HI", ehi, m_nrow);
    std::vector<double> logEs;
+   logEs.reserve(elo.size());
    for (size_t k(0); k < elo.size(); k++) {
       logEs.push_back(std::log10(std::sqrt(elo[k]*ehi[k])));
    }
@@ -85,6 +107,7 @@ void EdispInterpolator::readFits() {
    FitsTable::getVectorData(table, "CTHETA_LO", mulo, m_nrow);
    FitsTable::getVectorData(table, "CTHETA_HI", muhi, m_nrow);
    std::vector<double> cosths;
+   cosths.reserve(muhi.size());
    for (size_t i(0); i < muhi.size(); i++) {
       cosths.push_back((mulo[i] + muhi[i])/2.);
    }
@@ -130,6 +153,24 @@ void EdispInterpolator::readFits() {
       throw std::runtime_error(message.str());
    }
    delete table;
+
+   if (IrfSnapshot::recorder()) {
+      // Record the parameters before any renormalization by the
+      // client IRF class, since that is re-applied on first use.
+      std::vector<std::vector<double> > arrays;
+      arrays.push_back(m_logEs);
+      arrays.push_back(m_energies);
+      arrays.push_back(m_cosths);
+      arrays.push_back(m_thetas);
+      std::vector<double> pars;
+      for (size_t i(0); i < m_parVectors.size(); i++) {
+         pars.insert(pars.end(), m_parVectors[i].begin(),
+                     m_parVectors[i].end());
+      }
+      arrays.push_back(pars);
+      IrfSnapshot::recorder()->add(key, m_fitsfile, std::vector<std::string>(),
+                                   arrays);
+   }
 }
 
 void EdispInterpolator::generateBoundaries(const std::vector<double> & x,
@@ -151,6 +192,7 @@ void EdispInterpolator::generateBoundaries(const std::vector<double> & x,
    yout.back() = yhi;
 
    Array array(values, x.size());
+   values_out.reserve((x.size() + 2)*(y.size() + 2));
    values_out.push_back(array(0, 0));
    for (size_t i(0); i < x.size(); i++) {
       values_out.push_back(array(0, i));
@@ -27,8 +27,10 @@
 #include "irfUtil/IrfHdus.h"
 
 #include "latResponse/FitsTable.h"
+#include "latResponse/IrfSnapshot.h"
 
 #include "EfficiencyFactor.h"
+#include "FitsLock.h"
 
 namespace latResponse {
 
@@ -85,65 +87,56 @@ readPars(std::string parfile) {
 
 void EfficiencyFactor::readFitsFile(const std::string & fitsfile,
                                     const std::string & extname) {
-   const tip::Table * table = 
-      tip::IFileSvc::instance().readTable(fitsfile, extname);
+   FitsLock lock;
+   std::string key(IrfSnapshot::key("EfficiencyFactor", fitsfile, extname,
+                                    "EFFICIENCY_PARS"));
+   std::vector< std::vector<double> > parVectors;
+   const IrfSnapshot::Record * record(IrfSnapshot::lookup(key));
+   if (record) {
+      for (size_t i(0); i < record->narrays(); i++) {
+         parVectors.push_back(std::vector<double>());
+         record->copy(i, parVectors.back());
+      }
+   } else {
+      const tip::Table * table = 
+         tip::IFileSvc::instance().readTable(fitsfile, extname);
 
-   long nrows;
-   table->getHeader()["NAXIS2"].get(nrows);
+      long nrows;
+      table->getHeader()["NAXIS2"].get(nrows);
+
+      for (size_t i(0); i < static_cast<unsigned long>(nrows); i++) {
+         std::vector<double> values;
+         FitsTable::getVectorData(table, "EFFICIENCY_PARS", values, i);
+         parVectors.push_back(values);
+      }
+      delete table;
+      if (IrfSnapshot::recorder()) {
+         IrfSnapshot::recorder()->add(key, fitsfile,
+                                      std::vector<std::string>(), parVectors);
+      }
+   }
 
    bool all_zeros(true);
-   std::vector< std::vector<double> > parVectors;
-   for (size_t i(0); i < static_cast<unsigned long>(nrows); i++) {
-      std::vector<double> fltValues;
-      FitsTable::getVectorData(table, "EFFICIENCY_PARS", fltValues, i);
-      for (size_t j(0); j < fltValues.size(); j++) {
-         if (fltValues.at(j) != 0) {
+   for (size_t i(0); i < parVectors.size(); i++) {
+      for (size_t j(0); j < parVectors[i].size(); j++) {
+         if (parVectors[i][j] != 0) {
             all_zeros = false;
          }
       }
-      std::vector<double> values(fltValues.size(), 0);
-      std::copy(fltValues.begin(), fltValues.end(), values.begin());
-      parVectors.push_back(values);
    }
    if (all_zeros) {
-      delete table;
       m_havePars = false;
       return;
    }
    m_p0 = EfficiencyParameter(parVectors.at(0));
    m_p1 = EfficiencyParameter(parVectors.at(1));
-   delete table;
 }
 
 double EfficiencyFactor::operator()(double energy, double met) const {
-   if (!m_havePars || m_start.empty()) {
+   if (!m_havePars || livetimeHistory().empty()) {
       return 1;
    }
-   double ltfrac;
-
-// Find the interval corresponedng to the desired met.  Intervals may
-// not be uniform, so must do a search.  
-   double tmin(m_start.front());
-   double tmax(m_stop.back());
-   double tol(0);
-   if (met < tmin - tol || met > tmax + tol) {
-      std::ostringstream message;
-      message << "Requested MET of " << met << " "
-              << "lies outside the range of valid times in the "
-              << "pointing/livetime history: " 
-              << tmin << " to " << tmax << "MET s";
-      throw std::runtime_error(message.str());
-   }
-   std::vector<double>::const_iterator it 
-      = std::upper_bound(m_start.begin(), m_start.end(), met);
-   size_t indx = it - m_start.begin() - 1;
-
-   if (m_start.at(indx) <= met && met <= m_stop.at(indx)) {
-      ltfrac = m_livetimefrac.at(indx);
-   }
-
-   double value = IEfficiencyFactor::value(energy, ltfrac);
-   return value;
+   return IEfficiencyFactor::value(energy, livetimeFraction(met));
 }
 
 double EfficiencyFactor::value(double energy, double livetimefrac,
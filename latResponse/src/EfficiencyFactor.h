@@ -98,11 +98,6 @@ private:
       double m_logEb2;
    } m_p0, m_p1;
 
-   double m_dt;
-   std::vector<double> m_start;
-   std::vector<double> m_stop;
-   std::vector<double> m_livetimefrac;
-
    void readPars(std::string parfile);
 
    void readFitsFile(const std::string & fitsfile,
@@ -46,8 +46,12 @@ EfficiencyFactorEpochDep::~EfficiencyFactorEpochDep() throw() {
 }
 
 double EfficiencyFactorEpochDep::operator()(double energy, double met) const {
-   size_t indx(index(met));
-   return m_effs[indx]->operator()(energy, met);
+   // The FT2 data are read into this object rather than the
+   // components, so evaluate the livetime fraction here.
+   if (livetimeHistory().empty()) {
+      return 1;
+   }
+   return IEfficiencyFactor::value(energy, livetimeFraction(met), met);
 }
 
 double EfficiencyFactorEpochDep::value(double energy, double livetimefrac,
@@ -60,7 +64,7 @@ void EfficiencyFactorEpochDep::
 getLivetimeFactors(double energy, double & factor1, double & factor2,
                    double met) const {
    size_t indx(index(met));
-   m_effs[indx]->value(energy, factor1, factor2, met);
+   m_effs[indx]->getLivetimeFactors(energy, factor1, factor2, met);
 }
 
 void EfficiencyFactorEpochDep::add(irfInterface::IEfficiencyFactor & eff,
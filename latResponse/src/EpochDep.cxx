@@ -18,7 +18,10 @@
 
 #include "astro/JulianDate.h"
 
+#include "latResponse/IrfSnapshot.h"
+
 #include "EpochDep.h"
+#include "FitsLock.h"
 
 namespace latResponse {
 
@@ -27,6 +30,12 @@ EpochDep::EpochDep() : m_curr_index(0) {
 
 double EpochDep::epochStart(const std::string & fitsfile,
                             const std::string & extname) {
+   FitsLock lock;
+   std::string key(IrfSnapshot::key("EpochStart", fitsfile, extname));
+   const IrfSnapshot::Record * record(IrfSnapshot::lookup(key));
+   if (record) {
+      return record->data(0)[0];
+   }
    const tip::Table * table 
       = tip::IFileSvc::instance().readTable(fitsfile, extname);
    const tip::Header & header(table->getHeader());
@@ -48,6 +57,11 @@ double EpochDep::epochStart(const std::string & fitsfile,
                         std::atoi(date_tokens[2].c_str()),
                         hours);
    double met = jd.seconds() - astro::JulianDate::missionStart().seconds();
+   if (IrfSnapshot::recorder()) {
+      IrfSnapshot::recorder()->add(key, fitsfile, std::vector<std::string>(),
+                                   std::vector<std::vector<double> >
+                                   (1, std::vector<double>(1, met)));
+   }
    return met;
 }
 
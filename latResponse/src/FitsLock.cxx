@@ -0,0 +1,36 @@
+/**
+ * @file FitsLock.cxx
+ * @brief Implementation of the lock serializing IRF file access.
+ *
+ * @author J. Chiang
+ *
+ * $Header$
+ */
+
+#include "FitsLock.h"
+
+#ifdef _OPENMP
+namespace {
+   class NestLock {
+   public:
+      NestLock() {
+         omp_init_nest_lock(&m_lock);
+      }
+      ~NestLock() {
+         omp_destroy_nest_lock(&m_lock);
+      }
+      omp_nest_lock_t m_lock;
+   };
+}
+#endif
+
+namespace latResponse {
+
+#ifdef _OPENMP
+omp_nest_lock_t * FitsLock::lock() {
+   static NestLock s_lock;
+   return &s_lock.m_lock;
+}
+#endif
+
+} // namespace latResponse
@@ -0,0 +1,59 @@
+/**
+ * @file FitsLock.h
+ * @brief Scoped lock that serializes access to the IRF FITS files
+ * (and the tables derived from them) when the IRFs are loaded on
+ * several threads.
+ *
+ * @author J. Chiang
+ *
+ * $Header$
+ */
+
+#ifndef latResponse_FitsLock_h
+#define latResponse_FitsLock_h
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace latResponse {
+
+/**
+ * @class FitsLock
+ * @brief tip and cfitsio are not reentrant, so each function that
+ * reads an IRF file holds one of these while it does so.  The lock
+ * is recursive so that such functions may call each other.  Without
+ * OpenMP, this does nothing.
+ */
+
+class FitsLock {
+
+public:
+
+   FitsLock() {
+#ifdef _OPENMP
+      omp_set_nest_lock(lock());
+#endif
+   }
+
+   ~FitsLock() {
+#ifdef _OPENMP
+      omp_unset_nest_lock(lock());
+#endif
+   }
+
+private:
+
+#ifdef _OPENMP
+   static omp_nest_lock_t * lock();
+#endif
+
+   // Disable copying.
+   FitsLock(const FitsLock &);
+   FitsLock & operator=(const FitsLock &);
+
+};
+
+} // namespace latResponse
+
+#endif // latResponse_FitsLock_h
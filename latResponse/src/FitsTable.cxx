@@ -11,6 +11,7 @@
 
 #include <algorithm>
 #include <iostream>
+#include <sstream>
 #include <stdexcept>
 
 #include "tip/IFileSvc.h"
@@ -18,6 +19,8 @@
 
 #include "latResponse/Bilinear.h"
 #include "latResponse/FitsTable.h"
+#include "latResponse/IrfSnapshot.h"
+#include "FitsLock.h"
 
 namespace {
    size_t binIndex(double x, const std::vector<double> & xx) {
@@ -33,6 +36,22 @@ FitsTable::FitsTable(const std::string & filename,
                      const std::string & extname,
                      const std::string & tablename,
                      size_t nrow) : m_interpolator(0) {
+   FitsLock lock;
+   std::string key(IrfSnapshot::key("FitsTable", filename, extname,
+                                    tablename, nrow));
+   const IrfSnapshot::Record * record(IrfSnapshot::lookup(key));
+   if (record) {
+      record->copy(0, m_logEnergies);
+      record->copy(1, m_mus);
+      record->copy(2, m_values);
+      record->copy(3, m_ebounds);
+      record->copy(4, m_tbounds);
+      m_minCosTheta = record->data(5)[0];
+      m_maxValue = record->data(5)[1];
+      m_interpolator = new Bilinear(m_logEnergies, m_mus, m_values,
+                                    0, 10, -1, 1);
+      return;
+   }
 
    const tip::Table * table(tip::IFileSvc::instance().readTable(filename, 
                                                                 extname));
@@ -40,6 +59,8 @@ FitsTable::FitsTable(const std::string & filename,
    std::vector<double> elo, ehi;
    getVectorData(table, "ENERG_LO", elo, nrow);
    getVectorData(table, "ENERG_HI", ehi, nrow);
+   m_ebounds.reserve(elo.size() + 1);
+   m_logEnergies.reserve(elo.size());
    for (size_t k(0); k < elo.size(); k++) {
       m_ebounds.push_back(std::log10(elo.at(k)));
       m_logEnergies.push_back(std::log10(std::sqrt(elo.at(k)*ehi.at(k))));
@@ -49,6 +70,8 @@ FitsTable::FitsTable(const std::string & filename,
    std::vector<double> mulo, muhi;
    getVectorData(table, "CTHETA_LO", mulo, nrow);
    getVectorData(table, "CTHETA_HI", muhi, nrow);
+   m_tbounds.reserve(muhi.size() + 1);
+   m_mus.reserve(muhi.size());
    for (size_t i(0); i < muhi.size(); i++) {
       m_tbounds.push_back(mulo.at(i));
       m_mus.push_back((m_tbounds.at(i) + muhi.at(i))/2.);
@@ -72,6 +95,21 @@ FitsTable::FitsTable(const std::string & filename,
                                  xlo=0., xhi=10., ylo=-1., yhi=1.);
 
    delete table;
+
+   if (IrfSnapshot::recorder()) {
+      std::vector<std::vector<double> > arrays;
+      arrays.push_back(m_logEnergies);
+      arrays.push_back(m_mus);
+      arrays.push_back(m_values);
+      arrays.push_back(m_ebounds);
+      arrays.push_back(m_tbounds);
+      std::vector<double> scalars;
+      scalars.push_back(m_minCosTheta);
+      scalars.push_back(m_maxValue);
+      arrays.push_back(scalars);
+      IrfSnapshot::recorder()->add(key, filename, std::vector<std::string>(),
+                                   arrays);
+   }
 }
 
 FitsTable::FitsTable() : m_interpolator(0) {}
@@ -136,13 +174,39 @@ value(double logenergy, double costh, bool interpolate) const {
    return m_values.at(indx);
 }
 
-void FitsTable::getValues(std::vector<double> & values) const {
-   values.clear();
-   for (size_t i(0); i < m_values.size(); i++) {
-      values.push_back(m_values.at(i));
+void FitsTable::value(const std::vector<double> & logenergies,
+                      const std::vector<double> & costhetas,
+                      std::vector<double> & values) const {
+   if (logenergies.size() != costhetas.size()) {
+      throw std::invalid_argument("FitsTable::value: logenergies and "
+                                  "costhetas must have the same size.");
+   }
+   values.resize(logenergies.size());
+   double costh_max(m_mus.back());
+   double tt, uu;
+   double xvals[4], yvals[4], zvals[4];
+   for (size_t i(0); i < logenergies.size(); i++) {
+      double costh(std::min(costhetas[i], costh_max));
+      m_interpolator->getCorners(logenergies[i], costh, tt, uu,
+                                 xvals, yvals, zvals);
+      values[i] = Bilinear::evaluate(tt, uu, zvals);
    }
 }
 
+void FitsTable::valueGrid(const std::vector<double> & logenergies,
+                          const std::vector<double> & costhetas,
+                          std::vector<double> & values) const {
+   std::vector<double> cosths(costhetas);
+   for (size_t j(0); j < cosths.size(); j++) {
+      cosths[j] = std::min(cosths[j], m_mus.back());
+   }
+   m_interpolator->evaluateGrid(logenergies, cosths, values);
+}
+
+void FitsTable::getValues(std::vector<double> & values) const {
+   values = m_values;
+}
+
 void FitsTable::getCornerPars(double logE, double costh,
                               double & tt, double & uu,
                               std::vector<double> & cornerEnergies,
@@ -169,19 +233,46 @@ void FitsTable::getVectorData(const tip::Table * table,
                               const std::string & fieldName,
                               std::vector<double> & values,
                               size_t nrow) {
-   values.clear();
-
+   if (nrow >= static_cast<size_t>(table->getNumRecords())) {
+      std::ostringstream message;
+      message << "FitsTable::getVectorData: requested row " << nrow
+              << " of column " << fieldName << ", but the table has only "
+              << table->getNumRecords() << " rows.";
+      throw std::runtime_error(message.str());
+   }
    tip::Table::ConstIterator it(table->begin());
-   tip::ConstTableRecord & row(*it);
+   it += nrow;
 
-   for (size_t i(0); i < nrow; i++) {
-      ++it;
-   }
-   std::vector<float> my_values;
-   row[fieldName].get(my_values);
+// Read the cell directly into the output array, so that the
+// conversion to double is done once, without a temporary copy.
+   (*it)[fieldName].get(values);
+}
 
-   for (size_t i(0); i < my_values.size(); i++) {
-      values.push_back(my_values.at(i));
+void FitsTable::getVectorData(const std::string & fitsfile,
+                              const std::string & extname,
+                              const std::string & fieldName,
+                              std::vector<double> & values,
+                              size_t nrow) {
+   FitsLock lock;
+   std::string key(IrfSnapshot::key("Column", fitsfile, extname,
+                                    fieldName, nrow));
+   const IrfSnapshot::Record * record(IrfSnapshot::lookup(key));
+   if (record) {
+      record->copy(0, values);
+      return;
+   }
+   const tip::Table * table(tip::IFileSvc::instance().readTable(fitsfile,
+                                                                extname));
+   try {
+      getVectorData(table, fieldName, values, nrow);
+   } catch (...) {
+      delete table;
+      throw;
+   }
+   delete table;
+   if (IrfSnapshot::recorder()) {
+      IrfSnapshot::recorder()->add(key, fitsfile, std::vector<std::string>(),
+                                   std::vector<std::vector<double> >(1, values));
    }
 }
 
@@ -0,0 +1,76 @@
+/**
+ * @file GaussLegendre.cxx
+ * @brief Compute the Gauss-Legendre abscissas and weights by Newton
+ * iteration on the Legendre polynomials.
+ *
+ * @author J. Chiang
+ *
+ * $Header$
+ */
+
+#include <cmath>
+
+#include <stdexcept>
+
+#include "GaussLegendre.h"
+
+namespace {
+   /// Evaluate P_n(x) and its derivative by upward recurrence.
+   void legendre(size_t n, double x, double & pn, double & dpn) {
+      double p0(1);
+      double p1(x);
+      for (size_t j(2); j <= n; j++) {
+         double p2(((2.*j - 1.)*x*p1 - (j - 1.)*p0)/j);
+         p0 = p1;
+         p1 = p2;
+      }
+      pn = p1;
+      dpn = n*(x*p1 - p0)/(x*x - 1.);
+   }
+}
+
+namespace latResponse {
+
+GaussLegendre::GaussLegendre(size_t order) 
+   : m_abscissas(order, 0), m_weights(order, 0) {
+   if (order == 0) {
+      throw std::invalid_argument("GaussLegendre: order must be positive.");
+   }
+   if (order == 1) {
+      m_weights[0] = 2;
+      return;
+   }
+   // The roots are symmetric about zero, so find the positive ones,
+   // starting from the usual asymptotic estimate.
+   for (size_t i(0); i < (order + 1)/2; i++) {
+      double x(std::cos(M_PI*(i + 0.75)/(order + 0.5)));
+      double pn, dpn;
+      for (size_t iter(0); iter < 100; iter++) {
+         legendre(order, x, pn, dpn);
+         double dx(pn/dpn);
+         x -= dx;
+         if (std::fabs(dx) < 1e-15) {
+            break;
+         }
+      }
+      legendre(order, x, pn, dpn);
+      m_abscissas[i] = -x;
+      m_abscissas[order - 1 - i] = x;
+      m_weights[i] = 2./((1. - x*x)*dpn*dpn);
+      m_weights[order - 1 - i] = m_weights[i];
+   }
+}
+
+void GaussLegendre::nodes(double xmin, double xmax, std::vector<double> & xx,
+                          std::vector<double> & wts) const {
+   double center((xmax + xmin)/2.);
+   double halfWidth((xmax - xmin)/2.);
+   xx.resize(order());
+   wts.resize(order());
+   for (size_t i(0); i < order(); i++) {
+      xx[i] = center + halfWidth*m_abscissas[i];
+      wts[i] = halfWidth*m_weights[i];
+   }
+}
+
+} // namespace latResponse
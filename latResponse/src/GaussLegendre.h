@@ -0,0 +1,56 @@
+/**
+ * @file GaussLegendre.h
+ * @brief Fixed-order Gauss-Legendre quadrature rule.
+ *
+ * @author J. Chiang
+ *
+ * $Header$
+ */
+
+#ifndef latResponse_GaussLegendre_h
+#define latResponse_GaussLegendre_h
+
+#include <vector>
+
+namespace latResponse {
+
+/**
+ * @class GaussLegendre
+ * @brief Abscissas and weights of the n-point Gauss-Legendre rule on
+ * [-1, 1], computed once on construction.  The rule integrates
+ * polynomials of degree 2n - 1 exactly.
+ */
+
+class GaussLegendre {
+
+public:
+
+   GaussLegendre(size_t order);
+
+   size_t order() const {
+      return m_abscissas.size();
+   }
+
+   /// Abscissas in increasing order.
+   const std::vector<double> & abscissas() const {
+      return m_abscissas;
+   }
+
+   const std::vector<double> & weights() const {
+      return m_weights;
+   }
+
+   /// Map the rule onto [xmin, xmax].
+   void nodes(double xmin, double xmax, std::vector<double> & xx,
+              std::vector<double> & wts) const;
+
+private:
+
+   std::vector<double> m_abscissas;
+   std::vector<double> m_weights;
+
+};
+
+} // namespace latResponse
+
+#endif // latResponse_GaussLegendre_h
@@ -24,6 +24,7 @@
 #include "st_facilities/FitsUtil.h"
 #include "st_facilities/Util.h"
 
+#include "irfInterface/Instrumentation.h"
 #include "irfInterface/IrfRegistry.h"
 #include "irfInterface/Irfs.h"
 #include "irfInterface/IrfsFactory.h"
@@ -34,6 +35,7 @@
 #include "irfUtil/Util.h"
 
 #include "latResponse/IrfLoader.h"
+#include "latResponse/IrfSnapshot.h"
 
 #include "latResponse/Aeff.h"
 #include "AeffEpochDep.h"
@@ -44,6 +46,7 @@
 #include "EdispEpochDep.h"
 #include "EfficiencyFactor.h"
 #include "EfficiencyFactorEpochDep.h"
+#include "FitsLock.h"
 #include "Irfs.h"
 #include "Psf.h"
 #include "Psf2.h"
@@ -53,14 +56,94 @@
 namespace {
    typedef std::map<std::string, std::pair<unsigned int, std::string> > 
    EventTypeMapping_t;
+
+   irfInterface::Counter s_startupTime("IrfLoader::IrfLoader/seconds");
+   irfInterface::Counter 
+   s_registerTime("IrfLoader::registerEventClasses/seconds");
+   irfInterface::Counter s_loadTime("IrfLoader::loadIrfs/seconds");
+   irfInterface::Counter s_resolveCalls("IrfLoader::resolveIrfs/calls");
+   irfInterface::Counter s_prefetchTime("IrfLoader::prefetch/seconds");
+
+   template <class T>
+   void delete_all(std::vector<T *> & objects) {
+      for (size_t i(0); i < objects.size(); i++) {
+         delete objects[i];
+      }
+      objects.clear();
+   }
+
+   /// Throw the first error, if any, after deleting the objects.
+   template <class T>
+   void check_errors(const std::vector<std::string> & errors,
+                     std::vector<T *> & objects) {
+      for (size_t i(0); i < errors.size(); i++) {
+         if (!errors[i].empty()) {
+            delete_all(objects);
+            throw std::runtime_error(errors[i]);
+         }
+      }
+   }
+
+   /// Build the component for each epoch of an IRF, concurrently if
+   /// parallel is true.  The components and epoch start times are
+   /// returned in epoch order, so the results do not depend on the
+   /// scheduling.
+   template <class T>
+   void build_epochs(const irfUtil::IrfHdus & hdus, const std::string & cname,
+                     T * (*build)(const irfUtil::IrfHdus &, size_t),
+                     bool parallel, std::vector<T *> & components,
+                     std::vector<double> & epoch_starts) {
+      const irfUtil::IrfHdus::FilenameHduPairs_t & 
+         filename_hdu_pairs(hdus(cname));
+      int nepochs(static_cast<int>(hdus.numEpochs()));
+      components.assign(nepochs, static_cast<T *>(0));
+      epoch_starts.assign(nepochs, 0);
+      std::vector<std::string> errors(nepochs);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) if(parallel)
+#else
+      (void)(parallel);
+#endif
+      for (int j = 0; j < nepochs; j++) {
+         try {
+            epoch_starts[j] = 
+               latResponse::EpochDep::epochStart(filename_hdu_pairs[j].first,
+                                                 filename_hdu_pairs[j].second);
+            components[j] = build(hdus, j);
+         } catch (std::exception & eObj) {
+            errors[j] = eObj.what();
+         }
+      }
+      check_errors(errors, components);
+   }
+
+   irfInterface::IAeff * new_aeff(const irfUtil::IrfHdus & hdus,
+                                  size_t iepoch) {
+      return new latResponse::Aeff(hdus, iepoch);
+   }
+
+   irfInterface::IEfficiencyFactor * 
+   new_efficiency_factor(const irfUtil::IrfHdus & hdus, size_t iepoch) {
+      return new latResponse::EfficiencyFactor(hdus, iepoch);
+   }
 }
 
 namespace latResponse {
 
 bool IrfLoader::s_interpolate_edisp(true);
 
+bool IrfLoader::s_parallel_loading(false);
+
+bool IrfLoader::
+s_eager_psf_integrals(::getenv("LATRESPONSE_EAGER_PSF_INTEGRALS") != 0);
+
 IrfLoader::IrfLoader() 
    : m_hdcaldb(new irfUtil::HdCaldb("GLAST", "LAT")) {
+   irfInterface::ScopedTimer timer(s_startupTime);
+   char * snapshot(::getenv("LATRESPONSE_IRF_SNAPSHOT"));
+   if (snapshot) {
+      IrfSnapshot::load(snapshot);
+   }
    read_caldb_indx();
    readCustomIrfNames();
 }
@@ -80,6 +163,7 @@ void IrfLoader::registerEventClasses() const {
 }
 
 void IrfLoader::registerEventClasses(const std::string & irfName) const {
+   irfInterface::ScopedTimer timer(s_registerTime);
    irfInterface::IrfRegistry & registry(irfInterface::IrfRegistry::instance());
 
    irfUtil::EventTypeMapper & evMapper(irfUtil::EventTypeMapper::instance());
@@ -120,25 +204,89 @@ void IrfLoader::loadIrfs() const {
 }
 
 void IrfLoader::loadIrfs(const std::string & irfName) const {
+   irfInterface::ScopedTimer timer(s_loadTime);
    if (std::find(m_caldbNames.begin(), m_caldbNames.end(), irfName) 
        == m_caldbNames.end()) {
       throw std::runtime_error("IRF " + irfName + "not found in CALDB");
    }
+   irfInterface::IrfsFactory * myFactory(irfInterface::IrfsFactory::instance());
    const EventTypeMapping_t & event_type_mapping =
       irfUtil::EventTypeMapper::instance().mapping(irfName);
+   std::vector<std::string> names;
+   std::vector<irfInterface::Irfs *> irfs;
    EventTypeMapping_t::const_iterator it(event_type_mapping.begin());
    for ( ; it != event_type_mapping.end(); ++it) {
-      addIrfs(irfName, it->first);
+      std::string name(irfName + "::" + it->first);
+      if (!myFactory->hasIrfs(name)) {
+         names.push_back(name);
+         irfs.push_back(new Irfs(irfName, it->first));
+      }
+   }
+   myFactory->addIrfs(names, irfs);
+}
+
+void IrfLoader::getIrfsNames(std::vector<std::string> & names) const {
+   irfUtil::EventTypeMapper & evMapper(irfUtil::EventTypeMapper::instance());
+   for (size_t i(0); i < m_caldbNames.size(); i++) {
+      try {
+         const EventTypeMapping_t & 
+            event_type_mapping(evMapper.mapping(m_caldbNames[i]));
+         EventTypeMapping_t::const_iterator it(event_type_mapping.begin());
+         for ( ; it != event_type_mapping.end(); ++it) {
+            names.push_back(m_caldbNames[i] + "::" + it->first);
+         }
+      } catch (std::runtime_error & eObj) {
+         // do nothing
+      }
+   }
+}
+
+bool IrfLoader::resolveIrfs(const std::string & irfsName) const {
+   s_resolveCalls.add();
+   size_t pos(irfsName.find("::"));
+   if (pos == std::string::npos) {
+      return false;
+   }
+   std::string irf_name(irfsName.substr(0, pos));
+   std::string event_type(irfsName.substr(pos + 2));
+   if (!std::count(m_caldbNames.begin(), m_caldbNames.end(), irf_name)) {
+      return false;
+   }
+   try {
+      const EventTypeMapping_t & event_type_mapping =
+         irfUtil::EventTypeMapper::instance().mapping(irf_name);
+      if (event_type_mapping.find(event_type) == event_type_mapping.end()) {
+         return false;
+      }
+   } catch (std::runtime_error & eObj) {
+      return false;
+   }
+   addIrfs(irf_name, event_type);
+   return true;
+}
+
+bool IrfLoader::resolveEventClasses(const std::string & respName) const {
+   /// Event class response names have the form "<irf name>" or
+   /// "<irf name> (<partition>)", and the individual event type
+   /// names "<irf name>::<event type>".
+   std::string irf_name(respName.substr(0, respName.find_first_of(" :")));
+   if (!std::count(m_caldbNames.begin(), m_caldbNames.end(), irf_name)) {
+      return false;
+   }
+   try {
+      registerEventClasses(irf_name);
+   } catch (std::runtime_error & eObj) {
+      return false;
    }
+   return true;
 }
 
 void IrfLoader::addIrfs(const std::string & irf_name, 
                         const std::string & event_type) const {
    irfInterface::IrfsFactory * myFactory(irfInterface::IrfsFactory::instance());
-   const std::vector<std::string> & irfNames(myFactory->irfNames());
 
 // Check if this set of IRFs already exists.
-   if (std::count(irfNames.begin(), irfNames.end(), irf_name+"::"+event_type)) {
+   if (myFactory->hasIrfs(irf_name + "::" + event_type)) {
       return;
    }
 
@@ -146,20 +294,70 @@ void IrfLoader::addIrfs(const std::string & irf_name,
    myFactory->addIrfs(irf_name + "::" + event_type, irfs);
 }
 
+void IrfLoader::prefetch(const std::vector<std::string> & irfsNames) {
+   irfInterface::ScopedTimer timer(s_prefetchTime);
+   irfInterface::IrfsFactory * myFactory(irfInterface::IrfsFactory::instance());
+   std::vector<irfInterface::Irfs *> irfs;
+   try {
+      for (size_t i(0); i < irfsNames.size(); i++) {
+         irfs.push_back(myFactory->create(irfsNames[i]));
+      }
+   } catch (...) {
+      delete_all(irfs);
+      throw;
+   }
+
+   // One task per (Irfs, component) pair.  The epochs of each
+   // component are built within its task.
+   int ntasks(static_cast<int>(4*irfs.size()));
+   std::vector<std::string> errors(ntasks);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) if(s_parallel_loading)
+#endif
+   for (int i = 0; i < ntasks; i++) {
+      irfInterface::Irfs & my_irfs(*irfs[i/4]);
+      try {
+         switch (i % 4) {
+         case 0:
+            my_irfs.aeff();
+            break;
+         case 1:
+            my_irfs.psf();
+            break;
+         case 2:
+            my_irfs.edisp();
+            break;
+         default:
+            try {
+               my_irfs.efficiencyFactor();
+            } catch (std::exception &) {
+               // Not all IRFs provide EFFICIENCY_PARS, so leave this
+               // to be reported if and when it is actually requested.
+            }
+         }
+      } catch (std::exception & eObj) {
+         errors[i] = irfsNames[i/4] + ": " + eObj.what();
+      }
+   }
+   check_errors(errors, irfs);
+
+   myFactory->addIrfs(irfsNames, irfs);
+}
+
 irfInterface::IAeff * 
 IrfLoader::aeff(const irfUtil::IrfHdus & aeff_hdus) {
    if (aeff_hdus.numEpochs() == 1) {
       return new Aeff(aeff_hdus, 0);
    } else {
+      std::vector<irfInterface::IAeff *> components;
+      std::vector<double> epoch_starts;
+      build_epochs<irfInterface::IAeff>(aeff_hdus, "EFF_AREA", &new_aeff,
+                                        s_parallel_loading, components,
+                                        epoch_starts);
       AeffEpochDep * my_aeff(new AeffEpochDep());
-      const std::vector<std::pair<std::string, std::string> > &
-         filename_hdu_pairs(aeff_hdus("EFF_AREA"));
-      for (size_t j(0); j < aeff_hdus.numEpochs(); j++) {
-         double epoch_start(EpochDep::epochStart(filename_hdu_pairs[j].first,
-                                                 filename_hdu_pairs[j].second));
-         irfInterface::IAeff * aeff_component(new Aeff(aeff_hdus, j));
-         my_aeff->addAeff(*aeff_component, epoch_start);
-         delete aeff_component;
+      for (size_t j(0); j < components.size(); j++) {
+         my_aeff->addAeff(*components[j], epoch_starts[j]);
+         delete components[j];
       }
       return my_aeff;
    }
@@ -171,15 +369,15 @@ IrfLoader::psf(const irfUtil::IrfHdus & psf_hdus) {
    if (psf_hdus.numEpochs() == 1) {
       return psf(psf_hdus, 0);
    } else {
+      std::vector<irfInterface::IPsf *> components;
+      std::vector<double> epoch_starts;
+      build_epochs<irfInterface::IPsf>(psf_hdus, "RPSF", &IrfLoader::psf,
+                                       s_parallel_loading, components,
+                                       epoch_starts);
       PsfEpochDep * my_psf(new PsfEpochDep());
-      const std::vector<std::pair<std::string, std::string> > &
-         filename_hdu_pairs(psf_hdus("RPSF"));
-      for (size_t j(0); j < psf_hdus.numEpochs(); j++) {
-         double epoch_start(EpochDep::epochStart(filename_hdu_pairs[j].first,
-                                                 filename_hdu_pairs[j].second));
-         irfInterface::IPsf * psf_component(psf(psf_hdus, j));
-         my_psf->addPsf(*psf_component, epoch_start);
-         delete psf_component;
+      for (size_t j(0); j < components.size(); j++) {
+         my_psf->addPsf(*components[j], epoch_starts[j]);
+         delete components[j];
       }
       return my_psf;
    }
@@ -195,10 +393,16 @@ irfInterface::IPsf * IrfLoader::psf(const irfUtil::IrfHdus & psf_hdus,
    const std::string & extname(filename_hdu_pairs[iepoch].second);
    switch (psfVersion(psf_file, extname)) {
    case 1:
-      return new Psf(psf_file, psf_hdus.convType()==0, extname);
+      {
+         FitsLock lock;
+         return new Psf(psf_file, psf_hdus.convType()==0, extname);
+      }
       break;
    case 2:
-      return new Psf2(psf_file, psf_hdus.convType()==0, extname);
+      {
+         FitsLock lock;
+         return new Psf2(psf_file, psf_hdus.convType()==0, extname);
+      }
       break;
    case 3:
       return new Psf3(psf_hdus, iepoch);
@@ -214,15 +418,16 @@ IrfLoader::edisp(const irfUtil::IrfHdus & edisp_hdus) {
    if (edisp_hdus.numEpochs() == 1) {
       return edisp(edisp_hdus, 0);
    } else {
+      std::vector<irfInterface::IEdisp *> components;
+      std::vector<double> epoch_starts;
+      build_epochs<irfInterface::IEdisp>(edisp_hdus, "EDISP",
+                                         &IrfLoader::edisp,
+                                         s_parallel_loading, components,
+                                         epoch_starts);
       EdispEpochDep * my_edisp(new EdispEpochDep());
-      const std::vector<std::pair<std::string, std::string> > &
-         filename_hdu_pairs(edisp_hdus("EDISP"));
-      for (size_t j(0); j < edisp_hdus.numEpochs(); j++) {
-         double epoch_start(EpochDep::epochStart(filename_hdu_pairs[j].first,
-                                                 filename_hdu_pairs[j].second));
-         irfInterface::IEdisp * edisp_component(edisp(edisp_hdus, j));
-         my_edisp->addEdisp(*edisp_component, epoch_start);
-         delete edisp_component;
+      for (size_t j(0); j < components.size(); j++) {
+         my_edisp->addEdisp(*components[j], epoch_starts[j]);
+         delete components[j];
       }
       return my_edisp;
    }
@@ -237,10 +442,16 @@ IrfLoader::edisp(const irfUtil::IrfHdus & edisp_hdus, size_t iepoch) {
    const std::string & extname(filename_hdu_pairs[iepoch].second);
    switch (edispVersion(edisp_file, extname)) {
    case 1:
-      return new Edisp(edisp_file, extname);
+      {
+         FitsLock lock;
+         return new Edisp(edisp_file, extname);
+      }
       break;
    case 2:
-      return new Edisp2(edisp_file, extname);
+      {
+         FitsLock lock;
+         return new Edisp2(edisp_file, extname);
+      }
       break;
    case 3:
       return new Edisp3(edisp_hdus, iepoch);
@@ -257,18 +468,20 @@ IrfLoader::efficiency_factor(const irfUtil::IrfHdus & aeff_hdus) {
    if (aeff_hdus.numEpochs() == 1) {
       my_eff = new EfficiencyFactor(aeff_hdus, 0);
    } else {
-      my_eff = new EfficiencyFactorEpochDep();
-      const std::vector<std::pair<std::string, std::string> > &
-         filename_hdu_pairs(aeff_hdus("EFFICIENCY_PARS"));
-      for (size_t j(0); j < aeff_hdus.numEpochs(); j++) {
-         double epoch_start(EpochDep::epochStart(filename_hdu_pairs[j].first,
-                                                 filename_hdu_pairs[j].second));
-         irfInterface::IEfficiencyFactor * 
-            eff_component(new EfficiencyFactor(aeff_hdus, j));
-         dynamic_cast<EfficiencyFactorEpochDep *>(my_eff)->add(*eff_component,
-                                                               epoch_start);
-         delete eff_component;
+      std::vector<irfInterface::IEfficiencyFactor *> components;
+      std::vector<double> epoch_starts;
+      build_epochs<irfInterface::IEfficiencyFactor>(aeff_hdus,
+                                                    "EFFICIENCY_PARS",
+                                                    &new_efficiency_factor,
+                                                    s_parallel_loading,
+                                                    components,
+                                                    epoch_starts);
+      EfficiencyFactorEpochDep * my_eff_epochs(new EfficiencyFactorEpochDep());
+      for (size_t j(0); j < components.size(); j++) {
+         my_eff_epochs->add(*components[j], epoch_starts[j]);
+         delete components[j];
       }
+      my_eff = my_eff_epochs;
    }
    return my_eff;
 }
@@ -386,6 +599,12 @@ void IrfLoader::find_cif(std::string & caldb_indx) const {
 
 int IrfLoader::edispVersion(const std::string & fitsfile, 
                             const std::string & extname) {
+   FitsLock lock;
+   std::string key(IrfSnapshot::key("EDISPVER", fitsfile, extname));
+   const IrfSnapshot::Record * record(IrfSnapshot::lookup(key));
+   if (record) {
+      return static_cast<int>(record->data(0)[0]);
+   }
    const tip::Table * table = 
       tip::IFileSvc::instance().readTable(fitsfile, extname);
    int version(1);
@@ -395,11 +614,22 @@ int IrfLoader::edispVersion(const std::string & fitsfile,
       /// EDISPVER keyword is (probably) missing, so assume default version
    }
    delete table;
+   if (IrfSnapshot::recorder()) {
+      IrfSnapshot::recorder()->add(key, fitsfile, std::vector<std::string>(),
+                                   std::vector<std::vector<double> >
+                                   (1, std::vector<double>(1, version)));
+   }
    return version;
 }
 
 int IrfLoader::psfVersion(const std::string & fitsfile, 
                           const std::string & extname) {
+   FitsLock lock;
+   std::string key(IrfSnapshot::key("PSFVER", fitsfile, extname));
+   const IrfSnapshot::Record * record(IrfSnapshot::lookup(key));
+   if (record) {
+      return static_cast<int>(record->data(0)[0]);
+   }
    const tip::Table * table = 
       tip::IFileSvc::instance().readTable(fitsfile, extname);
    int version(1);
@@ -409,6 +639,11 @@ int IrfLoader::psfVersion(const std::string & fitsfile,
       /// PSFVER keyword is (probably) missing, so assume default version
    }
    delete table;
+   if (IrfSnapshot::recorder()) {
+      IrfSnapshot::recorder()->add(key, fitsfile, std::vector<std::string>(),
+                                   std::vector<std::vector<double> >
+                                   (1, std::vector<double>(1, version)));
+   }
    return version;
 }
 
@@ -0,0 +1,391 @@
+/**
+ * @file IrfSnapshot.cxx
+ * @brief Implementation of the IRF snapshot.
+ *
+ * @author J. Chiang
+ *
+ * $Header$
+ */
+
+#include <stdint.h>
+#include <sys/stat.h>
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "irfInterface/Instrumentation.h"
+
+#include "latResponse/IrfSnapshot.h"
+#include "FitsLock.h"
+
+namespace {
+   irfInterface::Counter s_hits("IrfSnapshot/hits");
+   irfInterface::Counter s_misses("IrfSnapshot/misses");
+
+   const char s_magic[8] = {'I', 'R', 'F', 'S', 'N', 'A', 'P', '\0'};
+   const uint32_t s_byteOrderMark(0x01020304);
+
+   size_t padded(size_t nbytes) {
+      return (nbytes + 7) & ~static_cast<size_t>(7);
+   }
+
+   bool fileStamp(const std::string & filename, long & mtime, long & size) {
+      struct stat info;
+      if (::stat(filename.c_str(), &info) != 0) {
+         return false;
+      }
+      mtime = static_cast<long>(info.st_mtime);
+      size = static_cast<long>(info.st_size);
+      return true;
+   }
+
+   class Writer {
+   public:
+      Writer(std::ostream & out) : m_out(out), m_count(0) {}
+      template <typename T>
+      void put(const T & value) {
+         m_out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+         m_count += sizeof(T);
+      }
+      void put(const std::string & value) {
+         m_out.write(value.data(), value.size());
+         m_count += value.size();
+      }
+      void put(const std::vector<double> & values) {
+         put(static_cast<uint64_t>(values.size()));
+         if (!values.empty()) {
+            m_out.write(reinterpret_cast<const char *>(&values[0]),
+                        values.size()*sizeof(double));
+            m_count += values.size()*sizeof(double);
+         }
+      }
+      void align() {
+         static const char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+         size_t npad(padded(m_count) - m_count);
+         m_out.write(zeros, npad);
+         m_count += npad;
+      }
+   private:
+      std::ostream & m_out;
+      size_t m_count;
+   };
+
+   class Reader {
+   public:
+      Reader(const char * buffer, size_t length, const std::string & filename)
+         : m_buffer(buffer), m_length(length), m_pos(0),
+           m_filename(filename) {}
+      template <typename T>
+      T get() {
+         require(sizeof(T));
+         T value;
+         std::memcpy(&value, m_buffer + m_pos, sizeof(T));
+         m_pos += sizeof(T);
+         return value;
+      }
+      std::string get(size_t nchars) {
+         require(nchars);
+         std::string value(m_buffer + m_pos, nchars);
+         m_pos += nchars;
+         return value;
+      }
+      const double * array(size_t npts) {
+         require(npts*sizeof(double));
+         const double * data
+            = reinterpret_cast<const double *>(m_buffer + m_pos);
+         m_pos += npts*sizeof(double);
+         return data;
+      }
+      void align() {
+         m_pos = padded(m_pos);
+      }
+      void seek(size_t pos) {
+         m_pos = pos;
+      }
+      size_t pos() const {
+         return m_pos;
+      }
+   private:
+      const char * m_buffer;
+      size_t m_length;
+      size_t m_pos;
+      const std::string & m_filename;
+      void require(size_t nbytes) const {
+         if (m_pos + nbytes > m_length) {
+            throw std::runtime_error("latResponse::IrfSnapshot: "
+                                     "truncated snapshot file "
+                                     + m_filename);
+         }
+      }
+   };
+}
+
+namespace latResponse {
+
+const unsigned int IrfSnapshot::s_version(1);
+
+IrfSnapshot * IrfSnapshot::s_loaded(0);
+
+IrfSnapshot * IrfSnapshot::s_recorder(0);
+
+void IrfSnapshot::Record::copy(size_t i, std::vector<double> & values) const {
+   values.assign(data(i), data(i) + size(i));
+}
+
+IrfSnapshot::IrfSnapshot() : m_buffer(0), m_length(0), m_mapped(false) {}
+
+IrfSnapshot::IrfSnapshot(const std::string & filename)
+   : m_buffer(0), m_length(0), m_mapped(false) {
+#ifndef WIN32
+   int fd(::open(filename.c_str(), O_RDONLY));
+   if (fd < 0) {
+      throw std::runtime_error("latResponse::IrfSnapshot: cannot open "
+                               + filename);
+   }
+   struct stat info;
+   if (::fstat(fd, &info) != 0 || info.st_size == 0) {
+      ::close(fd);
+      throw std::runtime_error("latResponse::IrfSnapshot: cannot stat "
+                               + filename);
+   }
+   m_length = static_cast<size_t>(info.st_size);
+   void * address(::mmap(0, m_length, PROT_READ, MAP_SHARED, fd, 0));
+   ::close(fd);
+   if (address == MAP_FAILED) {
+      throw std::runtime_error("latResponse::IrfSnapshot: cannot map "
+                               + filename);
+   }
+   m_buffer = static_cast<char *>(address);
+   m_mapped = true;
+#else
+   std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+   if (!file) {
+      throw std::runtime_error("latResponse::IrfSnapshot: cannot open "
+                               + filename);
+   }
+   file.seekg(0, std::ios::end);
+   m_length = static_cast<size_t>(file.tellg());
+   file.seekg(0, std::ios::beg);
+   // Allocate as doubles to guarantee alignment of the array data.
+   m_buffer = reinterpret_cast<char *>(new double[m_length/sizeof(double) + 1]);
+   file.read(m_buffer, m_length);
+#endif
+   try {
+      readIndex(filename);
+   } catch (...) {
+#ifndef WIN32
+      ::munmap(m_buffer, m_length);
+#else
+      delete [] reinterpret_cast<double *>(m_buffer);
+#endif
+      throw;
+   }
+}
+
+IrfSnapshot::~IrfSnapshot() {
+   if (m_buffer) {
+#ifndef WIN32
+      if (m_mapped) {
+         ::munmap(m_buffer, m_length);
+      }
+#else
+      delete [] reinterpret_cast<double *>(m_buffer);
+#endif
+   }
+}
+
+void IrfSnapshot::readIndex(const std::string & filename) {
+   Reader reader(m_buffer, m_length, filename);
+   std::string magic(reader.get(sizeof(s_magic)));
+   if (std::memcmp(magic.data(), s_magic, sizeof(s_magic)) != 0) {
+      throw std::runtime_error("latResponse::IrfSnapshot: " + filename
+                               + " is not an IRF snapshot file.");
+   }
+   uint32_t version(reader.get<uint32_t>());
+   uint32_t byteOrder(reader.get<uint32_t>());
+   if (version != s_version || byteOrder != s_byteOrderMark) {
+      std::ostringstream message;
+      message << "latResponse::IrfSnapshot: " << filename
+              << " has format version " << version
+              << "; version " << s_version
+              << " in native byte order is required.";
+      throw std::runtime_error(message.str());
+   }
+   uint64_t nrecords(reader.get<uint64_t>());
+   for (uint64_t irec(0); irec < nrecords; irec++) {
+      size_t start(reader.pos());
+      uint64_t recordSize(reader.get<uint64_t>());
+      uint32_t keyLength(reader.get<uint32_t>());
+      uint32_t sourceLength(reader.get<uint32_t>());
+      Record record;
+      record.m_mtime = static_cast<long>(reader.get<int64_t>());
+      record.m_fileSize = static_cast<long>(reader.get<int64_t>());
+      uint32_t nnames(reader.get<uint32_t>());
+      uint32_t narrays(reader.get<uint32_t>());
+      std::string key(reader.get(keyLength));
+      record.m_source = reader.get(sourceLength);
+      for (uint32_t i(0); i < nnames; i++) {
+         uint32_t length(reader.get<uint32_t>());
+         record.m_names.push_back(reader.get(length));
+      }
+      reader.align();
+      for (uint32_t i(0); i < narrays; i++) {
+         uint64_t npts(reader.get<uint64_t>());
+         record.m_sizes.push_back(static_cast<size_t>(npts));
+         record.m_data.push_back(reader.array(static_cast<size_t>(npts)));
+      }
+      m_records[key] = record;
+      reader.seek(start + static_cast<size_t>(recordSize));
+   }
+}
+
+const IrfSnapshot::Record * IrfSnapshot::find(const std::string & key) const {
+   FitsLock lock;
+   std::map<std::string, Record>::const_iterator it(m_records.find(key));
+   if (it == m_records.end() || !isCurrent(it->second)) {
+      return 0;
+   }
+   return &(it->second);
+}
+
+bool IrfSnapshot::isCurrent(const Record & record) const {
+   std::map<std::string, bool>::const_iterator it
+      = m_current.find(record.m_source);
+   if (it != m_current.end()) {
+      return it->second;
+   }
+   long mtime, size;
+   bool current(fileStamp(record.m_source, mtime, size)
+                && mtime == record.m_mtime && size == record.m_fileSize);
+   m_current[record.m_source] = current;
+   return current;
+}
+
+void IrfSnapshot::add(const std::string & key, const std::string & source,
+                      const std::vector<std::string> & names,
+                      const std::vector<std::vector<double> > & arrays) {
+   FitsLock lock;
+   Entry & entry(m_entries[key]);
+   entry.source = source;
+   entry.names = names;
+   entry.arrays = arrays;
+}
+
+void IrfSnapshot::write(const std::string & filename) const {
+   std::ofstream file(filename.c_str(),
+                      std::ios::out | std::ios::trunc | std::ios::binary);
+   if (!file) {
+      throw std::runtime_error("latResponse::IrfSnapshot: cannot write to "
+                               + filename);
+   }
+   Writer writer(file);
+   writer.put(std::string(s_magic, sizeof(s_magic)));
+   writer.put(static_cast<uint32_t>(s_version));
+   writer.put(s_byteOrderMark);
+   writer.put(static_cast<uint64_t>(m_entries.size()));
+
+   std::map<std::string, Entry>::const_iterator it(m_entries.begin());
+   for ( ; it != m_entries.end(); ++it) {
+      const std::string & key(it->first);
+      const Entry & entry(it->second);
+      long mtime(0), size(0);
+      if (!fileStamp(entry.source, mtime, size)) {
+         throw std::runtime_error("latResponse::IrfSnapshot: cannot stat "
+                                  + entry.source);
+      }
+      // Compute the padded record size so that a reader can skip
+      // over records it does not understand.
+      size_t recordSize(sizeof(uint64_t) + 4*sizeof(uint32_t)
+                        + 2*sizeof(int64_t)
+                        + key.size() + entry.source.size());
+      for (size_t i(0); i < entry.names.size(); i++) {
+         recordSize += sizeof(uint32_t) + entry.names[i].size();
+      }
+      recordSize = padded(recordSize);
+      for (size_t i(0); i < entry.arrays.size(); i++) {
+         recordSize += sizeof(uint64_t)
+            + entry.arrays[i].size()*sizeof(double);
+      }
+      writer.put(static_cast<uint64_t>(recordSize));
+      writer.put(static_cast<uint32_t>(key.size()));
+      writer.put(static_cast<uint32_t>(entry.source.size()));
+      writer.put(static_cast<int64_t>(mtime));
+      writer.put(static_cast<int64_t>(size));
+      writer.put(static_cast<uint32_t>(entry.names.size()));
+      writer.put(static_cast<uint32_t>(entry.arrays.size()));
+      writer.put(key);
+      writer.put(entry.source);
+      for (size_t i(0); i < entry.names.size(); i++) {
+         writer.put(static_cast<uint32_t>(entry.names[i].size()));
+         writer.put(entry.names[i]);
+      }
+      writer.align();
+      for (size_t i(0); i < entry.arrays.size(); i++) {
+         writer.put(entry.arrays[i]);
+      }
+   }
+   if (!file) {
+      throw std::runtime_error("latResponse::IrfSnapshot: error writing "
+                               + filename);
+   }
+}
+
+size_t IrfSnapshot::size() const {
+   return m_buffer ? m_records.size() : m_entries.size();
+}
+
+void IrfSnapshot::load(const std::string & filename) {
+   IrfSnapshot * snapshot(new IrfSnapshot(filename));
+   delete s_loaded;
+   s_loaded = snapshot;
+}
+
+void IrfSnapshot::unload() {
+   delete s_loaded;
+   s_loaded = 0;
+}
+
+const IrfSnapshot::Record * IrfSnapshot::lookup(const std::string & key) {
+   if (s_loaded == 0) {
+      return 0;
+   }
+   const Record * record(s_loaded->find(key));
+   (record ? s_hits : s_misses).add();
+   return record;
+}
+
+void IrfSnapshot::startRecording() {
+   if (s_recorder == 0) {
+      s_recorder = new IrfSnapshot();
+   }
+}
+
+void IrfSnapshot::stopRecording() {
+   delete s_recorder;
+   s_recorder = 0;
+}
+
+IrfSnapshot * IrfSnapshot::recorder() {
+   return s_recorder;
+}
+
+std::string IrfSnapshot::key(const std::string & kind,
+                             const std::string & fitsfile,
+                             const std::string & extname,
+                             const std::string & tablename,
+                             size_t nrow) {
+   std::ostringstream key;
+   key << kind << ":" << fitsfile << "[" << extname << "]:"
+       << tablename << ":" << nrow;
+   return key.str();
+}
+
+} // namespace latResponse
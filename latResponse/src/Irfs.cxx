@@ -8,13 +8,35 @@
  * $Header$
  */
 
+#include "irfInterface/Instrumentation.h"
+
 #include "irfUtil/EventTypeMapper.h"
 #include "irfUtil/IrfHdus.h"
 
 #include "latResponse/IrfLoader.h"
 
+#include "FitsLock.h"
 #include "Irfs.h"
 
+namespace {
+   irfInterface::Counter s_aeffTime("Irfs::aeff/build seconds");
+   irfInterface::Counter s_psfTime("Irfs::psf/build seconds");
+   irfInterface::Counter s_edispTime("Irfs::edisp/build seconds");
+   irfInterface::Counter 
+   s_efficiencyFactorTime("Irfs::efficiencyFactor/build seconds");
+
+   typedef irfUtil::IrfHdus (*HdusFactory_t)(const std::string &,
+                                             const std::string &);
+
+   irfUtil::IrfHdus irf_hdus(HdusFactory_t factory,
+                             const std::string & irf_name,
+                             const std::string & event_type) {
+      /// The CALDB index lookups read FITS files.
+      latResponse::FitsLock lock;
+      return factory(irf_name, event_type);
+   }
+}
+
 namespace latResponse {
 
 Irfs::Irfs(const std::string & irfName, const std::string & eventType)
@@ -31,7 +53,9 @@ Irfs::Irfs(const Irfs & other)
 
 irfInterface::IAeff * Irfs::aeff() {
    if (irfInterface::Irfs::aeff() == 0) {
-      irfUtil::IrfHdus hdus(irfUtil::IrfHdus::aeff(m_irfName, m_eventType));
+      irfInterface::ScopedTimer timer(s_aeffTime);
+      irfUtil::IrfHdus hdus(irf_hdus(&irfUtil::IrfHdus::aeff,
+                                     m_irfName, m_eventType));
       setAeff(IrfLoader::aeff(hdus));
    }
    return irfInterface::Irfs::aeff();
@@ -39,7 +63,9 @@ irfInterface::IAeff * Irfs::aeff() {
 
 const irfInterface::IEfficiencyFactor * Irfs::efficiencyFactor() const {
    if (irfInterface::Irfs::efficiencyFactor() == 0) {
-      irfUtil::IrfHdus hdus(irfUtil::IrfHdus::aeff(m_irfName, m_eventType));
+      irfInterface::ScopedTimer timer(s_efficiencyFactorTime);
+      irfUtil::IrfHdus hdus(irf_hdus(&irfUtil::IrfHdus::aeff,
+                                     m_irfName, m_eventType));
       irfInterface::IEfficiencyFactor * eff(IrfLoader::efficiency_factor(hdus));
       if (eff) {
          const_cast<latResponse::Irfs *>(this)->setEfficiencyFactor(eff);
@@ -51,7 +77,9 @@ const irfInterface::IEfficiencyFactor * Irfs::efficiencyFactor() const {
 
 irfInterface::IPsf * Irfs::psf() {
    if (irfInterface::Irfs::psf() == 0) {
-      irfUtil::IrfHdus hdus(irfUtil::IrfHdus::psf(m_irfName, m_eventType));
+      irfInterface::ScopedTimer timer(s_psfTime);
+      irfUtil::IrfHdus hdus(irf_hdus(&irfUtil::IrfHdus::psf,
+                                     m_irfName, m_eventType));
       setPsf(IrfLoader::psf(hdus));
    }
    return irfInterface::Irfs::psf();
@@ -59,7 +87,9 @@ irfInterface::IPsf * Irfs::psf() {
 
 irfInterface::IEdisp * Irfs::edisp() {
    if (irfInterface::Irfs::edisp() == 0) {
-      irfUtil::IrfHdus hdus(irfUtil::IrfHdus::edisp(m_irfName, m_eventType));
+      irfInterface::ScopedTimer timer(s_edispTime);
+      irfUtil::IrfHdus hdus(irf_hdus(&irfUtil::IrfHdus::edisp,
+                                     m_irfName, m_eventType));
       setEdisp(IrfLoader::edisp(hdus));
    }
    return irfInterface::Irfs::edisp();
@@ -14,13 +14,31 @@
 #include "tip/IFileSvc.h"
 #include "tip/Table.h"
 
+#include "latResponse/IrfSnapshot.h"
 #include "latResponse/ParTables.h"
+#include "FitsLock.h"
 
 namespace latResponse {
 
 ParTables::ParTables(const std::string & fitsfile,
                      const std::string & extname,
                      size_t nrow) {
+   FitsLock lock;
+   std::string key(IrfSnapshot::key("ParTables", fitsfile, extname, "", nrow));
+   const IrfSnapshot::Record * record(IrfSnapshot::lookup(key));
+   if (record) {
+      for (size_t i(0); i < record->names().size(); i++) {
+         const std::string & tablename(record->names()[i]);
+         m_parNames.push_back(tablename);
+         m_parIndices[i] = tablename;
+         m_parTables.insert(
+            std::map<std::string, FitsTable>::
+            value_type(tablename,
+                       FitsTable(fitsfile, extname, tablename, nrow)));
+      }
+      return;
+   }
+
    tip::IFileSvc & fileSvc(tip::IFileSvc::instance());
    const tip::Table * table(fileSvc.readTable(fitsfile, extname));
    const std::vector<std::string> & validFields(table->getValidFields());
@@ -50,6 +68,11 @@ ParTables::ParTables(const std::string & fitsfile,
          value_type(tablename, FitsTable(fitsfile, extname, tablename, nrow)));
    }
    delete table;
+
+   if (IrfSnapshot::recorder()) {
+      IrfSnapshot::recorder()->add(key, fitsfile, m_parNames,
+                                   std::vector<std::vector<double> >());
+   }
 }
 
 const FitsTable & ParTables::operator[](const std::string & parName) const {
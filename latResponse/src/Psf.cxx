@@ -50,6 +50,16 @@ Psf::~Psf() {
    delete m_integralCache;
 }
 
+void Psf::setAccuracy(irfInterface::Accuracy::Mode mode) {
+   if (mode != accuracy()) {
+      delete m_integralCache;
+      m_integralCache = 0;
+      m_loge_last = 0;
+      m_costh_last = 0;
+   }
+   PsfBase::setAccuracy(mode);
+}
+
 double Psf::value(const astro::SkyDir & appDir, 
                   double energy, 
                   const astro::SkyDir & srcDir, 
@@ -223,7 +233,7 @@ double * Psf::pars(double energy, double costh) const {
    static double theta_max(M_PI/2.);
    if (energy < 120.) { // Use the *correct* integral of Psf over solid angle.
       PsfIntegrand foo(m_pars);
-      double err(1e-5);
+      double err(irfInterface::Accuracy::tolerance(accuracy(), 1e-5));
       int ierr;
       norm = st_facilities::GaussianQuadrature::dgaus8(foo, 0, theta_max,
                                                        err, ierr);
@@ -97,6 +97,10 @@ public:
       return new Psf(*this);
    }
 
+   /// Set the accuracy, discarding the cached angular integrals and
+   /// normalization computed at a different accuracy.
+   virtual void setAccuracy(irfInterface::Accuracy::Mode mode);
+
    /// Functions from handoff_response.
    static double old_base_function(double u, double sigma, double gamma);
 
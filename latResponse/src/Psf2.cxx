@@ -221,7 +221,7 @@ double * Psf2::pars(double energy, double costh) const {
    static double theta_max(M_PI/2.);
    if (energy < 120.) { // Use the *correct* integral of Psf2 over solid angle.
       Psf2Integrand foo(m_pars);
-      double err(1e-5);
+      double err(irfInterface::Accuracy::tolerance(accuracy(), 1e-5));
       int ierr;
       norm = st_facilities::GaussianQuadrature::dgaus8(foo, 0, theta_max,
                                                        err, ierr);
@@ -17,16 +17,24 @@
 #include "tip/IFileSvc.h"
 #include "tip/Table.h"
 
+#include "irfInterface/Instrumentation.h"
+
 #include "irfUtil/IrfHdus.h"
 
 #include "latResponse/Bilinear.h"
 #include "latResponse/FitsTable.h"
+#include "latResponse/IrfLoader.h"
+#include "latResponse/IrfSnapshot.h"
 
 #include "Psf2.h"
 #include "latResponse/Psf3.h"
 #include "PsfIntegralCache.h"
+#include "FitsLock.h"
 
 namespace {
+   irfInterface::Counter s_valueCalls("Psf3::value/calls");
+   irfInterface::Counter s_angularIntegralCalls("Psf3::angularIntegral/calls");
+
    double sqr(double x) {
       return x*x;
    }
@@ -51,16 +59,23 @@ Psf3::Psf3(const irfUtil::IrfHdus & psf_hdus, size_t iepoch, size_t nrow)
              psf_hdus("RPSF").at(iepoch).second,
              psf_hdus("PSF_SCALING").at(iepoch).second),
      m_integralCache(0) {
-   readFits(psf_hdus("RPSF").at(iepoch).first,
-            psf_hdus("RPSF").at(iepoch).second, nrow);
-   normalize_pars();
+   const std::string & fitsfile(psf_hdus("RPSF").at(iepoch).first);
+   const std::string & extname(psf_hdus("RPSF").at(iepoch).second);
+   if (!restoreSnapshot(fitsfile, extname, nrow)) {
+      readFits(fitsfile, extname, nrow);
+      normalize_pars();
+      recordSnapshot(fitsfile, extname, nrow);
+   }
 }
 
 Psf3::Psf3(const std::string & fitsfile, bool isFront,
            const std::string & extname, size_t nrow) 
    : PsfBase(fitsfile, isFront, extname), m_integralCache(0) {
-   readFits(fitsfile, extname, nrow);
-   normalize_pars();
+   if (!restoreSnapshot(fitsfile, extname, nrow)) {
+      readFits(fitsfile, extname, nrow);
+      normalize_pars();
+      recordSnapshot(fitsfile, extname, nrow);
+   }
 }
 
 Psf3::Psf3(const Psf3 & other) : PsfBase(other),
@@ -88,6 +103,14 @@ Psf3::~Psf3() {
    delete m_integralCache;
 }
 
+void Psf3::setAccuracy(irfInterface::Accuracy::Mode mode) {
+   if (mode != accuracy()) {
+      delete m_integralCache;
+      m_integralCache = 0;
+   }
+   PsfBase::setAccuracy(mode);
+}
+
 double Psf3::value(const astro::SkyDir & appDir, 
                     double energy, 
                     const astro::SkyDir & srcDir, 
@@ -105,6 +128,7 @@ double Psf3::value(double separation, double energy, double theta,
                     double phi, double time) const {
    (void)(phi);
    (void)(time);
+   s_valueCalls.add();
 
    double tt, uu;
    std::vector<double> cornerEnergies(4);
@@ -123,6 +147,7 @@ double Psf3::value(double separation, double energy, double theta,
 
 double Psf3::angularIntegral(double energy, double theta, 
                               double phi, double radius, double time) const {
+   s_angularIntegralCalls.add();
    if (energy < 120.) {
       double value = IPsf::angularIntegral(energy, theta, phi, radius, time);
       return value;
@@ -172,11 +197,15 @@ double Psf3::angularIntegral(double energy,
                               double time) {
    (void)(phi);
    (void)(time);
+   s_angularIntegralCalls.add();
 
    irfInterface::AcceptanceCone & cone(*acceptanceCones.at(0));
    if (!m_integralCache || cone != m_integralCache->acceptanceCone()) {
       delete m_integralCache;
       m_integralCache = new PsfIntegralCache(*this, cone);
+      if (IrfLoader::eager_psf_integrals()) {
+         fillIntegralCache();
+      }
    }
 
    double tt, uu;
@@ -236,6 +265,22 @@ double Psf3::angularIntegral(double energy, double psi,
    return y;
 }
 
+void Psf3::fillIntegralCache() {
+   // angularIntegral only evaluates the parameters at the grid
+   // points, so these are the only sigma and gamma values needed.
+   std::vector<double> sigmas;
+   std::vector<double> gammas;
+   for (size_t indx(0); indx < m_parVectors.size(); indx++) {
+      const std::vector<double> & pars(m_parVectors[indx]);
+      double energy(m_energies[indx % m_energies.size()]);
+      sigmas.push_back(pars[2]*scaleFactor(energy));
+      gammas.push_back(pars[4]);
+      sigmas.push_back(pars[3]*scaleFactor(energy));
+      gammas.push_back(pars[5]);
+   }
+   m_integralCache->fill(sigmas, gammas);
+}
+
 double Psf3::evaluate(double energy, double sep, const double * pars) const {
    double ncore(pars[0]);
    double ntail(pars[1]);
@@ -256,6 +301,7 @@ double Psf3::evaluate(double energy, double sep, const double * pars) const {
 void Psf3::readFits(const std::string & fitsfile,
                      const std::string & extname, 
                      size_t nrow) {
+   FitsLock lock;
    tip::IFileSvc & fileSvc(tip::IFileSvc::instance());
    const tip::Table * table(fileSvc.readTable(fitsfile, extname));
    const std::vector<std::string> & validFields(table->getValidFields());
@@ -281,6 +327,7 @@ void Psf3::readFits(const std::string & fitsfile,
    FitsTable::getVectorData(table, "ENERG_LO", elo, nrow);
    FitsTable::getVectorData(table, "ENERG_HI", ehi, nrow);
    std::vector<double> logEs;
+   logEs.reserve(elo.size());
    for (size_t k(0); k < elo.size(); k++) {
       logEs.push_back(std::log10(std::sqrt(elo[k]*ehi[k])));
    }
@@ -289,6 +336,7 @@ void Psf3::readFits(const std::string & fitsfile,
    FitsTable::getVectorData(table, "CTHETA_LO", mulo, nrow);
    FitsTable::getVectorData(table, "CTHETA_HI", muhi, nrow);
    std::vector<double> cosths;
+   cosths.reserve(muhi.size());
    for (size_t i(0); i < muhi.size(); i++) {
       cosths.push_back((mulo[i] + muhi[i])/2.);
    }
@@ -354,6 +402,7 @@ void Psf3::generateBoundaries(const std::vector<double> & x,
    yout.back() = yhi;
 
    Array array(values, x.size());
+   values_out.reserve((x.size() + 2)*(y.size() + 2));
    values_out.push_back(array(0, 0));
    for (size_t i(0); i < x.size(); i++) {
       values_out.push_back(array(0, i));
@@ -393,6 +442,51 @@ void Psf3::normalize_pars(double radius) {
    }
 }
 
+bool Psf3::restoreSnapshot(const std::string & fitsfile,
+                           const std::string & extname,
+                           size_t nrow) {
+   const IrfSnapshot::Record * 
+      record(IrfSnapshot::lookup(IrfSnapshot::key("Psf3", fitsfile,
+                                                  extname, "", nrow)));
+   if (!record) {
+      return false;
+   }
+   record->copy(0, m_logEs);
+   record->copy(1, m_energies);
+   record->copy(2, m_cosths);
+   record->copy(3, m_thetas);
+   size_t ncells(m_logEs.size()*m_cosths.size());
+   size_t npars(record->size(4)/ncells);
+   const double * pars(record->data(4));
+   m_parVectors.resize(ncells);
+   for (size_t i(0); i < ncells; i++) {
+      m_parVectors[i].assign(pars + i*npars, pars + (i + 1)*npars);
+   }
+   return true;
+}
+
+void Psf3::recordSnapshot(const std::string & fitsfile,
+                          const std::string & extname,
+                          size_t nrow) const {
+   IrfSnapshot * recorder(IrfSnapshot::recorder());
+   if (!recorder) {
+      return;
+   }
+   std::vector<std::vector<double> > arrays;
+   arrays.push_back(m_logEs);
+   arrays.push_back(m_energies);
+   arrays.push_back(m_cosths);
+   arrays.push_back(m_thetas);
+   // The normalized parameters, stored cell by cell.
+   std::vector<double> pars;
+   for (size_t i(0); i < m_parVectors.size(); i++) {
+      pars.insert(pars.end(), m_parVectors[i].begin(), m_parVectors[i].end());
+   }
+   arrays.push_back(pars);
+   recorder->add(IrfSnapshot::key("Psf3", fitsfile, extname, "", nrow),
+                 fitsfile, std::vector<std::string>(), arrays);
+}
+
 void Psf3::getCornerPars(double energy, double theta,
                           double & tt, double & uu,
                           std::vector<double> & cornerEnergies,
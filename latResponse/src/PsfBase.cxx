@@ -10,9 +10,6 @@
 #include <cmath>
 #include <algorithm>
 
-#include "tip/IFileSvc.h"
-#include "tip/Table.h"
-
 #include "latResponse/FitsTable.h"
 
 #include "latResponse/PsfBase.h"
@@ -72,12 +69,9 @@ void PsfBase::readScaling(const std::string & fitsfile, bool isFront,
    /// used.
    (void)(isFront);
 
-   tip::IFileSvc & fileSvc(tip::IFileSvc::instance());
-   const tip::Table * table(fileSvc.readTable(fitsfile, extname));
-
    std::vector<double> values;
 
-   FitsTable::getVectorData(table, "PSFSCALE", values);
+   FitsTable::getVectorData(fitsfile, extname, "PSFSCALE", values);
    
    m_par0 = values.at(0);
    m_par1 = values.at(1);
@@ -85,8 +79,6 @@ void PsfBase::readScaling(const std::string & fitsfile, bool isFront,
 
    m_psf_pars.resize(values.size());
    std::copy(values.begin(), values.end(), m_psf_pars.begin());
-
-   delete table;
 }
 
 } // namespace latResponse
@@ -82,6 +82,14 @@ void PsfEpochDep::addPsf(const irfInterface::IPsf & psf,
                          double epoch_start) {
    appendEpoch(epoch_start);
    m_psfs.push_back(const_cast<irfInterface::IPsf &>(psf).clone());
+   m_psfs.back()->setAccuracy(accuracy());
+}
+
+void PsfEpochDep::setAccuracy(irfInterface::Accuracy::Mode mode) {
+   irfInterface::IPsf::setAccuracy(mode);
+   for (size_t i(0); i < m_psfs.size(); i++) {
+      m_psfs[i]->setAccuracy(mode);
+   }
 }
 
 } // namespace latResponse
@@ -58,6 +58,9 @@ public:
       return new PsfEpochDep(*this);
    }
 
+   /// Set the accuracy of this object and of the Psf for each epoch.
+   virtual void setAccuracy(irfInterface::Accuracy::Mode mode);
+
    void addPsf(const irfInterface::IPsf & psf, double epoch_start);
 
 private:
@@ -9,30 +9,73 @@
  * $Header$
  */
 
+#include <cmath>
+
 #include <algorithm>
 #include <fstream>
+#include <limits>
+#include <map>
 #include <stdexcept>
-
-#include "st_facilities/GaussianQuadrature.h"
+#include <utility>
 
 #include "st_stream/StreamFormatter.h"
 
 #include "irfInterface/AcceptanceCone.h"
+#include "irfInterface/Instrumentation.h"
 
 #include "latResponse/PsfBase.h"
-#include "Psf.h"
+#include "GaussLegendre.h"
 #include "PsfIntegralCache.h"
 
+namespace {
+   irfInterface::Counter s_constructions("PsfIntegralCache/constructions");
+   irfInterface::Counter s_constructionTime("PsfIntegralCache/build seconds");
+   irfInterface::Counter s_hits("PsfIntegralCache/hits");
+   irfInterface::Counter s_misses("PsfIntegralCache/misses");
+   irfInterface::Counter s_outOfRange("PsfIntegralCache/out of range");
+   irfInterface::Counter 
+   s_integrandEvals("PsfIntegralCache/integrand evaluations");
+   irfInterface::Counter 
+   s_quadratureTime("PsfIntegralCache/quadrature seconds");
+   irfInterface::Counter s_filledCells("PsfIntegralCache/precomputed cells");
+   irfInterface::Counter s_fillTime("PsfIntegralCache/fill seconds");
+   irfInterface::Counter s_allocatedRows("PsfIntegralCache/allocated rows");
+
+   /// The King function integrals are done in terms of
+   /// q = (1 + u/gamma)^(1 - gamma), u = (theta/sigma)^2/2, for which
+   /// K(u) du = -dq.  This absorbs the peak of the Psf at small
+   /// separations, leaving sin(theta)/theta and the azimuthal factor
+   /// as the integrand.
+   double kingVariable(double theta, double sigma, double gamma) {
+      double u(theta*theta/sigma/sigma/2.);
+      return std::pow(1. + u/gamma, 1. - gamma);
+   }
+
+   double sinc(double theta) {
+      return theta > 0 ? std::sin(theta)/theta : 1.;
+   }
+
+   // ugly kluge because of sloppy programming in handoff_response
+   // when setting boundaries of fit parameters for the PSF
+   // (cf. Psf::old_base_function).
+   double kingGamma(double gamma) {
+      return gamma == 1 ? 1.001 : gamma;
+   }
+}
+
 namespace latResponse {
 
 PsfIntegralCache::
 PsfIntegralCache(const PsfBase & psf, irfInterface::AcceptanceCone & cone) 
    : m_psf(psf), m_acceptanceCone(cone.clone()), 
-     m_calls(0), m_interpolations(0), m_cpuTotal(0),
+     m_axes(&sharedAxes(psf)), m_psis(m_axes->psis),
+     m_gammas(m_axes->gammas), m_sigmas(m_axes->sigmas),
+     m_angularIntegral(m_psis.size()), m_calls(0), m_interpolations(0), m_cpuTotal(0),
      m_gamma_avg(0), m_sigma_avg(0), m_integralEvals(0),
      m_gamma_max(0), m_gamma_min(100), m_sigma_max(0), m_sigma_min(100) {
-   fillParamArrays();
-   setupAngularIntegrals();
+   s_constructions.add();
+   irfInterface::ScopedTimer timer(s_constructionTime);
+   setupQuadrature();
 }
 
 PsfIntegralCache::~PsfIntegralCache() {
@@ -58,6 +101,7 @@ angularIntegral(double sigma, double gamma, size_t ipsi) const {
    m_calls++;
    if (sigma < m_sigmas.front() || sigma > m_sigmas.back() ||
        gamma < m_gammas.front() || gamma > m_gammas.back()) {
+      s_outOfRange.add();
       double value = psfIntegral(m_psis.at(ipsi), sigma, gamma)/sigma/sigma;
       return value;
    }
@@ -70,16 +114,19 @@ angularIntegral(double sigma, double gamma, size_t ipsi) const {
    size_t is[2] = {isig, isig + 1};
    size_t ig[2] = {igam, igam + 1};
 
+   std::vector<float> & integrals(row(ipsi));
    for (size_t i(0); i < 2; i++) {
       for (size_t j(0); j < 2; j++) {
          size_t indx(is[i]*m_gammas.size() + ig[j]);
-         if (m_needIntegral.at(ipsi).at(indx)) {
+         if (isMissing(integrals.at(indx))) {
+            s_misses.add();
             m_interpolations++;
-            m_angularIntegral.at(ipsi).at(indx) =
+            integrals.at(indx) =
                psfIntegral(m_psis.at(ipsi), m_sigmas.at(is[i]), 
                            m_gammas.at(ig[j]))
                /m_sigmas.at(is[i])/m_sigmas.at(is[i]);
-            m_needIntegral.at(ipsi).at(indx) = false;
+         } else {
+            s_hits.add();
          }
       }
    }
@@ -88,6 +135,81 @@ angularIntegral(double sigma, double gamma, size_t ipsi) const {
    return value;
 }
 
+void PsfIntegralCache::fill(const std::vector<double> & sigmas,
+                            const std::vector<double> & gammas) {
+   if (sigmas.size() != gammas.size()) {
+      throw std::invalid_argument("PsfIntegralCache::fill: sigmas and "
+                                  "gammas must have the same size.");
+   }
+   irfInterface::ScopedTimer timer(s_fillTime);
+
+   // Find the (sigma, gamma) grid points that angularIntegral will
+   // use for these parameters.
+   size_t ngam(m_gammas.size());
+   std::vector<bool> needed(m_sigmas.size()*ngam, false);
+   for (size_t k(0); k < sigmas.size(); k++) {
+      double sigma(sigmas[k]);
+      double gamma(gammas[k]);
+      if (sigma < m_sigmas.front() || sigma > m_sigmas.back() ||
+          gamma < m_gammas.front() || gamma > m_gammas.back()) {
+         continue;
+      }
+      size_t isig(std::upper_bound(m_sigmas.begin(), m_sigmas.end(), sigma)
+                  - m_sigmas.begin() - 1);
+      size_t igam(std::upper_bound(m_gammas.begin(), m_gammas.end(), gamma)
+                  - m_gammas.begin() - 1);
+      for (size_t i(isig); i < isig + 2; i++) {
+         for (size_t j(igam); j < igam + 2; j++) {
+            needed.at(i*ngam + j) = true;
+         }
+      }
+   }
+   std::vector<size_t> cells;
+   for (size_t indx(0); indx < needed.size(); indx++) {
+      if (needed[indx]) {
+         cells.push_back(indx);
+      }
+   }
+
+   // Fill the psi rows in ten batches, reporting after each one.
+   // The rows are allocated on a single thread before each batch.
+   st_stream::StreamFormatter formatter("PsfIntegralCache", "fill", 3);
+   size_t npsi(m_psis.size());
+   size_t nbatches(std::min(npsi, static_cast<size_t>(10)));
+   for (size_t batch(0); batch < nbatches; batch++) {
+      size_t psi_begin(batch*npsi/nbatches);
+      size_t psi_end((batch + 1)*npsi/nbatches);
+      std::vector<std::pair<size_t, size_t> > tasks;
+      for (size_t ipsi(psi_begin); ipsi < psi_end; ipsi++) {
+         if (cells.empty()) {
+            break;
+         }
+         std::vector<float> & integrals(row(ipsi));
+         for (size_t k(0); k < cells.size(); k++) {
+            if (isMissing(integrals[cells[k]])) {
+               tasks.push_back(std::make_pair(ipsi, cells[k]));
+            }
+         }
+      }
+      int ntasks(static_cast<int>(tasks.size()));
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16)
+#endif
+      for (int i = 0; i < ntasks; i++) {
+         size_t ipsi(tasks[i].first);
+         size_t indx(tasks[i].second);
+         double sigma(m_sigmas[indx/ngam]);
+         double gamma(m_gammas[indx % ngam]);
+         m_angularIntegral[ipsi][indx] = 
+            roiIntegral(m_psis[ipsi], sigma, gamma)/sigma/sigma;
+      }
+      s_filledCells.add(ntasks);
+      formatter.info(3) << "PsfIntegralCache::fill: "
+                        << (batch + 1)*100/nbatches << "% of "
+                        << npsi*cells.size() << " cells done" << std::endl;
+   }
+}
+
 double PsfIntegralCache::bilinear(double sigma, double gamma, size_t ipsi,
                                   size_t isig, size_t igam) const {
    double tt = ( (gamma - m_gammas.at(igam))
@@ -126,107 +248,164 @@ psfIntegral(double psi, double sigma, double gamma) const {
       m_sigma_min = sigma;
    }
 
+   double value(roiIntegral(psi, sigma, gamma));
+   m_cpuTotal += (std::clock() - start_time)/1e6;
+   return value;
+}
+
+double PsfIntegralCache::
+roiIntegral(double psi, double sigma, double gamma) const {
    double roi_radius(m_acceptanceCone->radius()*M_PI/180.);
-   double one(1.);
    double mup(std::cos(roi_radius + psi));
    double mum(std::cos(roi_radius - psi));
 
-//   double err(1e-5);
-   double err(1e-3);
-   int ierr(0);
-
+   irfInterface::ScopedTimer timer(s_quadratureTime);
    double firstIntegral(0);
    if ( mum < 0.99 ) {
-      PsfIntegrand1 psfIntegrand1(sigma, gamma);
-      firstIntegral = 
-         st_facilities::GaussianQuadrature::dgaus8(psfIntegrand1, mum,
-                                                   one, err, ierr);
+      firstIntegral = coreIntegral(std::acos(mum), sigma, gamma);
    }
    
-   double secondIntegral(0);
-   PsfIntegrand2 psfIntegrand2(sigma, gamma, psi, roi_radius);
-   secondIntegral =
-      st_facilities::GaussianQuadrature::dgaus8(psfIntegrand2, mup, mum, 
-                                                err, ierr);
+   double secondIntegral(arcIntegral(psi, roi_radius, std::acos(mum),
+                                     std::acos(mup), sigma, gamma));
    
-   m_cpuTotal += (std::clock() - start_time)/1e6;
    double value = firstIntegral + secondIntegral;
    return value;
 }
 
-PsfIntegralCache::PsfIntegrand1::PsfIntegrand1(double sigma, double gamma)
-   : m_sigma(sigma), m_gamma(gamma) {}
+void PsfIntegralCache::setupQuadrature() {
+   size_t order(irfInterface::Accuracy::npts(m_psf.accuracy(), 16));
+   GaussLegendre rule(order);
+   rule.nodes(0, 1, m_coreNodes, m_coreWeights);
+
+   // The azimuthal factor phimin has square-root behavior at both
+   // ends of the arc integral, so substitute x = (1 - cos(t))/2 and
+   // apply the rule for t in [0, pi].
+   rule.nodes(0, M_PI, m_arcNodes, m_arcWeights);
+   for (size_t i(0); i < order; i++) {
+      m_arcWeights[i] *= std::sin(m_arcNodes[i])/2.;
+      m_arcNodes[i] = (1. - std::cos(m_arcNodes[i]))/2.;
+   }
+}
 
-double PsfIntegralCache::PsfIntegrand1::operator()(double mu) const {
-   double r(std::acos(mu)/m_sigma);
-   double u(r*r/2.);
-   return 2.*M_PI*Psf::old_base_function(u, m_sigma, m_gamma);
+double PsfIntegralCache::
+coreIntegral(double theta_max, double sigma, double gamma) const {
+   gamma = kingGamma(gamma);
+   double qmin(kingVariable(theta_max, sigma, gamma));
+   double exponent(1./(1. - gamma));
+   const double * nodes(&m_coreNodes[0]);
+   const double * weights(&m_coreWeights[0]);
+   int npts(static_cast<int>(m_coreNodes.size()));
+   double sum(0);
+// The nodes are independent, so let the compiler vectorize this loop.
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd reduction(+:sum)
+#endif
+   for (int i = 0; i < npts; i++) {
+      double q(qmin + (1. - qmin)*nodes[i]);
+      double u(gamma*(std::pow(q, exponent) - 1.));
+      double theta(sigma*std::sqrt(2.*std::max(u, 0.)));
+      sum += weights[i]*sinc(theta);
+   }
+   s_integrandEvals.add(npts);
+   return 2.*M_PI*sigma*sigma*(1. - qmin)*sum;
 }
 
-PsfIntegralCache::PsfIntegrand2::
-PsfIntegrand2(double sigma, double gamma, double psi, double roi_radius)
-   : m_sigma(sigma), m_gamma(gamma), m_cp(std::cos(psi)), 
-     m_sp(std::sin(psi)), m_cr(std::cos(roi_radius)) {}
+double PsfIntegralCache::
+arcIntegral(double psi, double roi_radius, double theta_min, 
+            double theta_max, double sigma, double gamma) const {
+   if (theta_max <= theta_min) {
+      return 0;
+   }
+   gamma = kingGamma(gamma);
+   double q1(kingVariable(theta_min, sigma, gamma));
+   double q2(kingVariable(theta_max, sigma, gamma));
+   double exponent(1./(1. - gamma));
+   double cp(std::cos(psi));
+   double sp(std::sin(psi));
+   double cr(std::cos(roi_radius));
+   const double * nodes(&m_arcNodes[0]);
+   const double * weights(&m_arcWeights[0]);
+   int npts(static_cast<int>(m_arcNodes.size()));
+   double sum(0);
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd reduction(+:sum)
+#endif
+   for (int i = 0; i < npts; i++) {
+      double q(q2 + (q1 - q2)*nodes[i]);
+      double u(gamma*(std::pow(q, exponent) - 1.));
+      double theta(sigma*std::sqrt(2.*std::max(u, 0.)));
+      double arg((cr - std::cos(theta)*cp)/std::sin(theta)/sp);
+      double phimin(arg >= 1. ? 0 : (arg <= -1. ? M_PI : std::acos(arg)));
+      sum += weights[i]*phimin*sinc(theta);
+   }
+   s_integrandEvals.add(npts);
+   return 2.*sigma*sigma*(q1 - q2)*sum;
+}
 
-double PsfIntegralCache::PsfIntegrand2::operator()(double mu) const {
-   double r(std::acos(mu)/m_sigma);
-   double u(r*r/2.);
-   double phimin(0);
-   double arg((m_cr - mu*m_cp)/std::sqrt(1. - mu*mu)/m_sp);
-   if (arg >= 1.) {
-      phimin = 0;
-   } else if (arg <= -1.) {
-      phimin = M_PI;
-   } else {
-      phimin = std::acos(arg);
+std::vector<float> & PsfIntegralCache::row(size_t ipsi) const {
+   std::vector<float> & integrals(m_angularIntegral.at(ipsi));
+   if (integrals.empty()) {
+      s_allocatedRows.add();
+      integrals.resize(m_gammas.size()*m_sigmas.size(),
+                       std::numeric_limits<float>::quiet_NaN());
    }
-   return 2.*phimin*Psf::old_base_function(u, m_sigma, m_gamma);
+   return integrals;
 }
 
-void PsfIntegralCache::setupAngularIntegrals() {
-   m_angularIntegral.clear();
-   m_needIntegral.clear();
-   size_t npts(m_gammas.size()*m_sigmas.size());
-   for (size_t i(0); i < m_psis.size(); i++) {
-      std::vector<double> drow(npts, 0);
-      std::vector<bool> brow(npts, true);
-      m_angularIntegral.push_back(drow);
-      m_needIntegral.push_back(brow);
+const PsfIntegralCache::Axes & 
+PsfIntegralCache::sharedAxes(const PsfBase & psf) {
+   size_t nsig(100);
+// Smallest angular scales expected at highest energies.
+//    double sigmin(m_psf.scaleFactor(5.62e6)*0.15);
+//    double sigmax(m_psf.scaleFactor(30)*2.0);
+/// @todo Remove dependence on isFront for range of sigma values.  This is
+/// done here in order to check consistency against handoff_response.
+   bool isFront;
+   double sigmin(psf.scaleFactor(5.62e6, isFront=true)*0.15);
+   double sigmax(psf.scaleFactor(30, isFront=false)*2.0);
+
+   // The Axes are never deleted, but there is one for each set of
+   // PSF scaling parameters, of which there are few.
+   static std::map<std::pair<double, double>, Axes *> s_axes;
+   Axes * axes(0);
+#ifdef _OPENMP
+#pragma omp critical(latResponse_PsfIntegralCache_axes)
+#endif
+   {
+      Axes *& entry(s_axes[std::make_pair(sigmin, sigmax)]);
+      if (entry == 0) {
+         entry = new Axes();
+         fillParamArrays(sigmin, sigmax, nsig, *entry);
+      }
+      axes = entry;
    }
+   return *axes;
 }
 
-void PsfIntegralCache::fillParamArrays() {
+void PsfIntegralCache::fillParamArrays(double sigmin, double sigmax,
+                                       size_t nsig, Axes & axes) {
    size_t npsi(500);
    double psimin(1E-2*M_PI/180.);
    double psimax(180*M_PI/180.);
-   logArray(psimin, psimax, npsi, m_psis);
-   m_psis.insert(m_psis.begin(),0.0);
+   logArray(psimin, psimax, npsi, axes.psis);
+   axes.psis.insert(axes.psis.begin(),0.0);
 
    size_t ngam_fine(100);
    size_t ngam_coarse(25);
 // These upper and lower values mirror the parameter fit boundaries in
 // PointSpreadFunction.cxx, which are also inside anonymous namespace
 // and so are inaccessible outside of that file.
-   linearArray(1, 1.2, ngam_fine, m_gammas);
-   m_gammas.pop_back();
-   linearArray(1.2, 5.1, ngam_fine, m_gammas, false);
-//    linearArray(1.2, 5., ngam_coarse, m_gammas, false);
-//    linearArray(5., 21., ngam_coarse, m_gammas, false);
+   linearArray(1, 1.2, ngam_fine, axes.gammas);
+   axes.gammas.pop_back();
+   linearArray(1.2, 5.1, ngam_fine, axes.gammas, false);
+//    linearArray(1.2, 5., ngam_coarse, axes.gammas, false);
+//    linearArray(5., 21., ngam_coarse, axes.gammas, false);
 
-   size_t nsig(100);
-// Smallest angular scales expected at highest energies.
-//    double sigmin(m_psf.scaleFactor(5.62e6)*0.15);
-//    double sigmax(m_psf.scaleFactor(30)*2.0);
-/// @todo Remove dependence on isFront for range of sigma values.  This is
-/// done here in order to check consistency against handoff_response.
-   bool isFront;
-   double sigmin(m_psf.scaleFactor(5.62e6, isFront=true)*0.15);
-   double sigmax(m_psf.scaleFactor(30, isFront=false)*2.0);
-   logArray(sigmin, sigmax, nsig, m_sigmas);
+   logArray(sigmin, sigmax, nsig, axes.sigmas);
 }
 
 void PsfIntegralCache::linearArray(double xmin, double xmax, size_t nx, 
-                                   std::vector<double> & xx, bool clear) const {
+                                   std::vector<double> & xx, bool clear) {
    if (clear) {
       xx.clear();
    }
@@ -237,7 +416,7 @@ void PsfIntegralCache::linearArray(double xmin, double xmax, size_t nx,
 }
 
 void PsfIntegralCache::logArray(double xmin, double xmax, size_t nx, 
-                                std::vector<double> & xx, bool clear) const {
+                                std::vector<double> & xx, bool clear) {
    if (clear) {
       xx.clear();
    }
@@ -42,6 +42,15 @@ public:
 
    double angularIntegral(double sigma, double gamma, size_t psi) const;
 
+   /// Compute, for every psi value, the cached integrals at the grid
+   /// points bracketing each (sigmas[i], gammas[i]) pair, so that
+   /// later calls to angularIntegral with those parameters do no
+   /// integrations.  Pairs outside the grid are skipped.  The work
+   /// is shared among threads if OpenMP is enabled, and the progress
+   /// is reported via st_stream.
+   void fill(const std::vector<double> & sigmas,
+             const std::vector<double> & gammas);
+
    const std::vector<double> & psis() const {
       return m_psis;
    }
@@ -56,12 +65,28 @@ private:
 
    irfInterface::AcceptanceCone * m_acceptanceCone;
    
-   std::vector<double> m_psis;
-   std::vector<double> m_gammas;
-   std::vector<double> m_sigmas;
+   /// The psi, gamma and sigma grid points.  These depend only on
+   /// the range of sigma values, so caches with the same range share
+   /// one instance.
+   struct Axes {
+      std::vector<double> psis;
+      std::vector<double> gammas;
+      std::vector<double> sigmas;
+   };
+
+   const Axes * m_axes;
 
-   mutable std::vector< std::vector<bool> > m_needIntegral;
-   mutable std::vector< std::vector<double> > m_angularIntegral;
+   const std::vector<double> & m_psis;
+   const std::vector<double> & m_gammas;
+   const std::vector<double> & m_sigmas;
+
+   /// Integrals for each psi, indexed by isig*m_gammas.size() + igam.
+   /// A row is allocated when one of its cells is first needed, and
+   /// cells that have not been computed hold NaN.  The values are
+   /// stored as floats: the rounding error, < 6e-8 relative, is
+   /// negligible compared to the quadrature error (see
+   /// setupQuadrature) and to that of the bilinear interpolation.
+   mutable std::vector< std::vector<float> > m_angularIntegral;
 
    mutable int m_calls;
    mutable int m_interpolations;
@@ -78,40 +103,48 @@ private:
    mutable double m_sigma_max;
    mutable double m_sigma_min;
 
-   void linearArray(double xmin, double xmax, size_t nx,
-                    std::vector<double> & xx, bool clear=true) const;
+   static void linearArray(double xmin, double xmax, size_t nx,
+                           std::vector<double> & xx, bool clear=true);
+
+   static void logArray(double xmin, double xmax, size_t nx,
+                        std::vector<double> & xx, bool clear=true);
+
+   static const Axes & sharedAxes(const PsfBase & psf);
+   static void fillParamArrays(double sigmin, double sigmax, size_t nsig,
+                               Axes & axes);
 
-   void logArray(double xmin, double xmax, size_t nx,
-                 std::vector<double> & xx, bool clear=true) const;
+   /// @return The integrals for psi index ipsi, allocating them if
+   ///         necessary.
+   std::vector<float> & row(size_t ipsi) const;
 
-   void fillParamArrays();
-   void setupAngularIntegrals();
+   static bool isMissing(float value) {
+      return value != value;
+   }
 
    double bilinear(double sigma, double gamma, size_t ipsi,
                    size_t isig, size_t igam) const;
 
    double psfIntegral(double psi, double sigma, double gamma) const;
 
-   class PsfIntegrand1 {
-   public:
-      PsfIntegrand1(double sigma, double gamma);
-      double operator()(double mu) const;
-   private:
-      double m_sigma;
-      double m_gamma;
-   };
+   /// The integral itself, without the bookkeeping in psfIntegral,
+   /// so that it may be called on several threads.
+   double roiIntegral(double psi, double sigma, double gamma) const;
 
-   class PsfIntegrand2 {
-   public:
-      PsfIntegrand2(double sigma, double gamma, double psi, double roi_radius);
-      double operator()(double mu) const;
-   private:
-      double m_sigma;
-      double m_gamma;
-      double m_cp;
-      double m_sp;
-      double m_cr;
-   };
+   /// Gauss-Legendre nodes and weights, mapped onto [0, 1], for the
+   /// integral over the full circle about the source that lies
+   /// inside the ROI ("core") and for the integral over the arcs
+   /// that cross the ROI boundary.
+   std::vector<double> m_coreNodes;
+   std::vector<double> m_coreWeights;
+   std::vector<double> m_arcNodes;
+   std::vector<double> m_arcWeights;
+
+   void setupQuadrature();
+
+   double coreIntegral(double theta_max, double sigma, double gamma) const;
+
+   double arcIntegral(double psi, double roi_radius, double theta_min,
+                      double theta_max, double sigma, double gamma) const;
 
 };
 
@@ -0,0 +1,586 @@
+/**
+ * @file benchmark.cxx
+ * @brief Microbenchmarks of the latResponse IRF components evaluated
+ * over representative distributions of energy and inclination using
+ * the IRF files in the latResponse data directory.
+ *
+ * Results are written as JSON in the layout used by Google Benchmark
+ * (a "context" object and a "benchmarks" array with the iterations,
+ * real_time and cpu_time per iteration of each benchmark) so that
+ * runs from different releases can be compared with the usual tools.
+ *
+ * usage: benchmark_latResponse [--benchmark_filter=<substring>]
+ *                              [--benchmark_min_time=<seconds>]
+ *                              [--benchmark_out=<json file>]
+ *
+ * @author J. Chiang
+ *
+ * $Header$
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "facilities/commonUtilities.h"
+
+#include "st_facilities/Environment.h"
+
+#include "astro/SkyDir.h"
+
+#include "irfInterface/AcceptanceCone.h"
+#include "irfInterface/Accuracy.h"
+#include "irfInterface/Instrumentation.h"
+#include "irfInterface/IrfsFactory.h"
+
+#include "latResponse/Aeff.h"
+#include "latResponse/Edisp3.h"
+#include "latResponse/IrfLoader.h"
+#include "latResponse/Psf3.h"
+
+#include "PsfIntegralCache.h"
+
+using facilities::commonUtilities;
+
+namespace {
+
+/// Sink for benchmark results so that the compiler cannot discard
+/// the calls being timed.
+volatile double s_sink(0);
+
+double wallTime() {
+   return irfInterface::Instrumentation::wallTime();
+}
+
+double cpuTime() {
+   return static_cast<double>(std::clock())/CLOCKS_PER_SEC;
+}
+
+/**
+ * @class Samples
+ * @brief Reproducible photon energies, log-uniform over 30 MeV to
+ * 300 GeV, and inclinations, uniform in cos(theta) over 0 to 70
+ * degrees, roughly as for events from a survey-mode exposure.
+ */
+class Samples {
+public:
+   Samples(size_t nsamples=1024) : m_state(12345) {
+      double emin(30.), emax(3e5);
+      double mumin(std::cos(70.*M_PI/180.));
+      for (size_t i(0); i < nsamples; i++) {
+         energy.push_back(emin*std::exp(uniform()*std::log(emax/emin)));
+         double mu(mumin + uniform()*(1. - mumin));
+         theta.push_back(std::acos(mu)*180./M_PI);
+         phi.push_back(uniform()*360.);
+      }
+   }
+   size_t size() const {
+      return energy.size();
+   }
+   std::vector<double> energy;
+   std::vector<double> theta;
+   std::vector<double> phi;
+private:
+   unsigned long m_state;
+   /// Linear congruential generator, so that the samples do not
+   /// depend on the platform's rand().
+   double uniform() {
+      m_state = (1103515245UL*m_state + 12345UL) % 2147483648UL;
+      return static_cast<double>(m_state)/2147483648.;
+   }
+};
+
+/**
+ * @class Benchmark
+ * @brief Base class for a timed operation.  run(i) is called once
+ * per iteration; i may be used to select the ith sample.  setUp()
+ * and tearDown() are called before and after the iterations and are
+ * not timed.
+ */
+class Benchmark {
+public:
+   Benchmark(const std::string & name) : m_name(name) {}
+   virtual ~Benchmark() {}
+   const std::string & name() const {
+      return m_name;
+   }
+   virtual void setUp() {}
+   virtual void run(size_t i) = 0;
+   virtual void tearDown() {}
+private:
+   std::string m_name;
+};
+
+struct Result {
+   std::string name;
+   size_t iterations;
+   double realTime;
+   double cpuTime;
+   std::string error;
+};
+
+/// Run bench with an increasing number of iterations until the
+/// elapsed time exceeds minTime.  Times are in ns per iteration.
+Result measure(Benchmark & bench, double minTime) {
+   Result result;
+   result.name = bench.name();
+   result.iterations = 0;
+   result.realTime = 0;
+   result.cpuTime = 0;
+   try {
+      bench.setUp();
+      // Warm up, e.g., so that lazily filled caches are built.
+      bench.run(0);
+      size_t niters(1);
+      while (true) {
+         double wall0(wallTime());
+         double cpu0(cpuTime());
+         for (size_t i(0); i < niters; i++) {
+            bench.run(i);
+         }
+         double wall(wallTime() - wall0);
+         double cpu(cpuTime() - cpu0);
+         if (wall >= minTime || niters >= 1000000000) {
+            result.iterations = niters;
+            result.realTime = wall/niters*1e9;
+            result.cpuTime = cpu/niters*1e9;
+            break;
+         }
+         // Aim for 1.4 times the minimum time, as Google Benchmark does.
+         double scale(wall > 0 ? 1.4*minTime/wall : 10.);
+         niters = static_cast<size_t>(niters*std::min(std::max(scale, 2.),
+                                                       10.));
+      }
+   } catch (std::exception & eObj) {
+      result.error = eObj.what();
+   }
+   bench.tearDown();
+   return result;
+}
+
+std::string jsonString(const std::string & value) {
+   std::ostringstream output;
+   output << "\"";
+   for (size_t i(0); i < value.size(); i++) {
+      char c(value[i]);
+      if (c == '"' || c == '\\') {
+         output << '\\' << c;
+      } else if (c == '\n') {
+         output << "\\n";
+      } else if (static_cast<unsigned char>(c) < 0x20) {
+         output << ' ';
+      } else {
+         output << c;
+      }
+   }
+   output << "\"";
+   return output.str();
+}
+
+void writeJson(std::ostream & output, const std::vector<Result> & results) {
+   char date[64];
+   std::time_t now(std::time(0));
+   std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+   output << "{\n"
+          << "  \"context\": {\n"
+          << "    \"date\": " << jsonString(date) << ",\n"
+          << "    \"executable\": \"benchmark_latResponse\",\n"
+          << "    \"library\": \"latResponse\"\n"
+          << "  },\n"
+          << "  \"benchmarks\": [";
+   output << std::setprecision(6);
+   for (size_t i(0); i < results.size(); i++) {
+      const Result & result(results[i]);
+      output << (i ? ",\n" : "\n")
+             << "    {\n"
+             << "      \"name\": " << jsonString(result.name) << ",\n"
+             << "      \"run_name\": " << jsonString(result.name) << ",\n"
+             << "      \"run_type\": \"iteration\",\n";
+      if (result.error != "") {
+         output << "      \"error_occurred\": true,\n"
+                << "      \"error_message\": " << jsonString(result.error)
+                << "\n    }";
+         continue;
+      }
+      output << "      \"iterations\": " << result.iterations << ",\n"
+             << "      \"real_time\": " << result.realTime << ",\n"
+             << "      \"cpu_time\": " << result.cpuTime << ",\n"
+             << "      \"time_unit\": \"ns\"\n"
+             << "    }";
+   }
+   output << "\n  ]\n}" << std::endl;
+}
+
+/// Fixture holding the IRF objects and samples shared by the
+/// component benchmarks.
+struct Irfs {
+   Irfs() {
+      std::string dataPath(st_facilities::Environment::dataPath("latResponse"));
+      aeffFile = commonUtilities::joinPath(dataPath, "aeff_epoch_0.fits");
+      psfFile = commonUtilities::joinPath(dataPath, "psf_epoch_0.fits");
+      edispFile = commonUtilities::joinPath(dataPath, "edisp_epoch_0.fits");
+      aeff = new latResponse::Aeff(aeffFile);
+      psf = new latResponse::Psf3(psfFile);
+      edisp = new latResponse::Edisp3(edispFile);
+   }
+   ~Irfs() {
+      delete aeff;
+      delete psf;
+      delete edisp;
+   }
+   std::string aeffFile;
+   std::string psfFile;
+   std::string edispFile;
+   latResponse::Aeff * aeff;
+   latResponse::Psf3 * psf;
+   latResponse::Edisp3 * edisp;
+   Samples samples;
+};
+
+/// Base class for benchmarks that evaluate an IRF at the ith sample.
+class IrfBenchmark : public Benchmark {
+public:
+   IrfBenchmark(const std::string & name, Irfs & irfs)
+      : Benchmark(name), m_irfs(irfs) {}
+protected:
+   Irfs & m_irfs;
+   size_t sample(size_t i) const {
+      return i % m_irfs.samples.size();
+   }
+   double energy(size_t i) const {
+      return m_irfs.samples.energy[sample(i)];
+   }
+   double theta(size_t i) const {
+      return m_irfs.samples.theta[sample(i)];
+   }
+   double phi(size_t i) const {
+      return m_irfs.samples.phi[sample(i)];
+   }
+};
+
+class AeffValue : public IrfBenchmark {
+public:
+   AeffValue(Irfs & irfs) : IrfBenchmark("Aeff::value", irfs) {}
+   virtual void run(size_t i) {
+      s_sink = m_irfs.aeff->value(energy(i), theta(i), phi(i));
+   }
+};
+
+/// Each iteration evaluates all of the samples in one call.
+class AeffValueBatch : public IrfBenchmark {
+public:
+   AeffValueBatch(Irfs & irfs) : IrfBenchmark("Aeff::value/batch", irfs) {}
+   virtual void run(size_t i) {
+      (void)(i);
+      std::vector<double> values(m_irfs.aeff->value(m_irfs.samples.energy,
+                                                    m_irfs.samples.theta,
+                                                    m_irfs.samples.phi));
+      s_sink = values.back();
+   }
+};
+
+/// Each iteration fills an energy x cos(theta) matrix, as for an
+/// exposure calculation.
+class AeffValueMatrix : public IrfBenchmark {
+public:
+   AeffValueMatrix(Irfs & irfs) : IrfBenchmark("Aeff::valueMatrix", irfs) {
+      for (size_t i(0); i < 100; i++) {
+         m_energies.push_back(30.*std::pow(1e4, i/99.));
+      }
+      for (size_t j(0); j < 40; j++) {
+         m_costhetas.push_back(1. - 0.025*(j + 0.5));
+      }
+   }
+   virtual void run(size_t i) {
+      (void)(i);
+      m_irfs.aeff->valueMatrix(m_energies, m_costhetas, m_values);
+      s_sink = m_values.back();
+   }
+private:
+   std::vector<double> m_energies;
+   std::vector<double> m_costhetas;
+   std::vector<double> m_values;
+};
+
+class Psf3Value : public IrfBenchmark {
+public:
+   Psf3Value(Irfs & irfs) : IrfBenchmark("Psf3::value", irfs) {}
+   virtual void run(size_t i) {
+      // Separations spanning the core and tail of the PSF.
+      double sep(0.01*(1 + i % 500));
+      s_sink = m_irfs.psf->value(sep, energy(i), theta(i), phi(i));
+   }
+};
+
+class Psf3AngularIntegral : public IrfBenchmark {
+public:
+   Psf3AngularIntegral(Irfs & irfs)
+      : IrfBenchmark("Psf3::angularIntegral", irfs) {}
+   virtual void run(size_t i) {
+      double radius(0.5*(1 + i % 20));
+      s_sink = m_irfs.psf->angularIntegral(energy(i), theta(i), phi(i),
+                                           radius);
+   }
+};
+
+class Psf3AngularContainment : public IrfBenchmark {
+public:
+   Psf3AngularContainment(Irfs & irfs)
+      : IrfBenchmark("Psf3::angularContainment", irfs) {}
+   virtual void run(size_t i) {
+      s_sink = m_irfs.psf->angularContainment(energy(i), theta(i), phi(i),
+                                              0.68);
+   }
+};
+
+class Psf3AngularIntegralCones : public IrfBenchmark {
+public:
+   Psf3AngularIntegralCones(Irfs & irfs)
+      : IrfBenchmark("Psf3::angularIntegral/AcceptanceCone", irfs),
+        m_roiCenter(83.57, 22.01), m_srcDir(83.63, 22.01) {
+      m_cones.push_back(new irfInterface::AcceptanceCone(m_roiCenter, 10.));
+   }
+   virtual ~Psf3AngularIntegralCones() {
+      delete m_cones.front();
+   }
+   virtual void run(size_t i) {
+      s_sink = m_irfs.psf->angularIntegral(energy(i), m_srcDir, theta(i),
+                                           phi(i), m_cones);
+   }
+private:
+   astro::SkyDir m_roiCenter;
+   astro::SkyDir m_srcDir;
+   std::vector<irfInterface::AcceptanceCone *> m_cones;
+};
+
+class IPsfAppDir : public IrfBenchmark {
+public:
+   IPsfAppDir(Irfs & irfs) : IrfBenchmark("IPsf::appDir", irfs),
+                             m_zAxis(0, 0), m_xAxis(90, 0) {}
+   virtual void run(size_t i) {
+      astro::SkyDir srcDir(phi(i), 90. - theta(i));
+      s_sink = m_irfs.psf->appDir(energy(i), srcDir, m_zAxis,
+                                  m_xAxis).ra();
+   }
+private:
+   astro::SkyDir m_zAxis;
+   astro::SkyDir m_xAxis;
+};
+
+class Edisp3Value : public IrfBenchmark {
+public:
+   Edisp3Value(Irfs & irfs) : IrfBenchmark("Edisp3::value", irfs) {}
+   virtual void run(size_t i) {
+      // Measured energies within +/-50% of the true energy.
+      double emeas(energy(i)*(0.5 + 0.01*(i % 100)));
+      s_sink = m_irfs.edisp->value(emeas, energy(i), theta(i), phi(i));
+   }
+};
+
+class IEdispIntegral : public IrfBenchmark {
+public:
+   IEdispIntegral(Irfs & irfs) : IrfBenchmark("IEdisp::integral", irfs) {}
+   virtual void run(size_t i) {
+      s_sink = m_irfs.edisp->integral(energy(i)/2., energy(i)*2., energy(i),
+                                      theta(i), phi(i));
+   }
+};
+
+class IEdispAppEnergy : public IrfBenchmark {
+public:
+   IEdispAppEnergy(Irfs & irfs) : IrfBenchmark("IEdisp::appEnergy", irfs),
+                                  m_zAxis(0, 0), m_xAxis(90, 0) {}
+   virtual void run(size_t i) {
+      astro::SkyDir srcDir(phi(i), 90. - theta(i));
+      s_sink = m_irfs.edisp->appEnergy(energy(i), srcDir, m_zAxis, m_xAxis);
+   }
+private:
+   astro::SkyDir m_zAxis;
+   astro::SkyDir m_xAxis;
+};
+
+/// The quadrature in IPsf, which Psf3 uses below 120 MeV.
+class IPsfAngularIntegral : public IrfBenchmark {
+public:
+   IPsfAngularIntegral(Irfs & irfs)
+      : IrfBenchmark("IPsf::angularIntegral", irfs) {}
+   virtual void run(size_t i) {
+      double radius(0.5*(1 + i % 20));
+      s_sink = m_irfs.psf->irfInterface::IPsf::angularIntegral(energy(i),
+                                                              theta(i), 
+                                                              phi(i), radius);
+   }
+};
+
+/// Run another benchmark with the psf and edisp integrations set to
+/// a given accuracy.
+class AccuracyBenchmark : public Benchmark {
+public:
+   AccuracyBenchmark(Benchmark * bench, Irfs & irfs,
+                     irfInterface::Accuracy::Mode mode,
+                     const std::string & label)
+      : Benchmark(bench->name() + "/" + label), m_bench(bench),
+        m_irfs(irfs), m_mode(mode) {}
+   virtual ~AccuracyBenchmark() {
+      delete m_bench;
+   }
+   virtual void setUp() {
+      setAccuracy(m_mode);
+      m_bench->setUp();
+   }
+   virtual void run(size_t i) {
+      m_bench->run(i);
+   }
+   virtual void tearDown() {
+      m_bench->tearDown();
+      setAccuracy(irfInterface::Accuracy::DEFAULT);
+   }
+private:
+   Benchmark * m_bench;
+   Irfs & m_irfs;
+   irfInterface::Accuracy::Mode m_mode;
+   void setAccuracy(irfInterface::Accuracy::Mode mode) {
+      m_irfs.psf->setAccuracy(mode);
+      m_irfs.edisp->setAccuracy(mode);
+   }
+};
+
+class PsfIntegralCacheConstruction : public IrfBenchmark {
+public:
+   PsfIntegralCacheConstruction(Irfs & irfs)
+      : IrfBenchmark("PsfIntegralCache/construction", irfs),
+        m_cone(astro::SkyDir(83.57, 22.01), 10.) {}
+   virtual void run(size_t i) {
+      (void)(i);
+      latResponse::PsfIntegralCache cache(*m_irfs.psf, m_cone);
+      s_sink = cache.psis().size();
+   }
+private:
+   irfInterface::AcceptanceCone m_cone;
+};
+
+/// Time to construct an IrfLoader, register a single set of Irfs
+/// with the IrfsFactory on demand, as is done for deferred loaders,
+/// and create its aeff, psf and edisp.  This requires CALDB to be
+/// set.
+class LoaderStartup : public Benchmark {
+public:
+   LoaderStartup(const std::string & irfsName="P8R2_SOURCE_V6::FRONT")
+      : Benchmark("IrfLoader/startup"), m_irfsName(irfsName) {}
+   virtual void run(size_t i) {
+      (void)(i);
+      if (::getenv("CALDB") == 0) {
+         throw std::runtime_error("CALDB is not set");
+      }
+      irfInterface::IrfsFactory::delete_instance();
+      latResponse::IrfLoader loader;
+      if (!loader.resolveIrfs(m_irfsName)) {
+         throw std::runtime_error("Cannot resolve " + m_irfsName);
+      }
+      irfInterface::IrfsFactory * factory(irfInterface::IrfsFactory::instance());
+      irfInterface::Irfs * irfs(factory->create(m_irfsName));
+      s_sink = irfs->aeff()->value(1e3, 0, 0)
+         + irfs->psf()->value(0.5, 1e3, 0, 0)
+         + irfs->edisp()->value(1e3, 1e3, 0, 0);
+      delete irfs;
+   }
+private:
+   std::string m_irfsName;
+};
+
+} // anonymous namespace
+
+int main(int iargc, char * argv[]) {
+   std::string filter;
+   std::string outfile;
+   double minTime(0.5);
+   for (int i(1); i < iargc; i++) {
+      std::string arg(argv[i]);
+      if (arg.find("--benchmark_filter=") == 0) {
+         filter = arg.substr(arg.find('=') + 1);
+      } else if (arg.find("--benchmark_min_time=") == 0) {
+         minTime = std::atof(arg.substr(arg.find('=') + 1).c_str());
+      } else if (arg.find("--benchmark_out=") == 0) {
+         outfile = arg.substr(arg.find('=') + 1);
+      } else {
+         std::cerr << "usage: " << argv[0]
+                   << " [--benchmark_filter=<substring>]"
+                   << " [--benchmark_min_time=<seconds>]"
+                   << " [--benchmark_out=<json file>]" << std::endl;
+         return 1;
+      }
+   }
+   try {
+      Irfs irfs;
+
+      std::vector<Benchmark *> benchmarks;
+      benchmarks.push_back(new AeffValue(irfs));
+      benchmarks.push_back(new AeffValueBatch(irfs));
+      benchmarks.push_back(new AeffValueMatrix(irfs));
+      benchmarks.push_back(new Psf3Value(irfs));
+      benchmarks.push_back(new Psf3AngularIntegral(irfs));
+      benchmarks.push_back(new Psf3AngularIntegralCones(irfs));
+      benchmarks.push_back(new Psf3AngularContainment(irfs));
+      benchmarks.push_back(new IPsfAppDir(irfs));
+      benchmarks.push_back(new Edisp3Value(irfs));
+      benchmarks.push_back(new IEdispIntegral(irfs));
+      benchmarks.push_back(new IEdispAppEnergy(irfs));
+      benchmarks.push_back(new PsfIntegralCacheConstruction(irfs));
+      benchmarks.push_back(new LoaderStartup());
+
+      // The integrations at each accuracy setting.
+      const char * labels[] = {"fast", "default", "precise"};
+      irfInterface::Accuracy::Mode modes[] = {irfInterface::Accuracy::FAST,
+                                              irfInterface::Accuracy::DEFAULT,
+                                              irfInterface::Accuracy::PRECISE};
+      for (size_t j(0); j < 3; j++) {
+         std::vector<Benchmark *> integrations;
+         integrations.push_back(new IPsfAngularIntegral(irfs));
+         integrations.push_back(new IEdispIntegral(irfs));
+         integrations.push_back(new IEdispAppEnergy(irfs));
+         for (size_t k(0); k < integrations.size(); k++) {
+            benchmarks.push_back(new AccuracyBenchmark(integrations[k], irfs,
+                                                       modes[j], labels[j]));
+         }
+      }
+
+      std::vector<Result> results;
+      for (size_t i(0); i < benchmarks.size(); i++) {
+         if (filter == ""
+             || benchmarks[i]->name().find(filter) != std::string::npos) {
+            results.push_back(measure(*benchmarks[i], minTime));
+            const Result & result(results.back());
+            std::cerr << std::left << std::setw(40) << result.name;
+            if (result.error != "") {
+               std::cerr << "ERROR: " << result.error << std::endl;
+            } else {
+               std::cerr << std::right << std::setw(14) << std::fixed
+                         << std::setprecision(1) << result.realTime << " ns"
+                         << std::setw(14) << result.cpuTime << " ns"
+                         << std::setw(12) << result.iterations << std::endl;
+            }
+         }
+         delete benchmarks[i];
+      }
+
+      if (outfile != "") {
+         std::ofstream output(outfile.c_str());
+         writeJson(output, results);
+      } else {
+         writeJson(std::cout, results);
+      }
+   } catch (std::exception & eObj) {
+      std::cerr << eObj.what() << std::endl;
+      return 1;
+   }
+   return 0;
+}
@@ -0,0 +1,71 @@
+/**
+ * @file make_irf_snapshot.cxx
+ * @brief Build the IRFs for the requested IRF names and write their
+ * prepared tables to a latResponse::IrfSnapshot file.
+ * @author J. Chiang
+ *
+ * $Header$
+ */
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "irfInterface/Irfs.h"
+#include "irfInterface/IrfsFactory.h"
+
+#include "latResponse/IrfLoader.h"
+#include "latResponse/IrfSnapshot.h"
+
+int main(int iargc, char * argv[]) {
+   if (iargc < 3) {
+      std::cout << "usage: " << argv[0] 
+                << " <output file> <irf name> [<irf name> ...]\n"
+                << "e.g., " << argv[0] 
+                << " P8R3_V3.snapshot P8R3_SOURCE_V3 P8R3_CLEAN_V3\n"
+                << "Set LATRESPONSE_IRF_SNAPSHOT to the output file "
+                << "to use it." << std::endl;
+      return 1;
+   }
+   try {
+      latResponse::IrfSnapshot::startRecording();
+
+      latResponse::IrfLoader loader;
+      loader.loadIrfs();
+
+      irfInterface::IrfsFactory * factory(irfInterface::IrfsFactory::instance());
+      const std::vector<std::string> & names(factory->irfNames());
+      for (int i(2); i < iargc; i++) {
+         std::string prefix(std::string(argv[i]) + "::");
+         size_t nfound(0);
+         for (size_t j(0); j < names.size(); j++) {
+            if (names[j].compare(0, prefix.size(), prefix) != 0) {
+               continue;
+            }
+            std::cout << "Adding " << names[j] << std::endl;
+            irfInterface::Irfs * irfs(factory->create(names[j]));
+            irfs->aeff();
+            irfs->psf();
+            irfs->edisp();
+            irfs->efficiencyFactor();
+            delete irfs;
+            nfound++;
+         }
+         if (nfound == 0) {
+            throw std::invalid_argument("No IRFs found for " 
+                                        + std::string(argv[i]));
+         }
+      }
+
+      latResponse::IrfSnapshot * snapshot(latResponse::IrfSnapshot::recorder());
+      snapshot->write(argv[1]);
+      std::cout << "Wrote " << snapshot->size() << " records to " 
+                << argv[1] << std::endl;
+      latResponse::IrfSnapshot::stopRecording();
+   } catch (std::exception & eObj) {
+      std::cout << eObj.what() << std::endl;
+      return 1;
+   }
+   return 0;
+}
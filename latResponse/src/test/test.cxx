@@ -11,11 +11,18 @@
 #endif
 
 #include <cmath>
+#include <cstdio>
 #include <cstdlib>
 
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <stdexcept>
+#include <vector>
+
+#include <unistd.h>
+
+#include "fitsio.h"
 
 #include <cppunit/ui/text/TextTestRunner.h>
 #include <cppunit/extensions/HelperMacros.h>
@@ -30,8 +37,11 @@
 #include "irfInterface/AcceptanceCone.h"
 
 #include "latResponse/IrfLoader.h"
+#include "latResponse/IrfSnapshot.h"
 
 #include "latResponse/Aeff.h"
+#include "latResponse/FitsTable.h"
+#include "latResponse/ParTables.h"
 #include "latResponse/Psf3.h"
 #include "Edisp2.h"
 #include "EfficiencyFactor.h"
@@ -39,6 +49,7 @@
 #include "PsfEpochDep.h"
 #include "EdispEpochDep.h"
 #include "EfficiencyFactorEpochDep.h"
+#include "GaussLegendre.h"
 
 using facilities::commonUtilities;
 
@@ -51,6 +62,47 @@ namespace {
       }
       return envvar;
    }
+
+   /// Make a new directory under $TMPDIR (or /tmp) for the files
+   /// written by a test, to be removed with ::rmdir once they are.
+   std::string makeTempDir() {
+      char * tmpdir(::getenv("TMPDIR"));
+      std::string dir_template((tmpdir ? tmpdir : "/tmp") 
+                               + std::string("/latResponse_test_XXXXXX"));
+      std::vector<char> path(dir_template.begin(), dir_template.end());
+      path.push_back('\0');
+      if (::mkdtemp(&path[0]) == 0) {
+         throw std::runtime_error("Failed to create a directory from "
+                                  + dir_template);
+      }
+      return &path[0];
+   }
+
+   void writeFt2File(const std::string & ft2file,
+                     std::vector<double> & start,
+                     std::vector<double> & stop,
+                     std::vector<double> & livetime) {
+      std::remove(ft2file.c_str());
+      int status(0);
+      fitsfile * fptr(0);
+      fits_create_file(&fptr, ft2file.c_str(), &status);
+      char * ttype[] = {const_cast<char *>("START"),
+                        const_cast<char *>("STOP"),
+                        const_cast<char *>("LIVETIME")};
+      char * tform[] = {const_cast<char *>("D"), const_cast<char *>("D"),
+                        const_cast<char *>("D")};
+      fits_create_tbl(fptr, BINARY_TBL, 0, 3, ttype, tform, 0,
+                      const_cast<char *>("SC_DATA"), &status);
+      fits_write_col(fptr, TDOUBLE, 1, 1, 1, start.size(), &start[0],
+                     &status);
+      fits_write_col(fptr, TDOUBLE, 2, 1, 1, stop.size(), &stop[0], &status);
+      fits_write_col(fptr, TDOUBLE, 3, 1, 1, livetime.size(), &livetime[0],
+                     &status);
+      fits_close_file(fptr, &status);
+      if (status != 0) {
+         throw std::runtime_error("Failed to write " + ft2file);
+      }
+   }
 }
 
 class LatResponseTests : public CppUnit::TestFixture {
@@ -59,14 +111,27 @@ class LatResponseTests : public CppUnit::TestFixture {
 
    CPPUNIT_TEST(irf_assignment);
 
+   CPPUNIT_TEST(aeff_batch_values);
+   CPPUNIT_TEST(aeff_value_matrix);
+   CPPUNIT_TEST(aeff_upper_limits);
+   CPPUNIT_TEST(fits_table_columns);
+
    CPPUNIT_TEST(psf_zero_separation);
    CPPUNIT_TEST(psf_normalization);
    CPPUNIT_TEST(psf_roi_integral);
+   CPPUNIT_TEST(gauss_legendre);
+   CPPUNIT_TEST(psf_eager_integrals);
 
    CPPUNIT_TEST(edisp_normalization);
    CPPUNIT_TEST(edisp_sampling);
 
    CPPUNIT_TEST(epochDep_tests);
+   CPPUNIT_TEST(efficiency_factor_livetime);
+
+   CPPUNIT_TEST(snapshot_round_trip);
+
+   CPPUNIT_TEST(parallel_prefetch);
+   CPPUNIT_TEST(prefetch_without_efficiency);
 
    CPPUNIT_TEST_SUITE_END();
 
@@ -77,14 +142,27 @@ public:
 
    void irf_assignment();
 
+   void aeff_batch_values();
+   void aeff_value_matrix();
+   void aeff_upper_limits();
+   void fits_table_columns();
+
    void psf_zero_separation();
    void psf_normalization();
    void psf_roi_integral();
+   void gauss_legendre();
+   void psf_eager_integrals();
 
    void edisp_normalization();
    void edisp_sampling();
 
    void epochDep_tests();
+   void efficiency_factor_livetime();
+
+   void snapshot_round_trip();
+
+   void parallel_prefetch();
+   void prefetch_without_efficiency();
 
 private:
 
@@ -123,6 +201,148 @@ void LatResponseTests::irf_assignment() {
    }
 }
 
+void LatResponseTests::aeff_batch_values() {
+   std::string dataPath(st_facilities::Environment::dataPath("latResponse"));
+   std::string aeff_file(commonUtilities::joinPath(dataPath, 
+                                                   "aeff_epoch_0.fits"));
+   latResponse::Aeff aeff(aeff_file);
+   std::vector<double> energies, thetas, phis;
+   for (double energy(20.); energy < 1e6; energy *= 3.1) {
+      for (double theta(0); theta < 95.; theta += 7.) {
+         for (double phi(-180.); phi < 360.; phi += 37.) {
+            energies.push_back(energy);
+            thetas.push_back(theta);
+            phis.push_back(phi);
+         }
+      }
+   }
+   std::vector<double> expected;
+   for (size_t k(0); k < 2; k++) {
+      aeff.setPhiDependence(k == 0);
+      std::vector<double> values(aeff.value(energies, thetas, phis));
+      CPPUNIT_ASSERT(values.size() == energies.size());
+      for (size_t i(0); i < energies.size(); i++) {
+         CPPUNIT_ASSERT(values[i] == aeff.value(energies[i], thetas[i], 
+                                                phis[i]));
+      }
+      if (k == 0) {
+         expected = values;
+      }
+   }
+
+// Apply the phi modulation to the phi-independent values using the
+// parameters from ParTables::getPars, independently of the tables
+// made by Aeff.
+   latResponse::ParTables phiDepPars(aeff_file, "PHI_DEPENDENCE");
+   aeff.setPhiDependence(false);
+   for (size_t i(0); i < energies.size(); i++) {
+      double logE(std::log10(energies[i]));
+      double costheta(std::min(std::cos(thetas[i]*M_PI/180.), 0.99999));
+      double par[2];
+      phiDepPars.getPars(logE, costheta, par, false);
+      double phi(phis[i] < 0 ? phis[i] + 360. : phis[i]);
+      double norm(1./(1. + par[0]/(1. + par[1])));
+      double phi_pv(std::fmod(phi*M_PI/180., M_PI) - M_PI/2.);
+      double xx(2.*std::fabs(2./M_PI*std::fabs(phi_pv) - 0.5));
+      double reference(aeff.value(energies[i], thetas[i], phis[i])
+                       *norm*(1. + par[0]*std::pow(xx, par[1])));
+      CPPUNIT_ASSERT(std::fabs(expected[i] - reference) 
+                     <= 1e-12*reference);
+   }
+}
+
+void LatResponseTests::aeff_value_matrix() {
+   std::string dataPath(st_facilities::Environment::dataPath("latResponse"));
+   std::string aeff_file(commonUtilities::joinPath(dataPath, 
+                                                   "aeff_epoch_0.fits"));
+   latResponse::Aeff aeff(aeff_file);
+   std::vector<double> energies;
+   for (double energy(20.); energy < 1e6; energy *= 2.3) {
+      energies.push_back(energy);
+   }
+   std::vector<double> costhetas;
+   for (double costh(-0.05); costh <= 1.; costh += 0.025) {
+      costhetas.push_back(costh);
+   }
+   std::vector<double> values;
+   aeff.valueMatrix(energies, costhetas, values);
+   CPPUNIT_ASSERT(values.size() == energies.size()*costhetas.size());
+
+   aeff.setPhiDependence(false);
+   for (size_t i(0); i < energies.size(); i++) {
+      for (size_t j(0); j < costhetas.size(); j++) {
+         double theta(std::acos(costhetas[j])*180./M_PI);
+         CPPUNIT_ASSERT(std::fabs(values[i*costhetas.size() + j] 
+                                  - aeff.value(energies[i], theta, 0))
+                        <= 1e-12*values[i*costhetas.size() + j]);
+      }
+   }
+
+   // The matrix is the phi average when phi dependence is enabled.
+   aeff.setPhiDependence(true);
+   size_t nphi(3600);
+   for (size_t i(0); i < energies.size(); i += 3) {
+      for (size_t j(0); j < costhetas.size(); j += 5) {
+         double theta(std::acos(costhetas[j])*180./M_PI);
+         double sum(0);
+         for (size_t k(0); k < nphi; k++) {
+            sum += aeff.value(energies[i], theta, 360.*(k + 0.5)/nphi);
+         }
+         CPPUNIT_ASSERT(std::fabs(sum/nphi - values[i*costhetas.size() + j])
+                        <= 1e-3*values[i*costhetas.size() + j]);
+      }
+   }
+}
+
+void LatResponseTests::aeff_upper_limits() {
+   std::string dataPath(st_facilities::Environment::dataPath("latResponse"));
+   std::string aeff_file(commonUtilities::joinPath(dataPath, 
+                                                   "aeff_epoch_0.fits"));
+   latResponse::Aeff aeff(aeff_file);
+   for (size_t k(0); k < 2; k++) {
+      aeff.setPhiDependence(k == 0);
+      double upper_limit(aeff.upperLimit());
+      for (double energy(20.); energy < 1e6; energy *= 1.7) {
+         double limit(aeff.upperLimit(energy));
+         CPPUNIT_ASSERT(limit <= upper_limit);
+         for (double theta(0); theta < 90.; theta += 3.) {
+            for (double phi(0); phi < 360.; phi += 5.) {
+               CPPUNIT_ASSERT(aeff.value(energy, theta, phi) 
+                              <= limit*(1. + 1e-12));
+            }
+         }
+      }
+   }
+}
+
+void LatResponseTests::fits_table_columns() {
+   std::string dataPath(st_facilities::Environment::dataPath("latResponse"));
+   std::string aeff_file(commonUtilities::joinPath(dataPath, 
+                                                   "aeff_epoch_0.fits"));
+   std::vector<double> elo, ehi, effarea;
+   latResponse::FitsTable::getVectorData(aeff_file, "EFFECTIVE AREA",
+                                         "ENERG_LO", elo);
+   latResponse::FitsTable::getVectorData(aeff_file, "EFFECTIVE AREA",
+                                         "ENERG_HI", ehi);
+   latResponse::FitsTable::getVectorData(aeff_file, "EFFECTIVE AREA",
+                                         "EFFAREA", effarea);
+   CPPUNIT_ASSERT(elo.size() > 0);
+   CPPUNIT_ASSERT(elo.size() == ehi.size());
+   CPPUNIT_ASSERT(effarea.size() % elo.size() == 0);
+   for (size_t k(0); k < elo.size(); k++) {
+      CPPUNIT_ASSERT(elo[k] < ehi[k]);
+   }
+
+   latResponse::FitsTable table(aeff_file, "EFFECTIVE AREA", "EFFAREA");
+   std::vector<double> values;
+   table.getValues(values);
+   CPPUNIT_ASSERT(values == effarea);
+
+   CPPUNIT_ASSERT_THROW(latResponse::FitsTable::getVectorData(
+                           aeff_file, "EFFECTIVE AREA", "ENERG_LO", elo, 1000),
+                        std::runtime_error);
+}
+
 void LatResponseTests::psf_zero_separation() {
    double energy(1e3);
    double theta(0);
@@ -359,6 +579,60 @@ void LatResponseTests::psf_normalization() {
    CPPUNIT_ASSERT(!integralFailures);
 }
 
+void LatResponseTests::gauss_legendre() {
+// An n-point rule integrates polynomials of degree 2n - 1 exactly.
+   double xmin(0.5);
+   double xmax(2.);
+   for (size_t order(1); order < 70; order += 4) {
+      latResponse::GaussLegendre rule(order);
+      std::vector<double> xx, wts;
+      rule.nodes(xmin, xmax, xx, wts);
+      CPPUNIT_ASSERT(xx.size() == order && wts.size() == order);
+      size_t degree(2*order - 1);
+      double sum(0);
+      for (size_t i(0); i < order; i++) {
+         CPPUNIT_ASSERT(xx[i] > xmin && xx[i] < xmax);
+         sum += wts[i]*std::pow(xx[i], static_cast<double>(degree));
+      }
+      double expected((std::pow(xmax, degree + 1.) 
+                       - std::pow(xmin, degree + 1.))/(degree + 1.));
+      CPPUNIT_ASSERT(std::fabs(sum/expected - 1.) < 1e-10);
+   }
+}
+
+void LatResponseTests::psf_eager_integrals() {
+// The precomputed integrals must match those computed on demand.
+   std::string dataPath(st_facilities::Environment::dataPath("latResponse"));
+   std::string psf_file(commonUtilities::joinPath(dataPath, 
+                                                  "psf_epoch_0.fits"));
+   latResponse::Psf3 lazy_psf(psf_file);
+   latResponse::Psf3 eager_psf(psf_file);
+
+   astro::SkyDir roidir(83.6, 22.0);
+   irfInterface::AcceptanceCone cone(roidir, 10.);
+   std::vector<irfInterface::AcceptanceCone *> cones(1, &cone);
+
+   bool eager(latResponse::IrfLoader::eager_psf_integrals());
+   latResponse::IrfLoader::set_eager_psf_integrals(false);
+   double energy(1e3);
+   double theta(30.);
+   double phi(0);
+   std::vector<double> lazy_values;
+   for (double offset(0); offset < 15.; offset += 1.5) {
+      astro::SkyDir srcDir(83.6, 22.0 + offset);
+      lazy_values.push_back(lazy_psf.angularIntegral(energy, srcDir, theta,
+                                                     phi, cones));
+   }
+   latResponse::IrfLoader::set_eager_psf_integrals(true);
+   size_t k(0);
+   for (double offset(0); offset < 15.; offset += 1.5, k++) {
+      astro::SkyDir srcDir(83.6, 22.0 + offset);
+      CPPUNIT_ASSERT(eager_psf.angularIntegral(energy, srcDir, theta, phi,
+                                               cones) == lazy_values[k]);
+   }
+   latResponse::IrfLoader::set_eager_psf_integrals(eager);
+}
+
 void LatResponseTests::edisp_normalization() {
    double time(239846401.);  // 08Aug2008 00:00:00
 
@@ -576,6 +850,208 @@ void LatResponseTests::epochDep_tests() {
    CPPUNIT_ASSERT(eff(energy, met1) == eff_epoch1(energy, met1));
 }
 
+void LatResponseTests::efficiency_factor_livetime() {
+   double met0(252460801.);  // 2009-01-01 00:00:00 (in epoch 0)
+   double met1(283996802.);  // 2010-01-01 00:00:00 (in epoch 1)
+
+// One 30 s interval around each of met0 and met1 with livetime
+// fractions of 0.8 and 0.6.
+   std::vector<double> start, stop, livetime, ltfrac;
+   double mets[] = {met0, met1};
+   ltfrac.push_back(0.8);
+   ltfrac.push_back(0.6);
+   for (size_t i(0); i < 2; i++) {
+      start.push_back(mets[i] - 15.);
+      stop.push_back(mets[i] + 15.);
+      livetime.push_back(30.*ltfrac[i]);
+   }
+   std::string tmpdir(makeTempDir());
+   std::string ft2file(commonUtilities::joinPath(tmpdir,
+                                                 "test_efficiency_ft2.fits"));
+   writeFt2File(ft2file, start, stop, livetime);
+
+   std::string dataPath(st_facilities::Environment::dataPath("latResponse"));
+   std::string aeff0(commonUtilities::joinPath(dataPath,
+                                               "aeff_epoch_0.fits"));
+   std::string aeff1(commonUtilities::joinPath(dataPath,
+                                               "aeff_epoch_1.fits"));
+   latResponse::EfficiencyFactor eff_epoch0(aeff0);
+   latResponse::EfficiencyFactor eff_epoch1(aeff1);
+
+   latResponse::EfficiencyFactorEpochDep eff;
+   eff.add(eff_epoch0, 
+           latResponse::EpochDep::epochStart(aeff0, "EFFICIENCY_PARAMS"));
+   eff.add(eff_epoch1, 
+           latResponse::EpochDep::epochStart(aeff1, "EFFICIENCY_PARAMS"));
+
+   eff_epoch0.readFt2File(ft2file);
+   eff.readFt2File(ft2file);
+   std::remove(ft2file.c_str());
+   ::rmdir(tmpdir.c_str());
+
+   latResponse::EfficiencyFactor * components[] = {&eff_epoch0, &eff_epoch1};
+   for (double energy(30.); energy < 3e5; energy *= 3.) {
+      for (size_t i(0); i < 2; i++) {
+// The livetime factors are those of the component for each epoch, and
+// the efficiency factor is linear in the livetime fraction.
+         double factor1, factor2;
+         eff.getLivetimeFactors(energy, factor1, factor2, mets[i]);
+         double ref1, ref2;
+         components[i]->getLivetimeFactors(energy, ref1, ref2, mets[i]);
+         CPPUNIT_ASSERT(factor1 == ref1);
+         CPPUNIT_ASSERT(factor2 == ref2);
+         double expected(factor1 + factor2*ltfrac[i]);
+         CPPUNIT_ASSERT(std::fabs(eff(energy, mets[i]) - expected) 
+                        < 1e-12*std::fabs(expected));
+      }
+// The FT2 data read by the base class are used by EfficiencyFactor.
+      double factor1, factor2;
+      eff_epoch0.getLivetimeFactors(energy, factor1, factor2, met0);
+      double expected(factor1 + factor2*ltfrac[0]);
+      CPPUNIT_ASSERT(std::fabs(eff_epoch0(energy, met0) - expected)
+                     < 1e-12*std::fabs(expected));
+   }
+   CPPUNIT_ASSERT(eff_epoch0(1e3, met0) != 1);
+// Without FT2 data, the efficiency factor is unity.
+   CPPUNIT_ASSERT(eff_epoch1(1e3, met1) == 1);
+
+// METs outside of the FT2 intervals are an error, as for the
+// IEfficiencyFactor base class.
+   double outside[] = {start[0] - 100., stop[1] + 100.};
+   for (size_t i(0); i < 2; i++) {
+      bool thrown(false);
+      try {
+         eff_epoch0(1e3, outside[i]);
+      } catch (std::runtime_error &) {
+         thrown = true;
+      }
+      CPPUNIT_ASSERT(thrown);
+      thrown = false;
+      try {
+         eff(1e3, outside[i]);
+      } catch (std::runtime_error &) {
+         thrown = true;
+      }
+      CPPUNIT_ASSERT(thrown);
+   }
+}
+
+void LatResponseTests::snapshot_round_trip() {
+   std::string dataPath(st_facilities::Environment::dataPath("latResponse"));
+   std::string aeff_file(commonUtilities::joinPath(dataPath,
+                                                   "aeff_epoch_0.fits"));
+   std::string psf_file(commonUtilities::joinPath(dataPath,
+                                                  "psf_epoch_0.fits"));
+   std::string tmpdir(makeTempDir());
+   std::string snapshot_file(commonUtilities::joinPath(tmpdir,
+                                                       "test_irf_snapshot.dat"));
+
+   latResponse::IrfSnapshot::startRecording();
+   latResponse::Aeff aeff_fits(aeff_file);
+   latResponse::Psf3 psf_fits(psf_file);
+   latResponse::IrfSnapshot::recorder()->write(snapshot_file);
+   latResponse::IrfSnapshot::stopRecording();
+
+   latResponse::IrfSnapshot::load(snapshot_file);
+   latResponse::Aeff aeff_snap(aeff_file);
+   latResponse::Psf3 psf_snap(psf_file);
+   latResponse::IrfSnapshot::unload();
+   std::remove(snapshot_file.c_str());
+   ::rmdir(tmpdir.c_str());
+
+   double phi(0);
+   double sep(0.5);
+   for (double energy(50); energy < 3e5; energy *= 3) {
+      for (double theta(0); theta < 70; theta += 10) {
+         CPPUNIT_ASSERT(aeff_fits.value(energy, theta, phi) ==
+                        aeff_snap.value(energy, theta, phi));
+         CPPUNIT_ASSERT(psf_fits.value(sep, energy, theta, phi) ==
+                        psf_snap.value(sep, energy, theta, phi));
+      }
+   }
+}
+
+void LatResponseTests::parallel_prefetch() {
+   std::vector<std::string> names;
+   for (size_t i(0); i < m_irfNames.size() && names.size() < 4; i++) {
+      if (m_irfNames[i].find("P8R2_SOURCE_V6::PSF") != std::string::npos) {
+         names.push_back(m_irfNames[i]);
+      }
+   }
+   CPPUNIT_ASSERT(!names.empty());
+
+   double energy(1e3);
+   double sep(0.5);
+   double phi(0);
+   double time(239846401.);
+   std::vector<double> aeff_values;
+   std::vector<double> psf_values;
+   for (size_t i(0); i < names.size(); i++) {
+      irfInterface::Irfs * my_irfs(m_irfsFactory->create(names[i]));
+      for (double theta(0); theta < 70; theta += 10.) {
+         aeff_values.push_back(my_irfs->aeff()->value(energy, theta, phi,
+                                                      time));
+         psf_values.push_back(my_irfs->psf()->value(sep, energy, theta, phi,
+                                                    time));
+      }
+      delete my_irfs;
+   }
+
+   bool parallel(latResponse::IrfLoader::parallel_loading());
+   latResponse::IrfLoader::set_parallel_loading(true);
+   latResponse::IrfLoader::prefetch(names);
+   latResponse::IrfLoader::set_parallel_loading(parallel);
+
+   size_t k(0);
+   for (size_t i(0); i < names.size(); i++) {
+      irfInterface::Irfs * my_irfs(m_irfsFactory->create(names[i]));
+      for (double theta(0); theta < 70; theta += 10., k++) {
+         CPPUNIT_ASSERT(my_irfs->aeff()->value(energy, theta, phi, time)
+                        == aeff_values[k]);
+         CPPUNIT_ASSERT(my_irfs->psf()->value(sep, energy, theta, phi, time)
+                        == psf_values[k]);
+      }
+      delete my_irfs;
+   }
+}
+
+void LatResponseTests::prefetch_without_efficiency() {
+// Find a set of IRFs that does not provide EFFICIENCY_PARS.
+   std::vector<std::string> names;
+   for (size_t i(0); i < m_irfNames.size() && names.empty(); i++) {
+      irfInterface::Irfs * my_irfs(m_irfsFactory->create(m_irfNames[i]));
+      try {
+         my_irfs->efficiencyFactor();
+      } catch (std::exception &) {
+         names.push_back(m_irfNames[i]);
+      }
+      delete my_irfs;
+   }
+   CPPUNIT_ASSERT(!names.empty());
+
+   double energy(1e3);
+   double phi(0);
+   double time(239846401.);
+   std::vector<double> aeff_values;
+   irfInterface::Irfs * my_irfs(m_irfsFactory->create(names[0]));
+   for (double theta(0); theta < 70; theta += 10.) {
+      aeff_values.push_back(my_irfs->aeff()->value(energy, theta, phi, time));
+   }
+   delete my_irfs;
+
+// The missing efficiency factor must not prevent the other
+// components from being prefetched.
+   latResponse::IrfLoader::prefetch(names);
+
+   my_irfs = m_irfsFactory->create(names[0]);
+   size_t k(0);
+   for (double theta(0); theta < 70; theta += 10., k++) {
+      CPPUNIT_ASSERT(my_irfs->aeff()->value(energy, theta, phi, time)
+                     == aeff_values[k]);
+   }
+   delete my_irfs;
+}
+
 int main(int iargc, char * argv[]) {
 #ifdef TRAP_FPE
 // Add floating point exception traps.
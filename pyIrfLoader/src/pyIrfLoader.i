@@ -9,6 +9,7 @@
  */
 %module pyIrfLoader
 %{
+#include "irfInterface/Accuracy.h"
 #include "irfInterface/IAeff.h"
 #include "irfInterface/IPsf.h"
 #include "irfInterface/IEdisp.h"
@@ -16,6 +17,7 @@
 #include "irfInterface/Irfs.h"
 #include "irfInterface/IrfsFactory.h"
 #include "irfInterface/AcceptanceCone.h"
+#include "irfInterface/Instrumentation.h"
 #include "irfLoader/Loader.h"
 #include "latResponse/Aeff.h"
 #include "latResponse/Bilinear.h"
@@ -51,6 +53,7 @@
 %template(StringVector) std::vector<std::string>;
 %template(IrfVector) std::vector<irfInterface::Irfs>;
 %template(ConeVector) std::vector<irfInterface::AcceptanceCone *>;
+%template(CounterMap) std::map<std::string, double>;
 %include CLHEP/Vector/ThreeVector.h
 // EAC, add ProjBase sub-classes
 %include astro/ProjBase.h
@@ -58,12 +61,18 @@
 %include astro/HealpixProj.h
 %include astro/SkyDir.h
 %include irfInterface/AcceptanceCone.h
+%include irfInterface/Accuracy.h
 %include irfInterface/IAeff.h
 %include irfInterface/IPsf.h
 %include irfInterface/IEdisp.h
 %include irfInterface/IEfficiencyFactor.h
 %include irfInterface/Irfs.h
 %include irfInterface/IrfsFactory.h
+// Only the static query interface of the instrumentation is wrapped,
+// e.g., Instrumentation.enable(), Instrumentation.counters().
+%ignore irfInterface::Counter;
+%ignore irfInterface::ScopedTimer;
+%include irfInterface/Instrumentation.h
 %include irfLoader/Loader.h
 %include latResponse/Bilinear.h
 %include latResponse/ParTables.h